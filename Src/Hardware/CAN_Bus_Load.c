@@ -0,0 +1,315 @@
+/*
+ * CAN_Bus_Load.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Hardware.h"
+
+/* C standard library */
+#include <stddef.h>
+#include <string.h>
+
+/* The load is counted from several tasks on the PIC port */
+#if PROCESSOR_CHOICE == PIC
+#include "FreeRTOS.h"
+#include "task.h"
+#define CAN_BUS_LOAD_LOCK() taskENTER_CRITICAL()
+#define CAN_BUS_LOAD_UNLOCK() taskEXIT_CRITICAL()
+#else
+#define CAN_BUS_LOAD_LOCK()
+#define CAN_BUS_LOAD_UNLOCK()
+#endif
+
+/* The sliding window is CAN_BUS_LOAD_BUCKETS * CAN_BUS_LOAD_BUCKET_MS milliseconds long */
+#ifndef CAN_BUS_LOAD_BUCKETS
+#define CAN_BUS_LOAD_BUCKETS 10
+#endif
+#ifndef CAN_BUS_LOAD_BUCKET_MS
+#define CAN_BUS_LOAD_BUCKET_MS 100
+#endif
+#ifndef CAN_BUS_LOAD_MAX_ENTRIES
+#define CAN_BUS_LOAD_MAX_ENTRIES 32                             /* How many PGN and SA pairs are counted one by one. The rest are counted as PGN 0xFFFFFFFF */
+#endif
+
+/* Bits of an extended data frame without the data field and without stuff bits */
+#define CAN_EXTENDED_FRAME_STUFFABLE_BITS 54                    /* SOF, 29 bit ID, SRR, IDE, RTR, r1, r0, DLC and CRC - Here can stuff bits be inserted */
+#define CAN_EXTENDED_FRAME_FIXED_BITS 13                        /* CRC delimiter, ACK slot, ACK delimiter, EOF and the intermission */
+
+/* Bits of an extended CAN FD frame. The data phase is sent with the data bit rate */
+#define CAN_FD_ARBITRATION_BITS 36                              /* SOF, 29 bit ID, SRR, IDE, RRS, FDF, res and BRS - With the bit rate of the bus */
+#define CAN_FD_DATA_PHASE_BITS 9                                /* ESI, DLC and the stuff count - The data and the CRC come on top */
+
+/* How much one PGN from one SA has used the bus */
+struct Bus_load_entry {
+    uint32_t PGN;
+    uint8_t SA;
+    bool is_used;
+    uint32_t bits[CAN_BUS_LOAD_BUCKETS];
+};
+
+/* Internal fields */
+static uint32_t bus_load_bit_rate = 250000;
+static uint32_t bus_load_data_bit_rate = 0;                     /* CAN FD data phase - 0 means the same as the bit rate */
+static uint8_t bus_load_stuffing = CAN_BUS_LOAD_STUFFING_WORST_CASE;
+static uint32_t bus_load_bits[CAN_BUS_LOAD_BUCKETS] = {0};
+static uint32_t bus_load_bucket = 0;                            /* The time divided by CAN_BUS_LOAD_BUCKET_MS for the newest bucket */
+static struct Bus_load_entry bus_load_entries[CAN_BUS_LOAD_MAX_ENTRIES] = {0};
+static struct Bus_load_entry bus_load_other = {.PGN = 0xFFFFFFFF, .SA = 0xFF, .is_used = true};
+
+/* Internal functions */
+/* After five equal bits, the opposite bit is inserted. The stuff bit is the first bit of the next run */
+static uint8_t Count_Runs(const uint8_t bits[], uint8_t length) {
+    uint8_t stuff_bits = 0;
+    uint8_t run = 1;
+    uint8_t last_bit = bits[0];
+    for (uint8_t i = 1; i < length; i++) {
+        if (bits[i] == last_bit) {
+            run++;
+        } else {
+            last_bit = bits[i];
+            run = 1;
+        }
+        if (run == 5) {
+            stuff_bits++;
+            last_bit = !last_bit;
+            run = 1;
+        }
+    }
+    return stuff_bits;
+}
+
+static uint8_t Count_Stuff_Bits(uint32_t ID, uint8_t DLC, const uint8_t data[]) {
+    /* Build the stuffable part of the frame bit by bit */
+    uint8_t bits[CAN_EXTENDED_FRAME_STUFFABLE_BITS + 64];
+    uint8_t length = 0;
+    bits[length++] = 0;                                         /* SOF */
+    for (int8_t i = 28; i >= 18; i--)
+        bits[length++] = (ID >> i) & 0x1;                       /* Base ID */
+    bits[length++] = 1;                                         /* SRR */
+    bits[length++] = 1;                                         /* IDE */
+    for (int8_t i = 17; i >= 0; i--)
+        bits[length++] = (ID >> i) & 0x1;                       /* ID extension */
+    bits[length++] = 0;                                         /* RTR */
+    bits[length++] = 0;                                         /* r1 */
+    bits[length++] = 0;                                         /* r0 */
+    for (int8_t i = 3; i >= 0; i--)
+        bits[length++] = (DLC >> i) & 0x1;
+    for (uint8_t i = 0; i < DLC; i++)
+        for (int8_t j = 7; j >= 0; j--)
+            bits[length++] = (data[i] >> j) & 0x1;
+
+    /* CRC-15 with the polynomial 0x4599 */
+    uint16_t crc = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        uint8_t crc_next = bits[i] ^ ((crc >> 14) & 0x1);
+        crc = (crc << 1) & 0x7FFF;
+        if (crc_next)
+            crc ^= 0x4599;
+    }
+    for (int8_t i = 14; i >= 0; i--)
+        bits[length++] = (crc >> i) & 0x1;
+    return Count_Runs(bits, length);
+}
+
+/* Stuff bits of the arbitration field of a CAN FD frame. Only the ID is known here, so the data phase is still counted as the worst case */
+static uint8_t Count_FD_Arbitration_Stuff_Bits(uint32_t ID, bool is_bit_rate_switch) {
+    uint8_t bits[CAN_FD_ARBITRATION_BITS];
+    uint8_t length = 0;
+    bits[length++] = 0;                                         /* SOF */
+    for (int8_t i = 28; i >= 18; i--)
+        bits[length++] = (ID >> i) & 0x1;                       /* Base ID */
+    bits[length++] = 1;                                         /* SRR */
+    bits[length++] = 1;                                         /* IDE */
+    for (int8_t i = 17; i >= 0; i--)
+        bits[length++] = (ID >> i) & 0x1;                       /* ID extension */
+    bits[length++] = 0;                                         /* RRS */
+    bits[length++] = 1;                                         /* FDF */
+    bits[length++] = 0;                                         /* res */
+    bits[length++] = is_bit_rate_switch;                        /* BRS */
+    return Count_Runs(bits, length);
+}
+
+/* Move the window forward and clear the buckets that are too old */
+static void Advance_Window(uint32_t now) {
+    uint32_t bucket = now / CAN_BUS_LOAD_BUCKET_MS;
+    uint32_t steps = bucket - bus_load_bucket;
+    if (steps == 0)
+        return;
+    if (steps > CAN_BUS_LOAD_BUCKETS)
+        steps = CAN_BUS_LOAD_BUCKETS;
+    for (uint32_t i = 1; i <= steps; i++) {
+        uint8_t index = (bus_load_bucket + i) % CAN_BUS_LOAD_BUCKETS;
+        bus_load_bits[index] = 0;
+        bus_load_other.bits[index] = 0;
+        for (uint8_t j = 0; j < CAN_BUS_LOAD_MAX_ENTRIES; j++)
+            bus_load_entries[j].bits[index] = 0;
+    }
+    bus_load_bucket = bucket;
+}
+
+static uint32_t Sum_Bits(const uint32_t bits[]) {
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < CAN_BUS_LOAD_BUCKETS; i++)
+        sum += bits[i];
+    return sum;
+}
+
+/* Bits in the window compared with how many bits the bus can carry in the window. 10000 = 100 % */
+static uint16_t Compute_Load(uint32_t bits, uint32_t now) {
+    uint64_t window_ms = (CAN_BUS_LOAD_BUCKETS - 1) * CAN_BUS_LOAD_BUCKET_MS + now % CAN_BUS_LOAD_BUCKET_MS + 1;
+    uint64_t load = (uint64_t) bits * 1000 * 10000 / (window_ms * bus_load_bit_rate);
+    return load > 10000 ? 10000 : load;
+}
+
+/* Find the entry of PGN and SA. A free or quiet entry is taken if the pair is new */
+static struct Bus_load_entry *Get_Entry(uint32_t PGN, uint8_t SA) {
+    struct Bus_load_entry *free_entry = NULL;
+    for (uint8_t i = 0; i < CAN_BUS_LOAD_MAX_ENTRIES; i++) {
+        struct Bus_load_entry *entry = &bus_load_entries[i];
+        if (entry->is_used && entry->PGN == PGN && entry->SA == SA)
+            return entry;
+        if (free_entry == NULL && (!entry->is_used || Sum_Bits(entry->bits) == 0))
+            free_entry = entry;
+    }
+    if (free_entry == NULL)
+        return &bus_load_other;
+    memset(free_entry->bits, 0, sizeof(free_entry->bits));
+    free_entry->PGN = PGN;
+    free_entry->SA = SA;
+    free_entry->is_used = true;
+    return free_entry;
+}
+
+/* How many bits a frame takes on the bus, with the stuff bits from CAN_Bus_Load_Set_Bit_Rate */
+uint8_t CAN_Bus_Load_Get_Frame_Bits(uint32_t ID, uint8_t DLC, const uint8_t data[]) {
+    if (DLC > 8)
+        DLC = 8;
+    uint8_t stuffable_bits = CAN_EXTENDED_FRAME_STUFFABLE_BITS + 8 * DLC;
+    uint8_t stuff_bits;
+    if (bus_load_stuffing == CAN_BUS_LOAD_STUFFING_EXACT && data != NULL)
+        stuff_bits = Count_Stuff_Bits(ID, DLC, data);
+    else
+        stuff_bits = (stuffable_bits - 1) / 4;                 /* The first stuff bit comes after 5 bits, then after every 4 bits */
+    return stuffable_bits + CAN_EXTENDED_FRAME_FIXED_BITS + stuff_bits;
+}
+
+/*
+ * Set the bit rate of the bus e.g 250000 and how the stuff bits are counted.
+ * CAN_BUS_LOAD_STUFFING_WORST_CASE is fast. CAN_BUS_LOAD_STUFFING_EXACT stuffs the real frame and gives the true load
+ */
+void CAN_Bus_Load_Set_Bit_Rate(uint32_t bit_rate, uint8_t stuffing) {
+    CAN_BUS_LOAD_LOCK();
+    bus_load_bit_rate = bit_rate > 0 ? bit_rate : 250000;
+    bus_load_stuffing = stuffing;
+    CAN_BUS_LOAD_UNLOCK();
+}
+
+/*
+ * Set the bit rate of the data phase of CAN FD frames e.g 2000000, when the frames are sent with bit rate switch - SAE J1939-22.
+ * 0 means that the data phase has the same bit rate as the bus
+ */
+void CAN_Bus_Load_Set_Data_Bit_Rate(uint32_t data_bit_rate) {
+    CAN_BUS_LOAD_LOCK();
+    bus_load_data_bit_rate = data_bit_rate;
+    CAN_BUS_LOAD_UNLOCK();
+}
+
+/*
+ * How long a CAN FD frame with length bytes takes on the bus, counted in bits of the bit rate of the bus so it can be compared with classic frames.
+ * With CAN_BUS_LOAD_STUFFING_EXACT the stuff bits of the arbitration field are counted from the ID. The stuff bits of the data phase are always the worst case
+ */
+uint16_t CAN_Bus_Load_Get_FD_Frame_Bits(uint32_t ID, uint8_t length) {
+    if (length > 64)
+        length = 64;
+    uint8_t CRC_bits = length <= 16 ? 17 : 21;
+    uint8_t stuff_bits;
+    if (bus_load_stuffing == CAN_BUS_LOAD_STUFFING_EXACT)
+        stuff_bits = Count_FD_Arbitration_Stuff_Bits(ID, bus_load_data_bit_rate > 0);
+    else
+        stuff_bits = (CAN_FD_ARBITRATION_BITS - 1) / 4;
+    uint16_t arbitration_bits = CAN_FD_ARBITRATION_BITS + stuff_bits + CAN_EXTENDED_FRAME_FIXED_BITS;
+    uint16_t data_bits = 8 * length;
+    data_bits += CAN_FD_DATA_PHASE_BITS + data_bits / 4 + CRC_bits + (CRC_bits + 4 + 3) / 4;   /* Stuff bits in the data and the fixed stuff bits in the CRC field */
+    uint32_t data_bit_rate = bus_load_data_bit_rate > 0 ? bus_load_data_bit_rate : bus_load_bit_rate;
+    return arbitration_bits + ((uint32_t) data_bits * bus_load_bit_rate + data_bit_rate - 1) / data_bit_rate;
+}
+
+static void Add_Bits(uint32_t ID, uint16_t frame_bits) {
+    uint32_t PGN = (ID >> 8) & 0x3FFFF;
+    if (((ID >> 16) & 0xFF) < 0xF0)
+        PGN &= 0x3FF00;                                         /* PDU1 - The destination address is not a part of the PGN */
+    uint32_t now = Clock_Get_Milliseconds();
+
+    CAN_BUS_LOAD_LOCK();
+    Advance_Window(now);
+    uint8_t index = bus_load_bucket % CAN_BUS_LOAD_BUCKETS;
+    bus_load_bits[index] += frame_bits;
+    Get_Entry(PGN, ID & 0xFF)->bits[index] += frame_bits;
+    CAN_BUS_LOAD_UNLOCK();
+}
+
+/* Count a frame that has been sent or received. This is called from CAN_Send_Message, CAN_Send_Request and CAN_Read_Message */
+void CAN_Bus_Load_Add_Frame(uint32_t ID, uint8_t DLC, const uint8_t data[]) {
+    Add_Bits(ID, CAN_Bus_Load_Get_Frame_Bits(ID, DLC, data));
+}
+
+/* Count a CAN FD frame that has been sent or received. This is called from CAN_Send_Message_FD and CAN_Read_Message_FD */
+void CAN_Bus_Load_Add_FD_Frame(uint32_t ID, uint8_t length) {
+    Add_Bits(ID, CAN_Bus_Load_Get_FD_Frame_Bits(ID, length));
+}
+
+/* The bus load over the sliding window in 0.01 %. 10000 = 100 % */
+uint16_t CAN_Bus_Load_Get(void) {
+    uint32_t now = Clock_Get_Milliseconds();
+    CAN_BUS_LOAD_LOCK();
+    Advance_Window(now);
+    uint16_t load = Compute_Load(Sum_Bits(bus_load_bits), now);
+    CAN_BUS_LOAD_UNLOCK();
+    return load;
+}
+
+/* The bus load of one PGN in 0.01 %. SA = 0xFF gives the sum of every source address */
+uint16_t CAN_Bus_Load_Get_PGN(uint32_t PGN, uint8_t SA) {
+    uint32_t now = Clock_Get_Milliseconds();
+    uint32_t bits = 0;
+    CAN_BUS_LOAD_LOCK();
+    Advance_Window(now);
+    for (uint8_t i = 0; i < CAN_BUS_LOAD_MAX_ENTRIES; i++) {
+        struct Bus_load_entry *entry = &bus_load_entries[i];
+        if (entry->is_used && entry->PGN == PGN && (entry->SA == SA || SA == 0xFF))
+            bits += Sum_Bits(entry->bits);
+    }
+    uint16_t load = Compute_Load(bits, now);
+    CAN_BUS_LOAD_UNLOCK();
+    return load;
+}
+
+/*
+ * Read the counted PGN and SA pairs one by one, so the application can find the PGN that loads the bus.
+ * index goes from 0 to CAN_BUS_LOAD_MAX_ENTRIES. The last index is the pairs that did not fit, with PGN 0xFFFFFFFF. Returns false if the index is not used
+ */
+bool CAN_Bus_Load_Get_Entry(uint8_t index, uint32_t *PGN, uint8_t *SA, uint16_t *load) {
+    if (index > CAN_BUS_LOAD_MAX_ENTRIES)
+        return false;
+    uint32_t now = Clock_Get_Milliseconds();
+    CAN_BUS_LOAD_LOCK();
+    Advance_Window(now);
+    struct Bus_load_entry *entry = index == CAN_BUS_LOAD_MAX_ENTRIES ? &bus_load_other : &bus_load_entries[index];
+    bool is_used = entry->is_used;
+    *PGN = entry->PGN;
+    *SA = entry->SA;
+    *load = Compute_Load(Sum_Bits(entry->bits), now);
+    CAN_BUS_LOAD_UNLOCK();
+    return is_used;
+}
+
+/* Forget everything that has been counted */
+void CAN_Bus_Load_Reset(void) {
+    CAN_BUS_LOAD_LOCK();
+    memset(bus_load_bits, 0, sizeof(bus_load_bits));
+    memset(bus_load_entries, 0, sizeof(bus_load_entries));
+    memset(bus_load_other.bits, 0, sizeof(bus_load_other.bits));
+    CAN_BUS_LOAD_UNLOCK();
+}
@@ -0,0 +1,268 @@
+/*
+ * CAN_Network.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+/* Needed for clock_gettime(), nanosleep() and the POSIX threads when compiling as C99 */
+#define _POSIX_C_SOURCE 200112L
+
+#include "Hardware.h"
+
+/* The network is plugged in with the callback functions, so PROCESSOR_CHOICE must be INTERNAL_CALLBACK */
+#if PROCESSOR_CHOICE == INTERNAL_CALLBACK
+
+/* Layers */
+#include "../Open_SAE_J1939/Open_SAE_J1939.h"
+
+/* C standard library */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/*
+ * A virtual CAN bus in this process with many simulated ECUs, each with its own J1939 struct.
+ * A frame that one node sends is put in the receive queue of every other node after the latency. Every receiver can lose the frame on its own.
+ * The nodes run one at the time - In the stepped mode CAN_Network_Run goes through them in order with a simulated clock,
+ * in the threaded mode every node has its own thread with the real clock. The stack has global state, e.g the bus load and the
+ * callback lists, so the threads take a lock around every call to Open_SAE_J1939_Listen_For_Messages.
+ */
+#ifndef CAN_NETWORK_QUEUE_LENGTH
+#define CAN_NETWORK_QUEUE_LENGTH 1024                          /* Frames that can wait for one node - More frames are counted as overrun */
+#endif
+#define CAN_NETWORK_NO_NODE 0xFFFF
+
+/* A frame on its way to one node */
+struct Network_frame {
+    uint32_t ID;
+    uint8_t DLC;
+    uint8_t data[CAN_MAX_DATA_LENGTH];
+    uint32_t delivery_time;                                     /* When the node can read it in milliseconds */
+};
+
+struct Network_node {
+    J1939 j1939;
+    struct Network_frame queue[CAN_NETWORK_QUEUE_LENGTH];
+    uint16_t queue_head;
+    uint16_t queue_length;
+    pthread_t thread;
+    bool has_thread;
+};
+
+/* Internal fields */
+static struct Network_node *network_nodes = NULL;
+static uint16_t network_number_of_nodes = 0;
+static uint16_t network_current_node = CAN_NETWORK_NO_NODE;
+static uint32_t network_latency = 0;
+static uint32_t network_loss = 0;                               /* The probability to lose a frame, scaled to 0 - 0xFFFFFFFF */
+static uint32_t network_random = 1;
+static uint32_t network_time = 0;
+static bool network_real_time = false;
+static struct timespec network_start;
+static volatile bool network_stop_threads = false;
+static pthread_mutex_t network_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Statistics */
+static uint32_t network_frames_sent = 0;
+static uint32_t network_frames_delivered = 0;
+static uint32_t network_frames_lost = 0;
+static uint32_t network_frames_overrun = 0;
+
+/* Internal functions */
+
+/* xorshift32 - The same seed gives the same losses, so a stepped run can be repeated */
+static uint32_t Next_Random(void) {
+    network_random ^= network_random << 13;
+    network_random ^= network_random >> 17;
+    network_random ^= network_random << 5;
+    return network_random;
+}
+
+static uint32_t CAN_Network_Clock(void) {
+    if (!network_real_time)
+        return network_time;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((now.tv_sec - network_start.tv_sec) * 1000 + (now.tv_nsec - network_start.tv_nsec) / 1000000);
+}
+
+/* Put the frame in the queue of every node except the sender. The lock must be taken */
+static void Broadcast_Frame(uint32_t ID, uint8_t DLC, const uint8_t data[]) {
+    network_frames_sent++;
+    uint32_t delivery_time = CAN_Network_Clock() + network_latency;
+    for (uint16_t i = 0; i < network_number_of_nodes; i++) {
+        if (i == network_current_node)
+            continue;
+        if (network_loss > 0 && Next_Random() < network_loss) {
+            network_frames_lost++;
+            continue;
+        }
+        struct Network_node *node = &network_nodes[i];
+        if (node->queue_length == CAN_NETWORK_QUEUE_LENGTH) {
+            network_frames_overrun++;
+            continue;
+        }
+        struct Network_frame *frame = &node->queue[(node->queue_head + node->queue_length) % CAN_NETWORK_QUEUE_LENGTH];
+        frame->ID = ID;
+        frame->DLC = DLC;
+        memset(frame->data, 0x0, CAN_MAX_DATA_LENGTH);
+        memcpy(frame->data, data, DLC);
+        frame->delivery_time = delivery_time;
+        node->queue_length++;
+        network_frames_delivered++;
+    }
+}
+
+static void CAN_Network_Transmit(uint32_t ID, uint8_t DLC, uint8_t data[]) {
+    Broadcast_Frame(ID, DLC, data);
+}
+
+/* Give the current node the oldest frame in its queue when the latency has passed. length is the DLC of the frame */
+static void CAN_Network_Receive(uint32_t *ID, uint8_t data[], uint8_t *length, bool *is_new_message) {
+    *is_new_message = false;
+    if (network_current_node == CAN_NETWORK_NO_NODE)
+        return;
+    struct Network_node *node = &network_nodes[network_current_node];
+    if (node->queue_length == 0)
+        return;
+    struct Network_frame *frame = &node->queue[node->queue_head];
+    if ((int32_t)(CAN_Network_Clock() - frame->delivery_time) < 0)
+        return;
+    *ID = frame->ID;
+    *length = frame->DLC;
+    memcpy(data, frame->data, frame->DLC);
+    *is_new_message = true;
+    node->queue_head = (node->queue_head + 1) % CAN_NETWORK_QUEUE_LENGTH;
+    node->queue_length--;
+}
+
+static void *CAN_Network_Thread(void *parameter) {
+    uint16_t index = (uint16_t)(uintptr_t)parameter;
+    struct timespec idle = {.tv_sec = 0, .tv_nsec = 200000};
+    while (!network_stop_threads) {
+        J1939 *j1939 = CAN_Network_Enter_Node(index);
+        bool is_new_message = Open_SAE_J1939_Listen_For_Messages(j1939);
+        CAN_Network_Leave_Node();
+        if (!is_new_message)
+            nanosleep(&idle, NULL);
+    }
+    return NULL;
+}
+
+/*
+ * Create a network with number_of_nodes simulated ECUs. Every J1939 struct is cleared - Set the NAME and address of the nodes,
+ * then call Open_SAE_J1939_Startup_ECU or SAE_J1939_Response_Request_Address_Claimed between CAN_Network_Enter_Node and CAN_Network_Leave_Node.
+ * latency is in milliseconds and loss is the probability from 0.0 to 1.0 that one node does not get a frame. seed makes the losses repeatable
+ */
+bool CAN_Network_Open(uint16_t number_of_nodes, uint32_t latency, float loss, uint32_t seed) {
+    CAN_Network_Close();
+    if (number_of_nodes == 0 || number_of_nodes == CAN_NETWORK_NO_NODE)
+        return false;
+    network_nodes = calloc(number_of_nodes, sizeof(struct Network_node));
+    if (network_nodes == NULL)
+        return false;
+    network_number_of_nodes = number_of_nodes;
+    network_current_node = CAN_NETWORK_NO_NODE;
+    network_latency = latency;
+    network_loss = loss <= 0.0f ? 0 : loss >= 1.0f ? 0xFFFFFFFF : (uint32_t)(loss * 4294967295.0);
+    network_random = seed != 0 ? seed : 1;                      /* xorshift gets stuck at 0 */
+    network_time = 0;
+    network_real_time = false;
+    network_frames_sent = 0;
+    network_frames_delivered = 0;
+    network_frames_lost = 0;
+    network_frames_overrun = 0;
+
+    /* Plug in the network as our hardware and clock - The frames are read with their length, so the network can carry CAN FD frames */
+    CAN_Set_Callback_Functions(CAN_Network_Transmit, NULL);
+    CAN_Set_Read_FD_Callback_Function(CAN_Network_Receive);
+    Clock_Set_Callback_Function(CAN_Network_Clock);
+    return true;
+}
+
+void CAN_Network_Close(void) {
+    CAN_Network_Stop_Threads();
+    free(network_nodes);
+    network_nodes = NULL;
+    network_number_of_nodes = 0;
+    Clock_Set_Callback_Function(NULL);
+}
+
+/* Returns the J1939 struct of the node or NULL */
+J1939 *CAN_Network_Get_Node(uint16_t node) {
+    return node < network_number_of_nodes ? &network_nodes[node].j1939 : NULL;
+}
+
+/* Act as the node - Everything that is sent until CAN_Network_Leave_Node is sent by this node. Also needed from the application while the threads run */
+J1939 *CAN_Network_Enter_Node(uint16_t node) {
+    pthread_mutex_lock(&network_lock);
+    network_current_node = node < network_number_of_nodes ? node : CAN_NETWORK_NO_NODE;
+    return CAN_Network_Get_Node(node);
+}
+
+void CAN_Network_Leave_Node(void) {
+    network_current_node = CAN_NETWORK_NO_NODE;
+    pthread_mutex_unlock(&network_lock);
+}
+
+/* Send a frame from a tool outside of the nodes, e.g a request flood. Every node gets it */
+void CAN_Network_Send(uint32_t ID, uint8_t DLC, const uint8_t data[]) {
+    pthread_mutex_lock(&network_lock);
+    network_current_node = CAN_NETWORK_NO_NODE;
+    Broadcast_Frame(ID, DLC > CAN_MAX_DATA_LENGTH ? CAN_MAX_DATA_LENGTH : DLC, data);
+    pthread_mutex_unlock(&network_lock);
+}
+
+/* Stepped mode - Count the simulated clock up one millisecond at the time and let every node read all frames that are due */
+void CAN_Network_Run(uint32_t milliseconds) {
+    if (network_real_time)
+        return;
+    for (uint32_t t = 0; t < milliseconds; t++) {
+        network_time++;
+        for (uint16_t i = 0; i < network_number_of_nodes; i++) {
+            J1939 *j1939 = CAN_Network_Enter_Node(i);
+            for (uint16_t j = 0; j <= CAN_NETWORK_QUEUE_LENGTH && Open_SAE_J1939_Listen_For_Messages(j1939); j++);
+            CAN_Network_Leave_Node();
+        }
+    }
+}
+
+/* Threaded mode - One thread for every node with the real clock. The stepped mode can not be used after this */
+bool CAN_Network_Start_Threads(void) {
+    if (network_nodes == NULL || network_real_time)
+        return false;
+    clock_gettime(CLOCK_MONOTONIC, &network_start);
+    network_start.tv_sec -= network_time / 1000;                /* The clock continues from the stepped mode */
+    network_real_time = true;
+    network_stop_threads = false;
+    for (uint16_t i = 0; i < network_number_of_nodes; i++) {
+        network_nodes[i].has_thread = pthread_create(&network_nodes[i].thread, NULL, CAN_Network_Thread, (void*)(uintptr_t)i) == 0;
+        if (!network_nodes[i].has_thread) {
+            CAN_Network_Stop_Threads();
+            return false;
+        }
+    }
+    return true;
+}
+
+void CAN_Network_Stop_Threads(void) {
+    network_stop_threads = true;
+    for (uint16_t i = 0; i < network_number_of_nodes; i++) {
+        if (network_nodes[i].has_thread)
+            pthread_join(network_nodes[i].thread, NULL);
+        network_nodes[i].has_thread = false;
+    }
+}
+
+void CAN_Network_Get_Statistics(uint32_t *frames_sent, uint32_t *frames_delivered, uint32_t *frames_lost, uint32_t *frames_overrun) {
+    pthread_mutex_lock(&network_lock);
+    *frames_sent = network_frames_sent;
+    *frames_delivered = network_frames_delivered;
+    *frames_lost = network_frames_lost;
+    *frames_overrun = network_frames_overrun;
+    pthread_mutex_unlock(&network_lock);
+}
+
+#endif
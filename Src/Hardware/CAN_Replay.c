@@ -0,0 +1,256 @@
+/*
+ * CAN_Replay.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+/* Needed for clock_gettime() when compiling as C99 */
+#define _POSIX_C_SOURCE 199309L
+
+#include "Hardware.h"
+
+/* The replay source is plugged in with the callback functions, so PROCESSOR_CHOICE must be INTERNAL_CALLBACK */
+#if PROCESSOR_CHOICE == INTERNAL_CALLBACK
+
+/* C standard library */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define REPLAY_LINE_LENGTH 256
+#define REPLAY_MAX_TOKENS 24
+
+/* Internal fields */
+static FILE *replay_file = NULL;
+static FILE *capture_file = NULL;
+static bool replay_real_time = false;
+static bool replay_finished = true;
+static uint32_t replay_frames_injected = 0;
+static uint32_t replay_frames_captured = 0;
+
+/* The next frame from the log, read ahead so we can wait for its time stamp */
+static bool pending_frame = false;
+static uint32_t pending_ID = 0;
+static uint8_t pending_DLC = 0;
+static uint8_t pending_data[8] = {0};
+static double pending_time_stamp = 0.0;
+
+/* Time keeping - All time stamps are relative to the first frame in the log */
+static bool first_frame_read = false;
+static double first_time_stamp = 0.0;
+static double replay_time_stamp = 0.0;
+static double wall_clock_start = 0.0;
+
+/* Internal functions */
+static double Wall_Clock_Seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+static bool Parse_Hex_Bytes(char *tokens[], uint8_t number_of_tokens, uint8_t DLC, uint8_t data[]) {
+    if (DLC > 8 || number_of_tokens < DLC)
+        return false;
+    for (uint8_t i = 0; i < 8; i++)
+        data[i] = i < DLC ? (uint8_t)strtoul(tokens[i], NULL, 16) : 0x0;
+    return true;
+}
+
+/* Compact candump format: 18EA00FE#00EE00 */
+static bool Parse_Candump_Compact(char frame[], uint32_t *ID, uint8_t *DLC, uint8_t data[]) {
+    char *hash = strchr(frame, '#');
+    if (hash - frame != 8 || hash[1] == '#' || hash[1] == 'R')
+        return false;                                           /* Standard ID, CAN FD or remote frame - Not J1939 data */
+    *ID = (uint32_t)strtoul(frame, NULL, 16);
+    size_t hex_length = strlen(hash + 1);
+    if (hex_length % 2 != 0 || hex_length > 16)
+        return false;
+    *DLC = hex_length / 2;
+    for (uint8_t i = 0; i < 8; i++) {
+        char byte[3] = {0};
+        if (i < *DLC) {
+            byte[0] = hash[1 + i * 2];
+            byte[1] = hash[2 + i * 2];
+        }
+        data[i] = (uint8_t)strtoul(byte, NULL, 16);
+    }
+    return true;
+}
+
+/*
+ * Parse one line of a recorded trace. Supported formats:
+ * candump -L:          (1436509052.249713) can0 18EA00FE#00EE00
+ * candump -ta:         (1436509052.249713)  can0  18EA00FE   [3]  00 EE 00
+ * candump:             can0  18EA00FE   [3]  00 EE 00
+ * Vector ASC:          0.004000 1  18EA00FEx       Rx   d 3 00 EE 00
+ * Only extended data frames are returned. ASC lines with direction Tx are skipped, because they are frames this ECU sent itself.
+ */
+static bool Parse_Line(char line[], double *time_stamp, uint32_t *ID, uint8_t *DLC, uint8_t data[]) {
+    char *tokens[REPLAY_MAX_TOKENS];
+    uint8_t number_of_tokens = 0;
+    for (char *token = strtok(line, " \t\r\n"); token != NULL && number_of_tokens < REPLAY_MAX_TOKENS; token = strtok(NULL, " \t\r\n"))
+        tokens[number_of_tokens++] = token;
+    if (number_of_tokens < 2)
+        return false;
+
+    /* candump with a time stamp in parentheses */
+    uint8_t index = 0;
+    *time_stamp = 0.0;
+    if (tokens[0][0] == '(') {
+        *time_stamp = strtod(tokens[0] + 1, NULL);
+        index = 1;
+    } else {
+        /* Vector ASC - time stamp, channel, ID with x for extended, direction, d for data frame, DLC, data */
+        char *end;
+        double asc_time_stamp = strtod(tokens[0], &end);
+        if (*end == '\0' && number_of_tokens >= 6) {
+            size_t ID_length = strlen(tokens[2]);
+            if (ID_length < 2 || tokens[2][ID_length - 1] != 'x' || strcmp(tokens[4], "d") != 0 || strcmp(tokens[3], "Tx") == 0)
+                return false;
+            *time_stamp = asc_time_stamp;
+            *ID = (uint32_t)strtoul(tokens[2], NULL, 16);
+            *DLC = (uint8_t)strtoul(tokens[5], NULL, 10);
+            return Parse_Hex_Bytes(&tokens[6], number_of_tokens - 6, *DLC, data);
+        }
+    }
+
+    /* candump - interface name followed by the frame */
+    if (number_of_tokens < index + 2)
+        return false;
+    char *frame = tokens[index + 1];
+    if (strchr(frame, '#') != NULL)
+        return Parse_Candump_Compact(frame, ID, DLC, data);
+    if (strlen(frame) != 8 || number_of_tokens < index + 3 || tokens[index + 2][0] != '[')
+        return false;
+    *ID = (uint32_t)strtoul(frame, NULL, 16);
+    *DLC = (uint8_t)strtoul(tokens[index + 2] + 1, NULL, 10);
+    return Parse_Hex_Bytes(&tokens[index + 3], number_of_tokens - index - 3, *DLC, data);
+}
+
+/* Read ahead the next frame from the log. Lines that are not frames are skipped */
+static void Read_Next_Frame(void) {
+    char line[REPLAY_LINE_LENGTH];
+    pending_frame = false;
+    while (fgets(line, sizeof(line), replay_file) != NULL) {
+        if (Parse_Line(line, &pending_time_stamp, &pending_ID, &pending_DLC, pending_data)) {
+            if (!first_frame_read) {
+                first_time_stamp = pending_time_stamp;
+                first_frame_read = true;
+            }
+            pending_time_stamp -= first_time_stamp;
+            pending_frame = true;
+            return;
+        }
+    }
+    replay_finished = true;
+}
+
+/* Give the stack the next frame from the log. In real time mode, the frame is held back until its time stamp is due */
+static void CAN_Replay_Receive(uint32_t *ID, uint8_t data[], bool *is_new_message) {
+    *is_new_message = false;
+    if (!pending_frame)
+        return;
+    if (replay_real_time) {
+        double elapsed = Wall_Clock_Seconds() - wall_clock_start;
+        if (elapsed < pending_time_stamp)
+            return;
+        replay_time_stamp = elapsed;
+    } else {
+        replay_time_stamp = pending_time_stamp;
+    }
+    *ID = pending_ID;
+    memcpy(data, pending_data, 8);
+    *is_new_message = true;
+    replay_frames_injected++;
+    Read_Next_Frame();
+}
+
+/* The clock of the stack follows the replay, so timeouts are deterministic when the log is injected as fast as possible */
+static uint32_t CAN_Replay_Clock(void) {
+    if (replay_real_time)
+        return (uint32_t)((Wall_Clock_Seconds() - wall_clock_start) * 1000.0);
+    return (uint32_t)(replay_time_stamp * 1000.0);
+}
+
+/* The same in microseconds, so the frames get the time stamps of the log */
+static uint32_t CAN_Replay_Clock_Microseconds(void) {
+    if (replay_real_time)
+        return (uint32_t)((Wall_Clock_Seconds() - wall_clock_start) * 1000000.0);
+    return (uint32_t)(replay_time_stamp * 1000000.0);
+}
+
+/* Capture what the stack transmits in candump -L format, so the output can be compared with a reference capture */
+static void CAN_Replay_Transmit(uint32_t ID, uint8_t DLC, uint8_t data[]) {
+    if (capture_file == NULL)
+        return;
+    if (replay_real_time)
+        replay_time_stamp = Wall_Clock_Seconds() - wall_clock_start;
+    fprintf(capture_file, "(%.6f) replay %08X#", replay_time_stamp, (unsigned int)ID);
+    for (uint8_t i = 0; i < DLC; i++)
+        fprintf(capture_file, "%02X", data[i]);
+    fprintf(capture_file, "\n");
+    replay_frames_captured++;
+}
+
+/*
+ * Open a recorded trace and start feeding it into the stack via CAN_Read_Message.
+ * real_time = true keeps the original timing between the frames, else the frames are injected as fast as possible.
+ * capture_file_name can be NULL if the transmitted frames should not be captured.
+ */
+bool CAN_Replay_Open(char replay_file_name[], char capture_file_name[], bool real_time) {
+    CAN_Replay_Close();
+    replay_file = fopen(replay_file_name, "r");
+    if (replay_file == NULL)
+        return false;
+    if (capture_file_name != NULL) {
+        capture_file = fopen(capture_file_name, "w");
+        if (capture_file == NULL) {
+            CAN_Replay_Close();
+            return false;
+        }
+    }
+
+    /* Reset */
+    replay_real_time = real_time;
+    replay_finished = false;
+    replay_frames_injected = 0;
+    replay_frames_captured = 0;
+    first_frame_read = false;
+    replay_time_stamp = 0.0;
+    wall_clock_start = Wall_Clock_Seconds();
+    Read_Next_Frame();
+
+    /* Plug in the replay as our hardware and clock */
+    CAN_Set_Callback_Functions(CAN_Replay_Transmit, CAN_Replay_Receive);
+    Clock_Set_Callback_Function(CAN_Replay_Clock);
+    Clock_Set_Microseconds_Callback_Function(CAN_Replay_Clock_Microseconds);
+    return true;
+}
+
+void CAN_Replay_Close(void) {
+    if (replay_file != NULL)
+        fclose(replay_file);
+    if (capture_file != NULL)
+        fclose(capture_file);
+    replay_file = NULL;
+    capture_file = NULL;
+    pending_frame = false;
+    replay_finished = true;
+    Clock_Set_Callback_Function(NULL);
+    Clock_Set_Microseconds_Callback_Function(NULL);
+}
+
+/* Returns true when every frame from the log has been given to the stack */
+bool CAN_Replay_Is_Finished(void) {
+    return replay_finished && !pending_frame;
+}
+
+/* How many frames that have been injected and captured since CAN_Replay_Open */
+void CAN_Replay_Get_Statistics(uint32_t *frames_injected, uint32_t *frames_captured) {
+    *frames_injected = replay_frames_injected;
+    *frames_captured = replay_frames_captured;
+}
+
+#endif
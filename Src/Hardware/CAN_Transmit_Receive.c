@@ -11,25 +11,197 @@
 #include  "semphr.h"
 #include "peripheral/can/plib_can2.h"
 
+/* C standard library */
+#include <stddef.h>
+#include <string.h>
 
 /* This is a call back function e.g listener, that will be called once SAE J1939 data is going to be sent */
 static void (*Callback_Function_Send)(uint32_t, uint8_t, uint8_t[]);
 static void (*Callback_Function_Read)(uint32_t *, uint8_t[], bool *);
+static void (*Callback_Function_Read_FD)(uint32_t *, uint8_t[], uint8_t *, bool *);
+
+/* The bytes after the message up to the length of the CAN FD frame - SAE J1939-22 */
+#define CAN_FD_PADDING 0xAA
 
 /* Platform independent library headers for CAN */
 #if PROCESSOR_CHOICE == STM32
 #include "main.h"
 #elif PROCESSOR_CHOICE == ARDUINO
 #elif PROCESSOR_CHOICE == PIC
+#include "queue.h"
+#include "task.h"
 
 static void CAN_callback(uintptr_t context);
+static void CAN_Receive_Callback(uintptr_t context);
 
 #define CAN_FIFO_NUMBER_RECEIVE 1
 
-#define CAN_FIFO_NUMBER_TRANSMIT 0
+/*
+ * Transmit FIFOs - One for every priority class, so a burst of bulk frames never delays a control frame.
+ * The numbers and sizes must match the CAN2 configuration, and the FIFO for high priority must have the highest TX priority in the hardware
+ */
+#ifndef CAN_FIFO_NUMBER_TRANSMIT_HIGH
+#define CAN_FIFO_NUMBER_TRANSMIT_HIGH 3                                 /* J1939 priority 0 to 3 e.g ISO 11783 valve commands */
+#endif
+#ifndef CAN_FIFO_NUMBER_TRANSMIT
+#define CAN_FIFO_NUMBER_TRANSMIT 0                                      /* J1939 priority 4 to 6 e.g requests, address claim and DM1 */
+#endif
+#ifndef CAN_FIFO_NUMBER_TRANSMIT_LOW
+#define CAN_FIFO_NUMBER_TRANSMIT_LOW 2                                  /* J1939 priority 7 e.g Transport Protocol */
+#endif
+#ifndef CAN_FIFO_SIZE_TRANSMIT_HIGH
+#define CAN_FIFO_SIZE_TRANSMIT_HIGH 8
+#endif
+#ifndef CAN_FIFO_SIZE_TRANSMIT
+#define CAN_FIFO_SIZE_TRANSMIT 32
+#endif
+#ifndef CAN_FIFO_SIZE_TRANSMIT_LOW
+#define CAN_FIFO_SIZE_TRANSMIT_LOW 8
+#endif
+
+/*
+ * Receive time stamps - CAN2 stamps every frame with a 16 bit counter when it arrives. The counter is extended to the 32 bit clock of Clock_Get_Microseconds.
+ * The tick must match the time stamp prescaler in the CAN2 configuration. A time stamp that is further away from the clock than the error is taken from the clock again
+ */
+#ifndef CAN_TIME_STAMP_TICK_US
+#define CAN_TIME_STAMP_TICK_US 1                                        /* Microseconds for every count of the time stamp counter */
+#endif
+#ifndef CAN_TIME_STAMP_MAX_ERROR_US
+#define CAN_TIME_STAMP_MAX_ERROR_US (2000 * portTICK_PERIOD_MS)
+#endif
+
+/* Priority classes - The lowest number is sent first */
+#define CAN_TRANSMIT_CLASS_HIGH 0
+#define CAN_TRANSMIT_CLASS_NORMAL 1
+#define CAN_TRANSMIT_CLASS_LOW 2
+#define CAN_TRANSMIT_CLASSES 3
+
+static const uint8_t CAN_transmit_fifo_number[CAN_TRANSMIT_CLASSES] = {CAN_FIFO_NUMBER_TRANSMIT_HIGH, CAN_FIFO_NUMBER_TRANSMIT, CAN_FIFO_NUMBER_TRANSMIT_LOW};
+static const uint8_t CAN_transmit_fifo_size[CAN_TRANSMIT_CLASSES] = {CAN_FIFO_SIZE_TRANSMIT_HIGH, CAN_FIFO_SIZE_TRANSMIT, CAN_FIFO_SIZE_TRANSMIT_LOW};
+
+/* A CAN frame that waits in a queue between the ISR, the J1939 stack and the transmit task */
+struct CAN_queue_frame {
+    uint32_t ID;
+    uint8_t DLC;                                                                    /* How many bytes of data */
+    bool is_FD;                                                                     /* Sent as a CAN FD frame - Only for frames that are sent */
+    uint8_t data[CAN_MAX_DATA_LENGTH];
+    uint32_t time_stamp;                                                            /* When the frame arrived in microseconds - Only for received frames */
+};
+
+/* Internal fields */
+static QueueHandle_t CAN_receive_queue = NULL;
+static QueueHandle_t CAN_transmit_queue[CAN_TRANSMIT_CLASSES] = {NULL};
+static SemaphoreHandle_t CAN_transmit_semaphore[CAN_TRANSMIT_CLASSES] = {NULL};    /* Counts the free buffers in every transmit FIFO */
+static TaskHandle_t CAN_transmit_task = NULL;
+static struct CAN_queue_frame CAN_receive_frame;                                    /* The receive ISR writes the frame here */
+static uint16_t CAN_receive_timestamp = 0;
+static CAN_MSG_RX_ATTRIBUTE CAN_receive_attribute = CAN_MSG_RX_DATA_FRAME;
+static uint16_t CAN_last_receive_timestamp = 0;
+static uint32_t CAN_last_receive_time_stamp = 0;
+static bool CAN_is_receive_time_stamp_synchronized = false;
+
+/* Internal functions */
+static void CAN_Init_Queues(void) {
+    if (CAN_receive_queue != NULL)
+        return;
+    CAN_receive_queue = xQueueCreate(CAN_RX_QUEUE_LENGTH, sizeof(struct CAN_queue_frame));
+    configASSERT(CAN_receive_queue != NULL);
+    for (uint8_t i = 0; i < CAN_TRANSMIT_CLASSES; i++) {
+        CAN_transmit_queue[i] = xQueueCreate(CAN_TX_QUEUE_LENGTH, sizeof(struct CAN_queue_frame));
+        CAN_transmit_semaphore[i] = xSemaphoreCreateCounting(CAN_transmit_fifo_size[i], CAN_transmit_fifo_size[i]);
+        configASSERT(CAN_transmit_queue[i] != NULL && CAN_transmit_semaphore[i] != NULL);
+        CAN2_CallbackRegister(CAN_callback, (uintptr_t) i, CAN_transmit_fifo_number[i]);
+    }
+    CAN2_CallbackRegister(CAN_Receive_Callback, (uintptr_t) CAN_receive_queue, CAN_FIFO_NUMBER_RECEIVE);
+
+    /* Arm the receive FIFO - The ISR arms it again after every frame */
+    CAN2_MessageReceive(&CAN_receive_frame.ID, &CAN_receive_frame.DLC, CAN_receive_frame.data, &CAN_receive_timestamp, CAN_FIFO_NUMBER_RECEIVE, &CAN_receive_attribute);
+}
+
+/*
+ * Extend the 16 bit time stamp of the hardware to microseconds. The counter says how long it was since the last frame, and the tick count says how many times the counter has wrapped around.
+ * This runs in the receive ISR, so the tick count is never more than a tick behind the frame
+ */
+static uint32_t CAN_Extend_Time_Stamp(uint16_t timestamp) {
+    const uint32_t period = 0x10000UL * CAN_TIME_STAMP_TICK_US;
+    const int32_t max_error = CAN_TIME_STAMP_MAX_ERROR_US;
+    uint32_t now = xTaskGetTickCountFromISR() * portTICK_PERIOD_MS * 1000;         /* Same as Clock_Get_Microseconds, but safe in the ISR */
+    uint32_t time_stamp = CAN_last_receive_time_stamp + (uint16_t)(timestamp - CAN_last_receive_timestamp) * CAN_TIME_STAMP_TICK_US;
+    int32_t behind = (int32_t)(now - time_stamp);
+    if (behind > 0)
+        time_stamp += (behind + period / 2) / period * period;
+    behind = (int32_t)(now - time_stamp);
+    if (!CAN_is_receive_time_stamp_synchronized || behind > max_error || behind < -max_error) {
+        time_stamp = now;                                                           /* First frame or the counter has drifted away from the clock */
+        CAN_is_receive_time_stamp_synchronized = true;
+    }
+    CAN_last_receive_timestamp = timestamp;
+    CAN_last_receive_time_stamp = time_stamp;
+    return time_stamp;
+}
 
-#define CAN_FIFO_NUMBER_REQUEST 2
+/* The priority is the 3 highest bits of the 29 bit ID */
+static uint8_t CAN_Get_Transmit_Class(uint32_t ID) {
+    uint8_t priority = (ID >> 26) & 0x7;
+    if (priority <= 3)
+        return CAN_TRANSMIT_CLASS_HIGH;
+    if (priority <= 6)
+        return CAN_TRANSMIT_CLASS_NORMAL;
+    return CAN_TRANSMIT_CLASS_LOW;
+}
 
+/* Take a free buffer in the FIFO of the class and give the frame to the hardware. The ISR gives the buffer back when the frame is sent */
+static ENUM_J1939_STATUS_CODES CAN_Transmit_Frame(uint8_t transmit_class, struct CAN_queue_frame *frame, TickType_t wait) {
+    if (xSemaphoreTake(CAN_transmit_semaphore[transmit_class], wait) != pdTRUE)
+        return STATUS_SEND_TIMEOUT;
+    #if CAN_FD
+    bool is_given = CAN2_MessageTransmit(frame->ID, frame->DLC, frame->data, CAN_transmit_fifo_number[transmit_class], frame->is_FD ? CAN_MODE_FD_WITH_BRS : CAN_MODE_NORMAL, CAN_MSG_TX_DATA_FRAME);
+    #else
+    bool is_given = CAN2_MessageTransmit(frame->ID, frame->DLC, frame->data, CAN_transmit_fifo_number[transmit_class], CAN_MSG_TX_DATA_FRAME);
+    #endif
+    if (is_given == false) {
+        xSemaphoreGive(CAN_transmit_semaphore[transmit_class]);
+        return STATUS_SEND_BUSY;
+    }
+    return STATUS_SEND_OK;
+}
+
+/* Give the frame to the transmit task, or send it directly if the task is not started */
+static ENUM_J1939_STATUS_CODES CAN_Queue_Frame(uint32_t ID, uint8_t DLC, uint8_t data[], bool is_FD) {
+    CAN_Init_Queues();
+    struct CAN_queue_frame frame = {.ID = ID, .DLC = DLC, .is_FD = is_FD};
+    memcpy(frame.data, data, DLC);
+    uint8_t transmit_class = CAN_Get_Transmit_Class(ID);
+    if (CAN_transmit_task == NULL)
+        return CAN_Transmit_Frame(transmit_class, &frame, pdMS_TO_TICKS(CAN_TX_QUEUE_WAIT_MS));
+    if (xQueueSend(CAN_transmit_queue[transmit_class], &frame, pdMS_TO_TICKS(CAN_TX_QUEUE_WAIT_MS)) != pdTRUE)
+        return STATUS_SEND_BUSY;
+    xTaskNotifyGive(CAN_transmit_task);
+    return STATUS_SEND_OK;
+}
+
+/*
+ * Drain the transmit queues. The highest class that has both a frame and a free FIFO buffer is always sent first.
+ * A class without free buffers does not block the other classes. The order inside a class is kept
+ */
+static void CAN_Transmit_Task(void *parameter) {
+    struct CAN_queue_frame frame;
+    for (;;) {
+        bool is_sent = false;
+        for (uint8_t i = 0; i < CAN_TRANSMIT_CLASSES && !is_sent; i++) {
+            if (xQueuePeek(CAN_transmit_queue[i], &frame, 0) != pdTRUE)
+                continue;
+            if (CAN_Transmit_Frame(i, &frame, 0) == STATUS_SEND_OK) {
+                xQueueReceive(CAN_transmit_queue[i], &frame, 0);
+                is_sent = true;
+            }
+        }
+
+        /* Sleep until a new frame is queued or the ISR gives a buffer back. The timeout handles a FIFO that refused a frame */
+        if (!is_sent)
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1));
+    }
+}
 
 #elif PROCESSOR_CHOICE == AVR
 #elif PROCESSOR_CHOICE == QT_USB
@@ -39,7 +211,7 @@ static void CAN_callback(uintptr_t context);
 #else
 /* Internal fields */
 static bool internal_new_message[256] = {false};
-static uint8_t internal_data[256 * 8] = {0};
+static uint8_t internal_data[256 * CAN_MAX_DATA_LENGTH] = {0};
 static uint8_t internal_DLC[256] = {0};
 static uint32_t internal_ID[256] = {0};
 static uint8_t buffer_index_transmit = 0;
@@ -49,17 +221,17 @@ static uint8_t buffer_index_receive = 0;
 static ENUM_J1939_STATUS_CODES Internal_Transmit(uint32_t ID, uint8_t data[], uint8_t DLC) {
     internal_ID[buffer_index_transmit] = ID;
     internal_DLC[buffer_index_transmit] = DLC;
-    for (uint8_t i = 0; i < 8; i++)
+    for (uint8_t i = 0; i < CAN_MAX_DATA_LENGTH; i++)
         if (i < DLC)
-            internal_data[buffer_index_transmit * 8 + i] = data[i];
+            internal_data[buffer_index_transmit * CAN_MAX_DATA_LENGTH + i] = data[i];
         else
-            internal_data[buffer_index_transmit * 8 + i] = 0x0;
+            internal_data[buffer_index_transmit * CAN_MAX_DATA_LENGTH + i] = 0x0;
     internal_new_message[buffer_index_transmit] = true;
     buffer_index_transmit++;                                    /* When this is 256, then it will be come 0 again */
     return STATUS_SEND_OK;
 }
 
-static void Internal_Receive(uint32_t *ID, uint8_t data[], bool *is_new_message) {
+static void Internal_Receive(uint32_t *ID, uint8_t data[], uint8_t *DLC, bool *is_new_message) {
     /* Do a quick check if we are going to read message that have no data */
     if (internal_new_message[buffer_index_receive] == false) {
         *is_new_message = false;
@@ -67,9 +239,10 @@ static void Internal_Receive(uint32_t *ID, uint8_t data[], bool *is_new_message)
     }
 
     *ID = internal_ID[buffer_index_receive];
-    for (uint8_t i = 0; i < 8; i++)
+    *DLC = internal_DLC[buffer_index_receive];
+    for (uint8_t i = 0; i < CAN_MAX_DATA_LENGTH; i++)
         if (i < internal_DLC[buffer_index_receive])
-            data[i] = internal_data[buffer_index_receive * 8 + i];
+            data[i] = internal_data[buffer_index_receive * CAN_MAX_DATA_LENGTH + i];
     *is_new_message = internal_new_message[buffer_index_receive];
     /* Reset */
     internal_new_message[buffer_index_receive] = false;
@@ -93,27 +266,7 @@ ENUM_J1939_STATUS_CODES CAN_Send_Message(uint32_t ID, uint8_t data[]) {
     #elif PROCESSOR_CHOICE == ARDUINO
     /* Implement your CAN send 8 bytes message function for the Arduino platform */
     #elif PROCESSOR_CHOICE == PIC
-    /* Implement your CAN send 8 bytes message function for the PIC platform */
-    static SemaphoreHandle_t CAN_transmit_semaphore = NULL;
-    if (CAN_transmit_semaphore == NULL) {
-        CAN_transmit_semaphore = xSemaphoreCreateCounting(32,32); //32 buffers on CAN_FIFO_NUMBER_TRANSMIT, If count == 0 there is no buffers availables
-        configASSERT(CAN_transmit_semaphore != NULL);
-        CAN2_CallbackRegister(CAN_callback, (uintptr_t) CAN_transmit_semaphore, CAN_FIFO_NUMBER_TRANSMIT);
-    }
-    if (CAN2_MessageTransmit(ID, 8, data, CAN_FIFO_NUMBER_TRANSMIT, CAN_MSG_TX_DATA_FRAME) == false) {
-        // vTaskDelay(pdMS_TO_TICKS(10));
-        status = STATUS_SEND_BUSY;
-	 
-    }
-    else {
-        if(xSemaphoreTake(CAN_transmit_semaphore, pdMS_TO_TICKS(25)) == pdTRUE) {
-            status = STATUS_SEND_OK;
-        }
-        else {
-            status = STATUS_SEND_TIMEOUT;
-        }
-        
-    }
+    status = CAN_Queue_Frame(ID, 8, data, false);
     #elif PROCESSOR_CHOICE == AVR
     /* Implement your CAN send 8 bytes message function for the AVR platform */
     #elif PROCESSOR_CHOICE == QT_USB
@@ -126,6 +279,10 @@ ENUM_J1939_STATUS_CODES CAN_Send_Message(uint32_t ID, uint8_t data[]) {
     /* If no processor are used, use internal feedback for debugging */
     status = Internal_Transmit(ID, data, 8);
     #endif
+    if (status == STATUS_SEND_OK)
+        CAN_Bus_Load_Add_Frame(ID, 8, data);
+    else
+        TRACE_FRAME_EVENT(TRACE_EVENT_SEND_FAILED, ID, status);
     return status;
 }
 
@@ -146,27 +303,7 @@ ENUM_J1939_STATUS_CODES CAN_Send_Request(uint32_t ID, uint8_t PGN[]) {
     #elif PROCESSOR_CHOICE == ARDUINO
     /* Implement your CAN send 3 bytes message function for the Arduino platform */
     #elif PROCESSOR_CHOICE == PIC
-    static SemaphoreHandle_t CAN_request_semaphore = NULL;
-    if (CAN_request_semaphore == NULL) {
-        CAN_request_semaphore = xSemaphoreCreateBinary();
-        configASSERT(CAN_request_semaphore != NULL);
-        CAN2_CallbackRegister(CAN_callback, (uintptr_t) CAN_request_semaphore, CAN_FIFO_NUMBER_REQUEST);
-    }
-    if (CAN2_MessageTransmit(ID, 8, PGN, CAN_FIFO_NUMBER_REQUEST, CAN_MSG_TX_DATA_FRAME) == false) {
-        vTaskDelay(pdMS_TO_TICKS(10));
-        status = STATUS_SEND_BUSY;
-	 
-    }
-    else {
-        if(xSemaphoreTake(CAN_request_semaphore, pdMS_TO_TICKS(10)) == pdTRUE) {
-            status = STATUS_SEND_OK;
-        }
-        else {
-            status = STATUS_SEND_TIMEOUT;
-        }
-        
-    }
-    /* Implement your CAN send 3 bytes message function for the PIC platform */
+    status = CAN_Queue_Frame(ID, 3, PGN, false);                /* PGN is always 3 bytes */
     #elif PROCESSOR_CHOICE == AVR
     /* Implement your CAN send 3 bytes message function for the AVR platform */
     #elif PROCESSOR_CHOICE == QT_USB
@@ -179,58 +316,173 @@ ENUM_J1939_STATUS_CODES CAN_Send_Request(uint32_t ID, uint8_t PGN[]) {
     /* If no processor are used, use internal feedback for debugging */
     status = Internal_Transmit(ID, PGN, 3);
     #endif
+    if (status == STATUS_SEND_OK)
+        CAN_Bus_Load_Add_Frame(ID, 3, PGN);
+    else
+        TRACE_FRAME_EVENT(TRACE_EVENT_SEND_FAILED, ID, status);
+    return status;
+}
+
+/*
+ * The length of the CAN FD frame that a message of length bytes fits in - SAE J1939-22.
+ * Up to 8 bytes the length is the same, then a CAN FD frame can only have 12, 16, 20, 24, 32, 48 or 64 bytes
+ */
+uint8_t CAN_Get_FD_Length(uint8_t length) {
+    static const uint8_t FD_lengths[] = {12, 16, 20, 24, 32, 48, 64};
+    if (length <= 8)
+        return length;
+    for (uint8_t i = 0; i < sizeof(FD_lengths); i++)
+        if (length <= FD_lengths[i])
+            return FD_lengths[i];
+    return 64;
+}
+
+/*
+ * Send a CAN FD frame with 0 to 64 bytes - SAE J1939-22. The frame is padded up to the next length that a CAN FD frame can have.
+ * Returns STATUS_SEND_ERROR if CAN_FD is 0 or the platform has no CAN FD
+ */
+ENUM_J1939_STATUS_CODES CAN_Send_Message_FD(uint32_t ID, uint8_t data[], uint8_t length) {
+    ENUM_J1939_STATUS_CODES status;
+    uint8_t DLC = CAN_Get_FD_Length(length);
+    if (DLC > CAN_MAX_DATA_LENGTH)
+        return STATUS_SEND_ERROR;
+    uint8_t frame[CAN_MAX_DATA_LENGTH];
+    for (uint8_t i = 0; i < DLC; i++)
+        frame[i] = i < length ? data[i] : CAN_FD_PADDING;
+    #if PROCESSOR_CHOICE == STM32
+    /* Implement your CAN FD send function for the STM32 platform with the FDCAN peripheral */
+    status = STATUS_SEND_ERROR;
+    #elif PROCESSOR_CHOICE == ARDUINO
+    /* Implement your CAN FD send function for the Arduino platform */
+    #elif PROCESSOR_CHOICE == PIC
+    status = CAN_Queue_Frame(ID, DLC, frame, true);
+    #elif PROCESSOR_CHOICE == AVR
+    /* Implement your CAN FD send function for the AVR platform */
+    #elif PROCESSOR_CHOICE == QT_USB
+    /* Implement your CAN FD send function for the QT USB platform */
+    status = STATUS_SEND_ERROR;
+    #elif PROCESSOR_CHOICE == INTERNAL_CALLBACK
+    /* Call our callback function */
+    Callback_Function_Send(ID, DLC, frame);
+    status = STATUS_SEND_OK;
+    #else
+    /* If no processor are used, use internal feedback for debugging */
+    status = Internal_Transmit(ID, frame, DLC);
+    #endif
+    if (status == STATUS_SEND_OK)
+        CAN_Bus_Load_Add_FD_Frame(ID, DLC);
+    else
+        TRACE_FRAME_EVENT(TRACE_EVENT_SEND_FAILED, ID, status);
     return status;
 }
 
 /* Read the current CAN-bus message. Returning false if the message has been read before, else true */
 bool CAN_Read_Message(uint32_t *ID, uint8_t data[]) {
+    uint32_t time_stamp;
+    return CAN_Read_Message_Time_Stamp(ID, data, &time_stamp);
+}
+
+/* Same as CAN_Read_Message, but time_stamp tells when the frame arrived in microseconds of Clock_Get_Microseconds. It's from the CAN hardware if the platform has it, else from when the frame was read */
+bool CAN_Read_Message_Time_Stamp(uint32_t *ID, uint8_t data[], uint32_t *time_stamp) {
+    uint8_t frame[CAN_MAX_DATA_LENGTH];
+    uint8_t length;
+    bool is_new_message = CAN_Read_Message_FD(ID, frame, &length, time_stamp);
+    if (is_new_message)
+        memcpy(data, frame, 8);                                 /* Only the first 8 bytes of a CAN FD frame */
+    return is_new_message;
+}
+
+/*
+ * Same as CAN_Read_Message_Time_Stamp, but data gets up to CAN_MAX_DATA_LENGTH bytes and length tells how many bytes the frame has.
+ * The bytes after the frame are 0. length is at least 8, because the functions that read a frame take always 8 bytes
+ */
+bool CAN_Read_Message_FD(uint32_t *ID, uint8_t data[], uint8_t *length, uint32_t *time_stamp) {
     bool is_new_message;
+    memset(data, 0x0, CAN_MAX_DATA_LENGTH);
+    *length = 8;
     #if PROCESSOR_CHOICE == STM32
     STM32_PLC_CAN_Get_ID_Data(ID, data, &is_new_message);
     #elif PROCESSOR_CHOICE == ARDUINO
     /* Implement your CAN function to get ID, data[] and the flag is_new_message here for the Arduino platform */
     #elif PROCESSOR_CHOICE == PIC
-    is_new_message = false;
-    static CAN_MSG_RX_ATTRIBUTE msgAttr = CAN_MSG_RX_DATA_FRAME;
-    static SemaphoreHandle_t CAN_receive_semaphore = NULL;
-    if (CAN_receive_semaphore == NULL) {
-        CAN_receive_semaphore = xSemaphoreCreateBinary();
-        configASSERT(CAN_receive_semaphore != NULL);
-        CAN2_CallbackRegister(CAN_callback, (uintptr_t) CAN_receive_semaphore, CAN_FIFO_NUMBER_RECEIVE);
-    }
-    uint8_t rx_messageLength = 0;
-    uint16_t timestamp = 0;
-    if (CAN2_MessageReceive(ID, &rx_messageLength, data, &timestamp, CAN_FIFO_NUMBER_RECEIVE, &msgAttr) == true) {
-        if (xSemaphoreTake(CAN_receive_semaphore, portMAX_DELAY) == pdTRUE) {
-            is_new_message = true;
-        }
-    }
-    else {
-        vTaskDelay(pdMS_TO_TICKS(10));
+    /* Block until the ISR has put a frame in the queue, but not longer than CAN_RX_WAIT_MS so the timeouts are still checked */
+    CAN_Init_Queues();
+    struct CAN_queue_frame frame;
+    is_new_message = xQueueReceive(CAN_receive_queue, &frame, pdMS_TO_TICKS(CAN_RX_WAIT_MS)) == pdTRUE;
+    if (is_new_message) {
+        *ID = frame.ID;
+        *length = frame.DLC;
+        memcpy(data, frame.data, frame.DLC);
+        *time_stamp = frame.time_stamp;
     }
     #elif PROCESSOR_CHOICE == AVR
     /* Implement your CAN function to get ID, data[] and the flag is_new_message here for the AVR platform */
     #elif PROCESSOR_CHOICE == QT_USB
     QT_USB_Get_ID_Data(ID, data, &is_new_message);
     #elif PROCESSOR_CHOICE == INTERNAL_CALLBACK
-    Callback_Function_Read(ID, data, &is_new_message);
+    if (Callback_Function_Read_FD != NULL)
+        Callback_Function_Read_FD(ID, data, length, &is_new_message);
+    else
+        Callback_Function_Read(ID, data, &is_new_message);
     #else
     /* If no processor are used, use internal feedback for debugging */
-    Internal_Receive(ID, data, &is_new_message);
+    Internal_Receive(ID, data, length, &is_new_message);
+    #endif
+    #if PROCESSOR_CHOICE != PIC
+    *time_stamp = Clock_Get_Microseconds();                     /* No time stamp from the hardware - The frame is stamped when it's read */
     #endif
+    if (is_new_message && *length > 8)
+        CAN_Bus_Load_Add_FD_Frame(*ID, *length);
+    else if (is_new_message)
+        CAN_Bus_Load_Add_Frame(*ID, *length, data);            /* The real DLC, so a short frame is counted the same as when it's sent */
+    if (*length < 8)
+        *length = 8;                                            /* The functions that read a frame take always 8 bytes, also from a shorter frame */
     return is_new_message;
 }
 
 void CAN_Set_Callback_Functions(void (*Callback_Function_Send_)(uint32_t, uint8_t, uint8_t[]), void (*Callback_Function_Read_)(uint32_t *, uint8_t[], bool *)) {
     Callback_Function_Send = Callback_Function_Send_;
     Callback_Function_Read = Callback_Function_Read_;
+    Callback_Function_Read_FD = NULL;                           /* Set the FD read callback after this if the frames are read with their length */
 }
 
+/* A read callback that also gives the length of the frame, so CAN FD frames can be read. It's used instead of the read callback above when it's not NULL */
+void CAN_Set_Read_FD_Callback_Function(void (*Callback_Function_Read_FD_)(uint32_t *, uint8_t[], uint8_t *, bool *)) {
+    Callback_Function_Read_FD = Callback_Function_Read_FD_;
+}
+
+#if PROCESSOR_CHOICE == PIC
+/* Start the task that sends the queued frames. Call this once before the scheduler starts, else CAN_Send_Message sends directly */
+bool CAN_Start_Transmit_Task(void) {
+    CAN_Init_Queues();
+    if (CAN_transmit_task != NULL)
+        return true;
+    return xTaskCreate(CAN_Transmit_Task, "CAN TX", CAN_TX_TASK_STACK_SIZE, NULL, CAN_TX_TASK_PRIORITY, &CAN_transmit_task) == pdPASS;
+}
+
+/* A frame has arrived in the receive FIFO. Give it to the queue and arm the FIFO for the next frame. If the queue is full, the frame is lost */
+static void CAN_Receive_Callback(uintptr_t context) {
+    BaseType_t HigherPriorityTaskWoken = pdFALSE;
+
+    CAN_receive_frame.time_stamp = CAN_Extend_Time_Stamp(CAN_receive_timestamp);
+    xQueueSendFromISR((QueueHandle_t) context, &CAN_receive_frame, &HigherPriorityTaskWoken);
+    CAN2_MessageReceive(&CAN_receive_frame.ID, &CAN_receive_frame.DLC, CAN_receive_frame.data, &CAN_receive_timestamp, CAN_FIFO_NUMBER_RECEIVE, &CAN_receive_attribute);
+    if (HigherPriorityTaskWoken == pdTRUE) {
+        portEND_SWITCHING_ISR(HigherPriorityTaskWoken);
+    }
+}
+#endif
+
+#if PROCESSOR_CHOICE == PIC
 static void CAN_callback(uintptr_t context) {
-    BaseType_t HigherPriorityTaskWoken;
+    BaseType_t HigherPriorityTaskWoken = pdFALSE;
 
-    xSemaphoreGiveFromISR((SemaphoreHandle_t) context, &HigherPriorityTaskWoken);
+    /* context is the transmit class. A frame has been sent, so a buffer in the FIFO is free again */
+    xSemaphoreGiveFromISR(CAN_transmit_semaphore[context], &HigherPriorityTaskWoken);
+    if (CAN_transmit_task != NULL)
+        vTaskNotifyGiveFromISR(CAN_transmit_task, &HigherPriorityTaskWoken);
     if (HigherPriorityTaskWoken == pdTRUE) {
         portEND_SWITCHING_ISR(HigherPriorityTaskWoken);
     }
 }
+#endif
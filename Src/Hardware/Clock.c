@@ -0,0 +1,89 @@
+/*
+ * Clock.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+/* Needed for clock_gettime() when compiling as C99 */
+#define _POSIX_C_SOURCE 199309L
+
+#include "Hardware.h"
+
+/* C standard library */
+#include <stddef.h>
+
+/* This is a call back function that can replace the clock of the platform, e.g a simulated clock or a replayed log */
+static uint32_t (*Callback_Function_Clock)(void) = NULL;
+static uint32_t (*Callback_Function_Clock_Microseconds)(void) = NULL;
+
+/* Platform independent library headers for the clock */
+#if PROCESSOR_CHOICE == STM32
+#include "main.h"
+#elif PROCESSOR_CHOICE == ARDUINO
+#elif PROCESSOR_CHOICE == PIC
+#include "FreeRTOS.h"
+#include "task.h"
+#elif PROCESSOR_CHOICE == AVR
+#else
+#include <time.h>
+#endif
+
+/* Read a monotonic clock in milliseconds. It's allowed to wrap around at 0xFFFFFFFF, so always compare with (now - then) */
+uint32_t Clock_Get_Milliseconds(void) {
+    if (Callback_Function_Clock != NULL)
+        return Callback_Function_Clock();
+    #if PROCESSOR_CHOICE == STM32
+    return HAL_GetTick();
+    #elif PROCESSOR_CHOICE == ARDUINO
+    /* Implement your millisecond clock for the Arduino platform */
+    return 0;
+    #elif PROCESSOR_CHOICE == PIC
+    return xTaskGetTickCount() * portTICK_PERIOD_MS;
+    #elif PROCESSOR_CHOICE == AVR
+    /* Implement your millisecond clock for the AVR platform */
+    return 0;
+    #else
+    /* PC */
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+    #endif
+}
+
+/* Replace the clock of the platform. Use NULL to go back to the clock of the platform */
+void Clock_Set_Callback_Function(uint32_t (*Callback_Function_Clock_)(void)) {
+    Callback_Function_Clock = Callback_Function_Clock_;
+}
+
+/*
+ * Read the same monotonic clock in microseconds. This is the clock of the receive time stamps of the CAN frames. It wraps around after 71 minutes, so always compare with (now - then).
+ * A replaced clock in milliseconds is followed, so a simulated clock stays the same in both units
+ */
+uint32_t Clock_Get_Microseconds(void) {
+    if (Callback_Function_Clock_Microseconds != NULL)
+        return Callback_Function_Clock_Microseconds();
+    if (Callback_Function_Clock != NULL)
+        return Callback_Function_Clock() * 1000;
+    #if PROCESSOR_CHOICE == STM32
+    return HAL_GetTick() * 1000;                                /* Use a free running timer here if the application needs better than the tick */
+    #elif PROCESSOR_CHOICE == ARDUINO
+    /* Implement your microsecond clock for the Arduino platform */
+    return 0;
+    #elif PROCESSOR_CHOICE == PIC
+    return xTaskGetTickCount() * portTICK_PERIOD_MS * 1000;
+    #elif PROCESSOR_CHOICE == AVR
+    /* Implement your microsecond clock for the AVR platform */
+    return 0;
+    #else
+    /* PC */
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(now.tv_sec * 1000000 + now.tv_nsec / 1000);
+    #endif
+}
+
+/* Replace the clock in microseconds, e.g with the time stamps of a replayed log. Use NULL to go back to the clock in milliseconds */
+void Clock_Set_Microseconds_Callback_Function(uint32_t (*Callback_Function_Clock_Microseconds_)(void)) {
+    Callback_Function_Clock_Microseconds = Callback_Function_Clock_Microseconds_;
+}
@@ -7,29 +7,93 @@
 
 #include "Hardware.h"
 
+/* C standard library */
+#include <string.h>
+
 /*
- * This function ask the hardware for memory access with pointers.
- * Those pointers are translated to DM15 memory responses after the function exist
- * DM14:						DM15:
- * number_of_requested_bytes -> number_of_allowed_bytes
- * command					 -> status
- * pointer					 -> EDC_parameter
- * pointer_extension		 -> EDCP_extention
- * key						 -> seed
+ * Memory backends for the DM14 memory regions. Register them with SAE_J1939_Add_Memory_Region.
+ * offset is counted from the start of the region and the stack has already checked that offset + length is inside the region.
  */
-void FLASH_EEPROM_RAM_Memory(uint16_t *number_of_requested_bytes, uint8_t pointer_type, uint8_t *command, uint32_t *pointer, uint8_t *pointer_extension, uint16_t *key, uint8_t raw_binary_data[]){
+
+/* RAM backend - context is a pointer to the first byte of the region. Works also for a memory mapped flash that is only read, or a file mapped with mmap */
+bool FLASH_EEPROM_RAM_Memory_Read_RAM(void *context, uint32_t offset, uint8_t data[], uint16_t length) {
+	memcpy(data, (uint8_t*)context + offset, length);
+	return true;
+}
+
+bool FLASH_EEPROM_RAM_Memory_Write_RAM(void *context, uint32_t offset, const uint8_t data[], uint16_t length) {
+	memcpy((uint8_t*)context + offset, data, length);
+	return true;
+}
+
+/* Erased memory reads as 0xFF, just like flash */
+bool FLASH_EEPROM_RAM_Memory_Erase_RAM(void *context, uint32_t offset, uint32_t length) {
+	memset((uint8_t*)context + offset, 0xFF, length);
+	return true;
+}
+
 #if PROCESSOR_CHOICE == STM32
-	/* Implement your memory handler function for the STM32 platform */
+	/* Implement your flash and EEPROM callbacks for the STM32 platform */
 #elif PROCESSOR_CHOICE == ARDUINO
-	/* Implement your memory handler function for the Arduino platform */
+	/* Implement your flash and EEPROM callbacks for the Arduino platform */
 #elif PROCESSOR_CHOICE == PIC
-	/* Implement your memory handler function for the PIC platform */
+	/* Implement your flash and EEPROM callbacks for the PIC platform */
 #elif PROCESSOR_CHOICE == AVR
-	/* Implement your memory handler function for the AVR platform */
+	/* Implement your flash and EEPROM callbacks for the AVR platform */
 #else
-	/* If no processor are used, use internal feedback for debugging */
-	*command = STATUS_DM15_PROCEED;
-#endif
+/* C standard library */
+#include <stdio.h>
+
+/* Open the file for reading and writing at offset. A file that is too short is filled up with erased bytes */
+static FILE *Open_File(char file_name[], uint32_t offset) {
+	FILE *file = fopen(file_name, "r+b");
+	if(file == NULL)
+		file = fopen(file_name, "w+b");
+	if(file == NULL)
+		return NULL;
+	if(fseek(file, 0, SEEK_END) != 0){
+		fclose(file);
+		return NULL;
+	}
+	for(long size = ftell(file); size >= 0 && (uint32_t)size < offset; size++)
+		fputc(0xFF, file);
+	if(fseek(file, offset, SEEK_SET) != 0){
+		fclose(file);
+		return NULL;
+	}
+	return file;
 }
 
+/* File backend - context is the file name. Useful as flash or EEPROM when the stack runs on a PC. Bytes after the end of the file read as erased */
+bool FLASH_EEPROM_RAM_Memory_Read_File(void *context, uint32_t offset, uint8_t data[], uint16_t length) {
+	memset(data, 0xFF, length);
+	FILE *file = fopen((char*)context, "rb");
+	if(file == NULL)
+		return true;														/* Nothing has been written yet */
+	bool is_read = fseek(file, offset, SEEK_SET) == 0;
+	if(is_read){
+		fread(data, 1, length, file);
+		is_read = !ferror(file);
+	}
+	fclose(file);
+	return is_read;
+}
 
+bool FLASH_EEPROM_RAM_Memory_Write_File(void *context, uint32_t offset, const uint8_t data[], uint16_t length) {
+	FILE *file = Open_File((char*)context, offset);
+	if(file == NULL)
+		return false;
+	bool is_written = fwrite(data, 1, length, file) == length;
+	return fclose(file) == 0 && is_written;
+}
+
+bool FLASH_EEPROM_RAM_Memory_Erase_File(void *context, uint32_t offset, uint32_t length) {
+	FILE *file = Open_File((char*)context, offset);
+	if(file == NULL)
+		return false;
+	bool is_erased = true;
+	for(uint32_t i = 0; i < length && is_erased; i++)
+		is_erased = fputc(0xFF, file) != EOF;
+	return fclose(file) == 0 && is_erased;
+}
+#endif
@@ -15,15 +15,59 @@
 #define AVR 4
 #define QT_USB 5
 #define INTERNAL_CALLBACK 6
-#define PROCESSOR_CHOICE PIC
+#ifndef PROCESSOR_CHOICE
+#define PROCESSOR_CHOICE PIC                    /* Can be changed with a compiler flag, as the tests do */
+#endif
+
+/* FreeRTOS task model - Only with PROCESSOR_CHOICE PIC. Every value can be changed with a compiler flag */
+#ifndef CAN_RX_TASK_PRIORITY
+#define CAN_RX_TASK_PRIORITY 4                  /* Runs the J1939 dispatch - Should be higher than the application tasks so responses go out directly */
+#endif
+#ifndef CAN_TX_TASK_PRIORITY
+#define CAN_TX_TASK_PRIORITY 4
+#endif
+#ifndef CAN_RX_TASK_STACK_SIZE
+#define CAN_RX_TASK_STACK_SIZE 1024             /* In words - The callbacks of the application run on this stack */
+#endif
+#ifndef CAN_TX_TASK_STACK_SIZE
+#define CAN_TX_TASK_STACK_SIZE 256              /* In words */
+#endif
+#ifndef CAN_RX_QUEUE_LENGTH
+#define CAN_RX_QUEUE_LENGTH 32                  /* Frames between the receive ISR and the RX task - 0.6 KB, or 2.4 KB with CAN_FD */
+#endif
+#ifndef CAN_TX_QUEUE_LENGTH
+#define CAN_TX_QUEUE_LENGTH 64                  /* Frames between CAN_Send_Message and the TX task - There is one queue for every priority class. A frame takes 20 bytes, or 76 bytes with CAN_FD, so the three queues take 3.8 KB, or 14.6 KB with CAN_FD */
+#endif
+#ifndef CAN_TX_QUEUE_WAIT_MS
+#define CAN_TX_QUEUE_WAIT_MS 25                 /* How long CAN_Send_Message waits for room in a full transmit queue - Or for a free transmit buffer before the transmit task is started */
+#endif
+#ifndef INFORMATION_SAVE_TASK_PRIORITY
+#define INFORMATION_SAVE_TASK_PRIORITY 1        /* The storage is slow - Run it below the CAN tasks and the application */
+#endif
+#ifndef INFORMATION_SAVE_TASK_STACK_SIZE
+#define INFORMATION_SAVE_TASK_STACK_SIZE 512    /* In words */
+#endif
+#ifndef CAN_RX_WAIT_MS
+#define CAN_RX_WAIT_MS 10                       /* How long CAN_Read_Message waits for a frame before the timeouts are checked again */
+#endif
+
+/* Trace of protocol events in a RAM ring. With 0 the trace points are removed by the compiler and the ring takes no RAM */
+#ifndef OPEN_SAE_J1939_TRACE
+#define OPEN_SAE_J1939_TRACE 0
+#endif
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE 128                     /* Records of 12 bytes - The oldest record is written over when the ring is full */
+#endif
 
 /* C Standard library */
 #include <stdbool.h>
 #include <stdint.h>
 
-/* Enums */
+/* Enums and structs */
+#include "../Open_SAE_J1939/Structs.h"
 #include "../SAE_J1939/SAE_J1939_Enums/Enum_DM14_DM15.h"
 #include "../SAE_J1939/SAE_J1939_Enums/Enum_Send_Status.h"
+#include "../SAE_J1939/SAE_J1939_Enums/Enum_Trace_Event.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -32,10 +76,95 @@ extern "C" {
 ENUM_J1939_STATUS_CODES CAN_Send_Message(uint32_t ID, uint8_t data[]);
 ENUM_J1939_STATUS_CODES CAN_Send_Request(uint32_t ID, uint8_t PGN[]);
 bool CAN_Read_Message(uint32_t *ID, uint8_t data[]);
+bool CAN_Read_Message_Time_Stamp(uint32_t *ID, uint8_t data[], uint32_t *time_stamp);
 void CAN_Set_Callback_Functions(void (*Callback_Function_Send_)(uint32_t, uint8_t, uint8_t[]), void (*Callback_Function_Read_)(uint32_t*, uint8_t[], bool*));
-void FLASH_EEPROM_RAM_Memory(uint16_t *number_of_requested_bytes, uint8_t pointer_type, uint8_t *command, uint32_t *pointer, uint8_t *pointer_extension, uint16_t *key, uint8_t raw_binary_data[]);
+
+/* CAN FD frames with up to 64 bytes - SAE J1939-22. Sending needs CAN_FD 1 */
+uint8_t CAN_Get_FD_Length(uint8_t length);
+ENUM_J1939_STATUS_CODES CAN_Send_Message_FD(uint32_t ID, uint8_t data[], uint8_t length);
+bool CAN_Read_Message_FD(uint32_t *ID, uint8_t data[], uint8_t *length, uint32_t *time_stamp);
+void CAN_Set_Read_FD_Callback_Function(void (*Callback_Function_Read_FD_)(uint32_t*, uint8_t[], uint8_t*, bool*));
+
 bool Save_Struct(uint8_t data[], uint32_t data_length, char file_name[]);
 bool Load_Struct(uint8_t data[], uint32_t data_length, char file_name[]);
+bool Load_Struct_Partial(uint8_t data[], uint32_t max_length, uint32_t *data_length, char file_name[]);
+bool Append_Struct(uint8_t data[], uint32_t data_length, char file_name[]);
+
+/* Information about this ECU in two slots with field updates */
+bool Save_Information_This_ECU(J1939 *j1939);
+bool Load_Information_This_ECU(J1939 *j1939);
+
+/* Saves that are done by a storage worker, so the receive path never waits for the storage. Without the storage task, Open_SAE_J1939_Listen_For_Messages calls Save_Information_This_ECU_Process before it reads a frame */
+void Save_Information_This_ECU_Request(J1939 *j1939);
+void Save_Information_This_ECU_Set_Callback(J1939 *j1939, Information_Save_Callback callback, void *context);
+bool Save_Information_This_ECU_Process(J1939 *j1939);
+bool Save_Information_This_ECU_Has_Task(void);
+
+/* Memory backends for the DM14 memory regions - The file backend is only on the PC */
+bool FLASH_EEPROM_RAM_Memory_Read_RAM(void *context, uint32_t offset, uint8_t data[], uint16_t length);
+bool FLASH_EEPROM_RAM_Memory_Write_RAM(void *context, uint32_t offset, const uint8_t data[], uint16_t length);
+bool FLASH_EEPROM_RAM_Memory_Erase_RAM(void *context, uint32_t offset, uint32_t length);
+bool FLASH_EEPROM_RAM_Memory_Read_File(void *context, uint32_t offset, uint8_t data[], uint16_t length);
+bool FLASH_EEPROM_RAM_Memory_Write_File(void *context, uint32_t offset, const uint8_t data[], uint16_t length);
+bool FLASH_EEPROM_RAM_Memory_Erase_File(void *context, uint32_t offset, uint32_t length);
+
+/* FreeRTOS task model - Only with PROCESSOR_CHOICE PIC */
+bool CAN_Start_Transmit_Task(void);
+bool Save_Information_This_ECU_Start_Task(J1939 *j1939);
+
+/* Bus load - How the stuff bits are counted */
+#define CAN_BUS_LOAD_STUFFING_WORST_CASE 0
+#define CAN_BUS_LOAD_STUFFING_EXACT 1
+uint8_t CAN_Bus_Load_Get_Frame_Bits(uint32_t ID, uint8_t DLC, const uint8_t data[]);
+void CAN_Bus_Load_Set_Bit_Rate(uint32_t bit_rate, uint8_t stuffing);
+void CAN_Bus_Load_Add_Frame(uint32_t ID, uint8_t DLC, const uint8_t data[]);
+void CAN_Bus_Load_Set_Data_Bit_Rate(uint32_t data_bit_rate);
+uint16_t CAN_Bus_Load_Get_FD_Frame_Bits(uint32_t ID, uint8_t length);
+void CAN_Bus_Load_Add_FD_Frame(uint32_t ID, uint8_t length);
+uint16_t CAN_Bus_Load_Get(void);
+uint16_t CAN_Bus_Load_Get_PGN(uint32_t PGN, uint8_t SA);
+bool CAN_Bus_Load_Get_Entry(uint8_t index, uint32_t *PGN, uint8_t *SA, uint16_t *load);
+void CAN_Bus_Load_Reset(void);
+
+/* Trace of protocol events - The records are dumped as bytes with Trace_Memory_Read, so it can also be the read callback of a DM14 memory region */
+#if OPEN_SAE_J1939_TRACE
+#define TRACE_EVENT(event, PGN, SA, DA, argument) Trace_Add(event, PGN, SA, DA, argument)
+#define TRACE_FRAME_EVENT(event, ID, argument) Trace_Add_Frame(event, ID, argument)
+#else
+#define TRACE_EVENT(event, PGN, SA, DA, argument) ((void)0)
+#define TRACE_FRAME_EVENT(event, ID, argument) ((void)0)
+#endif
+#define TRACE_RECORD_SIZE 12
+void Trace_Add(uint8_t event, uint32_t PGN, uint8_t SA, uint8_t DA, uint8_t argument);
+void Trace_Add_Frame(uint8_t event, uint32_t ID, uint8_t argument);
+uint32_t Trace_Get_Size(void);
+bool Trace_Memory_Read(void *context, uint32_t offset, uint8_t data[], uint16_t length);
+bool Trace_Save(char file_name[]);
+void Trace_Clear(void);
+
+/* Monotonic clock */
+uint32_t Clock_Get_Milliseconds(void);
+void Clock_Set_Callback_Function(uint32_t (*Callback_Function_Clock_)(void));
+uint32_t Clock_Get_Microseconds(void);
+void Clock_Set_Microseconds_Callback_Function(uint32_t (*Callback_Function_Clock_Microseconds_)(void));
+
+/* Trace replay - Only with PROCESSOR_CHOICE INTERNAL_CALLBACK */
+bool CAN_Replay_Open(char replay_file_name[], char capture_file_name[], bool real_time);
+void CAN_Replay_Close(void);
+bool CAN_Replay_Is_Finished(void);
+void CAN_Replay_Get_Statistics(uint32_t *frames_injected, uint32_t *frames_captured);
+
+/* Simulated network with many ECUs in one process - Only with PROCESSOR_CHOICE INTERNAL_CALLBACK */
+bool CAN_Network_Open(uint16_t number_of_nodes, uint32_t latency, float loss, uint32_t seed);
+void CAN_Network_Close(void);
+J1939 *CAN_Network_Get_Node(uint16_t node);
+J1939 *CAN_Network_Enter_Node(uint16_t node);
+void CAN_Network_Leave_Node(void);
+void CAN_Network_Send(uint32_t ID, uint8_t DLC, const uint8_t data[]);
+void CAN_Network_Run(uint32_t milliseconds);
+bool CAN_Network_Start_Threads(void);
+void CAN_Network_Stop_Threads(void);
+void CAN_Network_Get_Statistics(uint32_t *frames_sent, uint32_t *frames_delivered, uint32_t *frames_lost, uint32_t *frames_overrun);
 
 #ifdef __cplusplus
 }
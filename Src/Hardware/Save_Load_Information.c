@@ -0,0 +1,267 @@
+/*
+ * Save_Load_Information.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Hardware.h"
+
+/* C standard library */
+#include <string.h>
+
+/* The storage worker runs in its own task on the PIC port */
+#if PROCESSOR_CHOICE == PIC
+#include "FreeRTOS.h"
+#include "task.h"
+#define INFORMATION_SAVE_LOCK() taskENTER_CRITICAL()
+#define INFORMATION_SAVE_UNLOCK() taskEXIT_CRITICAL()
+static TaskHandle_t information_save_task = NULL;
+#else
+#define INFORMATION_SAVE_LOCK()
+#define INFORMATION_SAVE_UNLOCK()
+#endif
+
+/*
+ * The information about this ECU is kept in two slots, INFORMATION_THIS_ECU_SLOT_A and INFORMATION_THIS_ECU_SLOT_B.
+ * A slot is a header, the whole Information_this_ECU and then field updates that are appended one save at the time.
+ * A complete write always goes to the slot that is not in use, so a power cut in the middle of a write leaves the other slot as it was.
+ * A field update that is cut in half fails its CRC and is ignored together with everything after it.
+ */
+#define INFORMATION_MAGIC 0x4A393339                            /* "J939" */
+#define INFORMATION_VERSION 1                                   /* Count up when Information_this_ECU changes layout - Older slots are then ignored */
+#define INFORMATION_HEADER_SIZE 16                              /* Magic, version, length, sequence, CRC of the information and CRC of the header */
+#define INFORMATION_RECORD_SIZE 5                               /* Offset, length and CRC of a field update - The changed bytes follow the length */
+#define INFORMATION_RECORD_MAX_LENGTH 255
+#define INFORMATION_SLOT_SIZE (INFORMATION_HEADER_SIZE + sizeof(Information_this_ECU) + INFORMATION_THIS_ECU_JOURNAL_SIZE)
+
+static char *slot_file_names[2] = { INFORMATION_THIS_ECU_SLOT_A, INFORMATION_THIS_ECU_SLOT_B };
+static uint8_t slot_data[INFORMATION_SLOT_SIZE];                /* Too large for the stack of a small ECU */
+
+/* CRC-16/CCITT */
+static uint16_t Calculate_CRC(const uint8_t data[], uint32_t length) {
+    uint16_t crc = 0xFFFF;
+    for (uint32_t i = 0; i < length; i++) {
+        crc ^= data[i] << 8;
+        for (uint8_t j = 0; j < 8; j++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+static void Write_Little_Endian(uint8_t data[], uint32_t value, uint8_t length) {
+    for (uint8_t i = 0; i < length; i++)
+        data[i] = value >> (8 * i);
+}
+
+static uint32_t Read_Little_Endian(const uint8_t data[], uint8_t length) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < length; i++)
+        value |= (uint32_t)data[i] << (8 * i);
+    return value;
+}
+
+/* Check that slot_data holds a header and an information with correct CRC that has the same layout as this firmware */
+static bool Check_Slot(uint32_t slot_length) {
+    if (slot_length < INFORMATION_HEADER_SIZE + sizeof(Information_this_ECU))
+        return false;
+    if (Read_Little_Endian(slot_data + 14, 2) != Calculate_CRC(slot_data, 14))
+        return false;
+    if (Read_Little_Endian(slot_data, 4) != INFORMATION_MAGIC || Read_Little_Endian(slot_data + 4, 2) != INFORMATION_VERSION || Read_Little_Endian(slot_data + 6, 2) != sizeof(Information_this_ECU))
+        return false;
+    return Read_Little_Endian(slot_data + 12, 2) == Calculate_CRC(slot_data + INFORMATION_HEADER_SIZE, sizeof(Information_this_ECU));
+}
+
+/* Apply the field updates to information. Returns how many bytes of valid field updates there were */
+static uint32_t Apply_Journal(Information_this_ECU *information, const uint8_t journal[], uint32_t journal_length) {
+    uint32_t position = 0;
+    while (journal_length - position >= INFORMATION_RECORD_SIZE) {
+        uint32_t offset = Read_Little_Endian(journal + position, 2);
+        uint32_t length = journal[position + 2];
+        if (length == 0 || journal_length - position < INFORMATION_RECORD_SIZE + length || offset + length > sizeof(Information_this_ECU))
+            break;
+        if (Read_Little_Endian(journal + position + 3 + length, 2) != Calculate_CRC(journal + position, 3 + length))
+            break;                                              /* Cut in half by a power cut */
+        memcpy((uint8_t*)information + offset, journal + position + 3, length);
+        position += INFORMATION_RECORD_SIZE + length;
+    }
+    return position;
+}
+
+/* Find the valid slot with the highest sequence and apply its field updates to saved */
+static void Find_Newest_Slot(struct Information_storage *storage) {
+    storage->is_valid = false;
+    uint32_t slot_length = 0;
+    for (uint8_t slot = 0; slot < 2; slot++) {
+        if (!Load_Struct_Partial(slot_data, INFORMATION_SLOT_SIZE, &slot_length, slot_file_names[slot]) || !Check_Slot(slot_length))
+            continue;
+        uint32_t sequence = Read_Little_Endian(slot_data + 8, 4);
+        if (!storage->is_valid || (int32_t)(sequence - storage->sequence) > 0) {
+            storage->is_valid = true;
+            storage->slot = slot;
+            storage->sequence = sequence;
+        }
+    }
+    if (!storage->is_valid)
+        return;
+
+    /* slot_data holds the last slot that was read */
+    if (storage->slot == 0 && (!Load_Struct_Partial(slot_data, INFORMATION_SLOT_SIZE, &slot_length, slot_file_names[0]) || !Check_Slot(slot_length))) {
+        storage->is_valid = false;
+        return;
+    }
+    memcpy(&storage->saved, slot_data + INFORMATION_HEADER_SIZE, sizeof(Information_this_ECU));
+    uint32_t journal_length = slot_length - INFORMATION_HEADER_SIZE - sizeof(Information_this_ECU);
+    uint32_t valid_length = Apply_Journal(&storage->saved, slot_data + INFORMATION_HEADER_SIZE + sizeof(Information_this_ECU), journal_length);
+
+    /* New field updates would end up after the broken one and never be read - Write everything at the next save */
+    storage->journal_length = valid_length == journal_length ? valid_length : INFORMATION_THIS_ECU_JOURNAL_SIZE;
+}
+
+/* Write the whole information to the slot that is not in use */
+static bool Write_Slot(struct Information_storage *storage, const Information_this_ECU *information) {
+    uint8_t slot = storage->is_valid ? storage->slot ^ 1 : 0;
+    uint32_t sequence = storage->is_valid ? storage->sequence + 1 : 1;
+    Write_Little_Endian(slot_data, INFORMATION_MAGIC, 4);
+    Write_Little_Endian(slot_data + 4, INFORMATION_VERSION, 2);
+    Write_Little_Endian(slot_data + 6, sizeof(Information_this_ECU), 2);
+    Write_Little_Endian(slot_data + 8, sequence, 4);
+    Write_Little_Endian(slot_data + 12, Calculate_CRC((const uint8_t*)information, sizeof(Information_this_ECU)), 2);
+    Write_Little_Endian(slot_data + 14, Calculate_CRC(slot_data, 14), 2);
+    memcpy(slot_data + INFORMATION_HEADER_SIZE, information, sizeof(Information_this_ECU));
+    if (!Save_Struct(slot_data, INFORMATION_HEADER_SIZE + sizeof(Information_this_ECU), slot_file_names[slot]))
+        return false;                                           /* The slot in use is still valid */
+    memcpy(&storage->saved, information, sizeof(Information_this_ECU));
+    storage->is_valid = true;
+    storage->slot = slot;
+    storage->sequence = sequence;
+    storage->journal_length = 0;
+    return true;
+}
+
+/* Only the changed bytes are appended to the slot in use until its field updates are full */
+static bool Save_Information(struct Information_storage *storage, const Information_this_ECU *information_this_ECU) {
+    if (!storage->is_valid)
+        Find_Newest_Slot(storage);
+    if (!storage->is_valid)
+        return Write_Slot(storage, information_this_ECU);
+
+    /* Collect the changed bytes as field updates. Changes that are close to each other share one field update */
+    const uint8_t *saved = (const uint8_t*)&storage->saved;
+    const uint8_t *information = (const uint8_t*)information_this_ECU;
+    uint32_t journal_length = 0;
+    uint32_t i = 0;
+    while (i < sizeof(Information_this_ECU)) {
+        if (saved[i] == information[i]) {
+            i++;
+            continue;
+        }
+        uint32_t last = i;
+        for (uint32_t j = i + 1; j < sizeof(Information_this_ECU) && j - i < INFORMATION_RECORD_MAX_LENGTH && j - last <= INFORMATION_RECORD_SIZE; j++)
+            if (saved[j] != information[j])
+                last = j;
+        uint32_t length = last - i + 1;
+        if (storage->journal_length + journal_length + INFORMATION_RECORD_SIZE + length > INFORMATION_THIS_ECU_JOURNAL_SIZE)
+            return Write_Slot(storage, information_this_ECU);   /* The field updates are full */
+        uint8_t *record = slot_data + journal_length;
+        Write_Little_Endian(record, i, 2);
+        record[2] = length;
+        memcpy(record + 3, information + i, length);
+        Write_Little_Endian(record + 3 + length, Calculate_CRC(record, 3 + length), 2);
+        journal_length += INFORMATION_RECORD_SIZE + length;
+        i = last + 1;
+    }
+    if (journal_length == 0)
+        return true;                                            /* Nothing has changed */
+    if (!Append_Struct(slot_data, journal_length, slot_file_names[storage->slot]))
+        return Write_Slot(storage, information_this_ECU);       /* A half written field update is ignored at load */
+    memcpy(&storage->saved, information_this_ECU, sizeof(Information_this_ECU));
+    storage->journal_length += journal_length;
+    return true;
+}
+
+/* Save the information about this ECU now. Use Save_Information_This_ECU_Request from the receive path */
+bool Save_Information_This_ECU(J1939 *j1939) {
+    return Save_Information(&j1939->this_information_storage, &j1939->information_this_ECU);
+}
+
+/* Load the information about this ECU from the newest valid slot. A file from Save_Struct with the name INFORMATION_THIS_ECU is read if there are no slots */
+bool Load_Information_This_ECU(J1939 *j1939) {
+    struct Information_storage *storage = &j1939->this_information_storage;
+    Find_Newest_Slot(storage);
+    if (storage->is_valid) {
+        memcpy(&j1939->information_this_ECU, &storage->saved, sizeof(Information_this_ECU));
+        return true;
+    }
+    if (!Load_Struct((uint8_t*)&storage->saved, sizeof(Information_this_ECU), INFORMATION_THIS_ECU))
+        return false;
+    memcpy(&j1939->information_this_ECU, &storage->saved, sizeof(Information_this_ECU));
+    return true;                                                /* Written to slot A at the next save */
+}
+
+/* Copy the information about this ECU and let the storage worker save it. A request that is not saved yet is replaced by the new one */
+void Save_Information_This_ECU_Request(J1939 *j1939) {
+    struct Information_storage *storage = &j1939->this_information_storage;
+    INFORMATION_SAVE_LOCK();
+    memcpy(&storage->pending, &j1939->information_this_ECU, sizeof(Information_this_ECU));
+    storage->is_pending = true;
+    INFORMATION_SAVE_UNLOCK();
+#if PROCESSOR_CHOICE == PIC
+    if (information_save_task != NULL)
+        xTaskNotifyGive(information_save_task);
+#endif
+}
+
+/* The callback is called by the storage worker after every save that Save_Information_This_ECU_Request asked for */
+void Save_Information_This_ECU_Set_Callback(J1939 *j1939, Information_Save_Callback callback, void *context) {
+    INFORMATION_SAVE_LOCK();
+    j1939->this_information_storage.callback = callback;
+    j1939->this_information_storage.callback_context = context;
+    INFORMATION_SAVE_UNLOCK();
+}
+
+/* The storage worker. Saves the latest requested copy. Returns true if something was saved, or tried to be saved */
+bool Save_Information_This_ECU_Process(J1939 *j1939) {
+    static Information_this_ECU information;            /* Only one worker saves at the time */
+    struct Information_storage *storage = &j1939->this_information_storage;
+    INFORMATION_SAVE_LOCK();
+    bool is_pending = storage->is_pending;
+    if (is_pending)
+        memcpy(&information, &storage->pending, sizeof(Information_this_ECU));
+    storage->is_pending = false;
+    Information_Save_Callback callback = storage->callback;
+    void *context = storage->callback_context;
+    INFORMATION_SAVE_UNLOCK();
+    if (!is_pending)
+        return false;
+    bool is_saved = Save_Information(storage, &information);
+    if (callback != NULL)
+        callback(is_saved, context);
+    return true;
+}
+
+/* True if the storage task saves the requests. Else Open_SAE_J1939_Listen_For_Messages calls Save_Information_This_ECU_Process */
+bool Save_Information_This_ECU_Has_Task(void) {
+#if PROCESSOR_CHOICE == PIC
+    return information_save_task != NULL;
+#else
+    return false;
+#endif
+}
+
+#if PROCESSOR_CHOICE == PIC
+static void Save_Information_This_ECU_Task(void *parameter) {
+    J1939 *j1939 = (J1939 *) parameter;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (Save_Information_This_ECU_Process(j1939));    /* Requests that came during the save */
+    }
+}
+
+/* Start the storage worker. Open_SAE_J1939_Start_Tasks does this */
+bool Save_Information_This_ECU_Start_Task(J1939 *j1939) {
+    if (information_save_task != NULL)
+        return true;
+    return xTaskCreate(Save_Information_This_ECU_Task, "J1939 Save", INFORMATION_SAVE_TASK_STACK_SIZE, j1939, INFORMATION_SAVE_TASK_PRIORITY, &information_save_task) == pdPASS;
+}
+#endif
@@ -10,58 +10,119 @@
 /* Layers */
 #include <stdio.h>
 
+/* Create the file or replace what it holds */
 bool Save_Struct(uint8_t data[], uint32_t data_length, char file_name[]) {
 #if PROCESSOR_CHOICE == STM32
     /* Save it to SD card */
     if (STM32_PLC_SD_Mont_Card() != FR_OK)
         return false;
-    STM32_PLC_SD_Create_File_With_Write(file_name);
-    STM32_PLC_SD_Write_Data(data, data_length);
-    STM32_PLC_SD_Close_File();
+    bool is_written = STM32_PLC_SD_Create_File_With_Write(file_name) == FR_OK;
+    if (is_written) {
+        is_written = STM32_PLC_SD_Write_Data(data, data_length) == FR_OK;
+        is_written = STM32_PLC_SD_Close_File() == FR_OK && is_written;
+    }
     STM32_PLC_SD_Unmount_Card();
-    return true;
+    return is_written;
 #elif PROCESSOR_CHOICE == ARDUINO
     /* Implement your memory handler function for the Arduino platform */
 #elif PROCESSOR_CHOICE == PIC
-    return true;
+    return false;                                   /* Nothing is stored yet, so the caller must not think it's saved */
     /* Implement your memory handler function for the PIC platform */
 #elif PROCESSOR_CHOICE == AVR
     /* Implement your memory handler function for the AVR platform */
 #else
     /* Write a file */
-    FILE *file;
-    file = fopen(file_name, "wb");
-    fwrite(data, 1, data_length, file);
-    fclose(file);
-    return true;
+    FILE *file = fopen(file_name, "wb");
+    if (file == NULL)
+        return false;
+    bool is_written = fwrite(data, 1, data_length, file) == data_length;
+    return fclose(file) == 0 && is_written;
 #endif
 }
 
+/* Returns false if the file is missing or holds less than data_length bytes */
 bool Load_Struct(uint8_t data[], uint32_t data_length, char file_name[]) {
+#if PROCESSOR_CHOICE == STM32
+    /* Load it from SD card */
+    uint32_t read_length = 0;
+    return Load_Struct_Partial(data, data_length, &read_length, file_name) && read_length == data_length;
+#elif PROCESSOR_CHOICE == ARDUINO
+    /* Implement your memory handler function for the Arduino platform */
+#elif PROCESSOR_CHOICE == PIC
+    return false;                                   /* Nothing has been stored, so the default values are kept */
+    /* Implement your memory handler function for the PIC platform */
+#elif PROCESSOR_CHOICE == AVR
+    /* Implement your memory handler function for the AVR platform */
+#else
+    /* Read a file */
+    FILE *file = fopen(file_name, "rb");
+    if (file == NULL)
+        return false;
+    bool is_read = fread(data, 1, data_length, file) == data_length;
+    fclose(file);
+    return is_read;
+#endif
+}
+
+/* Read at most max_length bytes. data_length tells how many bytes the file had. Returns false if the file is missing or cannot be read */
+bool Load_Struct_Partial(uint8_t data[], uint32_t max_length, uint32_t *data_length, char file_name[]) {
+    *data_length = 0;
 #if PROCESSOR_CHOICE == STM32
     /* Load it from SD card */
     if (STM32_PLC_SD_Mont_Card() != FR_OK)
         return false;
-    STM32_PLC_SD_Open_File_With_Read(file_name);
-    STM32_PLC_SD_Read_Data(data, data_length);
-    STM32_PLC_SD_Close_File();
+    bool is_read = STM32_PLC_SD_Open_File_With_Read(file_name) == FR_OK;
+    if (is_read) {
+        is_read = STM32_PLC_SD_Read_Data_Length(data, max_length, data_length) == FR_OK;
+        STM32_PLC_SD_Close_File();
+    }
     STM32_PLC_SD_Unmount_Card();
-    return true;
+    return is_read;
 #elif PROCESSOR_CHOICE == ARDUINO
     /* Implement your memory handler function for the Arduino platform */
 #elif PROCESSOR_CHOICE == PIC
-    return true;
+    return false;
     /* Implement your memory handler function for the PIC platform */
 #elif PROCESSOR_CHOICE == AVR
     /* Implement your memory handler function for the AVR platform */
 #else
     /* Read a file */
-    FILE *file;
-    file = fopen(file_name, "rb");
+    FILE *file = fopen(file_name, "rb");
     if (file == NULL)
-        file = fopen(file_name, "wb");
-    fread(data, 1, data_length, file);
+        return false;
+    *data_length = fread(data, 1, max_length, file);
+    bool is_read = !ferror(file);
     fclose(file);
-    return true;
+    return is_read;
+#endif
+}
+
+/* Add data at the end of the file. The file is created if it's missing */
+bool Append_Struct(uint8_t data[], uint32_t data_length, char file_name[]) {
+#if PROCESSOR_CHOICE == STM32
+    /* Append it to SD card */
+    if (STM32_PLC_SD_Mont_Card() != FR_OK)
+        return false;
+    bool is_written = STM32_PLC_SD_Open_File_With_Append(file_name) == FR_OK;
+    if (is_written) {
+        is_written = STM32_PLC_SD_Write_Data(data, data_length) == FR_OK;
+        is_written = STM32_PLC_SD_Close_File() == FR_OK && is_written;
+    }
+    STM32_PLC_SD_Unmount_Card();
+    return is_written;
+#elif PROCESSOR_CHOICE == ARDUINO
+    /* Implement your memory handler function for the Arduino platform */
+#elif PROCESSOR_CHOICE == PIC
+    return false;                                   /* Nothing is stored yet, so the caller must not think it's saved */
+    /* Implement your memory handler function for the PIC platform */
+#elif PROCESSOR_CHOICE == AVR
+    /* Implement your memory handler function for the AVR platform */
+#else
+    /* Append to a file */
+    FILE *file = fopen(file_name, "ab");
+    if (file == NULL)
+        return false;
+    bool is_written = fwrite(data, 1, data_length, file) == data_length;
+    return fclose(file) == 0 && is_written;
 #endif
 }
@@ -0,0 +1,161 @@
+/*
+ * Trace.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Hardware.h"
+
+/* C standard library */
+#include <stddef.h>
+#include <string.h>
+
+/* Events are traced from several tasks on the PIC port */
+#if PROCESSOR_CHOICE == PIC
+#include "FreeRTOS.h"
+#include "task.h"
+#define TRACE_LOCK() taskENTER_CRITICAL()
+#define TRACE_UNLOCK() taskEXIT_CRITICAL()
+#else
+#define TRACE_LOCK()
+#define TRACE_UNLOCK()
+#endif
+
+/* How many records are encoded at the time when the ring is saved */
+#define TRACE_SAVE_RECORDS 16
+
+#if OPEN_SAE_J1939_TRACE
+/* One protocol event. It's encoded to TRACE_RECORD_SIZE bytes only when the ring is dumped, so adding a record is only a few stores */
+struct Trace_record {
+    uint32_t time_stamp;                                        /* When the event happened in microseconds of Clock_Get_Microseconds */
+    uint32_t PGN;
+    uint8_t event;                                              /* ENUM_TRACE_EVENT_CODES */
+    uint8_t SA;
+    uint8_t DA;
+    uint8_t argument;                                           /* Depends on the event */
+};
+
+/* Internal fields */
+static struct Trace_record trace_ring[TRACE_RING_SIZE];
+static uint32_t trace_number_of_records = 0;                    /* Every record that has been added - The next record goes to trace_number_of_records % TRACE_RING_SIZE */
+
+/* Internal functions */
+static uint32_t Get_Number_Of_Records(void) {
+    return trace_number_of_records < TRACE_RING_SIZE ? trace_number_of_records : TRACE_RING_SIZE;
+}
+
+/* Little endian - time stamp, PGN, event, SA, DA and argument. index 0 is the oldest record in the ring */
+static void Encode_Record(uint32_t index, uint8_t data[]) {
+    uint32_t first = trace_number_of_records - Get_Number_Of_Records();
+    const struct Trace_record *record = &trace_ring[(first + index) % TRACE_RING_SIZE];
+    for (uint8_t i = 0; i < 4; i++) {
+        data[i] = record->time_stamp >> (8 * i);
+        data[4 + i] = record->PGN >> (8 * i);
+    }
+    data[8] = record->event;
+    data[9] = record->SA;
+    data[10] = record->DA;
+    data[11] = record->argument;
+}
+#endif
+
+/* Add a record to the ring. Use the TRACE_EVENT macro, so the call is removed when OPEN_SAE_J1939_TRACE is 0 */
+void Trace_Add(uint8_t event, uint32_t PGN, uint8_t SA, uint8_t DA, uint8_t argument) {
+    #if OPEN_SAE_J1939_TRACE
+    uint32_t time_stamp = Clock_Get_Microseconds();
+    TRACE_LOCK();
+    struct Trace_record *record = &trace_ring[trace_number_of_records++ % TRACE_RING_SIZE];
+    record->time_stamp = time_stamp;
+    record->PGN = PGN;
+    record->event = event;
+    record->SA = SA;
+    record->DA = DA;
+    record->argument = argument;
+    TRACE_UNLOCK();
+    #else
+    (void)event;
+    (void)PGN;
+    (void)SA;
+    (void)DA;
+    (void)argument;
+    #endif
+}
+
+/* Same as Trace_Add, but PGN, SA and DA are taken from the CAN bus ID. The decoding is only done when the trace is on */
+void Trace_Add_Frame(uint8_t event, uint32_t ID, uint8_t argument) {
+    #if OPEN_SAE_J1939_TRACE
+    uint32_t PGN = (ID >> 8) & 0x3FFFF;
+    uint8_t DA = 0xFF;
+    if (((ID >> 16) & 0xFF) < 0xF0) {
+        DA = PGN;                                               /* PDU1 - The lowest byte is the destination address */
+        PGN &= 0x3FF00;
+    }
+    Trace_Add(event, PGN, ID, DA, argument);
+    #else
+    (void)event;
+    (void)ID;
+    (void)argument;
+    #endif
+}
+
+/* How many bytes of records the ring has right now */
+uint32_t Trace_Get_Size(void) {
+    #if OPEN_SAE_J1939_TRACE
+    return Get_Number_Of_Records() * TRACE_RECORD_SIZE;
+    #else
+    return 0;
+    #endif
+}
+
+/*
+ * Read the records as bytes, the oldest first. offset is counted in bytes from the oldest record. Returns false if the ring has fewer bytes.
+ * It has the same form as Memory_Read_Callback, so the ring can be dumped over DM14. context is not used
+ */
+bool Trace_Memory_Read(void *context, uint32_t offset, uint8_t data[], uint16_t length) {
+    (void)context;
+    #if OPEN_SAE_J1939_TRACE
+    bool is_read = false;
+    TRACE_LOCK();
+    if (offset + length <= Get_Number_Of_Records() * TRACE_RECORD_SIZE) {
+        uint8_t record[TRACE_RECORD_SIZE];
+        for (uint16_t i = 0; i < length; i++) {
+            uint32_t position = offset + i;
+            if (i == 0 || position % TRACE_RECORD_SIZE == 0)
+                Encode_Record(position / TRACE_RECORD_SIZE, record);
+            data[i] = record[position % TRACE_RECORD_SIZE];
+        }
+        is_read = true;
+    }
+    TRACE_UNLOCK();
+    return is_read;
+    #else
+    (void)offset;
+    (void)data;
+    (void)length;
+    return false;
+    #endif
+}
+
+/* Save the records to a file, the oldest first. The file has the same form as Trace_Memory_Read gives */
+bool Trace_Save(char file_name[]) {
+    uint8_t data[TRACE_SAVE_RECORDS * TRACE_RECORD_SIZE];
+    uint32_t size = Trace_Get_Size();
+    if (!Save_Struct(data, 0, file_name))
+        return false;
+    for (uint32_t offset = 0; offset < size; offset += sizeof(data)) {
+        uint16_t length = size - offset < sizeof(data) ? size - offset : sizeof(data);
+        if (!Trace_Memory_Read(NULL, offset, data, length) || !Append_Struct(data, length, file_name))
+            return false;
+    }
+    return true;
+}
+
+/* Forget every record */
+void Trace_Clear(void) {
+    #if OPEN_SAE_J1939_TRACE
+    TRACE_LOCK();
+    trace_number_of_records = 0;
+    TRACE_UNLOCK();
+    #endif
+}
@@ -41,6 +41,15 @@ ENUM_J1939_STATUS_CODES ISO_11783_Send_Request_General_Purpose_Valve_Estimated_F
 ENUM_J1939_STATUS_CODES ISO_11783_Response_Request_General_Purpose_Valve_Estimated_Flow(J1939 *j1939, uint8_t DA);
 void ISO_11783_Read_Response_Request_General_Purpose_Valve_Estimated_Flow(J1939 *j1939, uint8_t SA, uint8_t data[]);
 
+/* Valve Bank */
+bool ISO_11783_Valve_Bank_Set_Auxiliary_Valve_Command(J1939 *j1939, uint8_t valve_number, uint8_t standard_flow, uint8_t fail_safe_mode, uint8_t valve_state);
+void ISO_11783_Valve_Bank_Set_General_Purpose_Valve_Command(J1939 *j1939, uint8_t DA, uint8_t standard_flow, uint8_t fail_safe_mode, uint8_t valve_state, uint16_t extended_flow);
+void ISO_11783_Valve_Bank_Stop_Command(J1939 *j1939, uint8_t valve_number);
+void ISO_11783_Valve_Bank_Set_Callback(J1939 *j1939, ISO_11783_Fail_Safe_Callback callback, void *context);
+bool ISO_11783_Valve_Bank_Is_Feedback_Stale(J1939 *j1939, uint8_t valve_number);
+bool ISO_11783_Valve_Bank_Is_Fail_Safe(J1939 *j1939, uint8_t valve_number);
+void ISO_11783_Valve_Bank_Process(J1939 *j1939);
+
 #ifdef __cplusplus
 }
 #endif
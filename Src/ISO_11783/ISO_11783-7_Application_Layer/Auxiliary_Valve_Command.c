@@ -34,4 +34,8 @@ void ISO_11783_Read_Auxiliary_Valve_Command(J1939 *j1939, uint8_t SA, uint8_t va
 	j1939->from_other_ecu_auxiliary_valve_command[valve_number].fail_safe_mode = data[2] >> 6;
 	j1939->from_other_ecu_auxiliary_valve_command[valve_number].valve_state = data[2] & 0b00001111;
 	j1939->from_other_ecu_auxiliary_valve_command[valve_number].from_ecu_address = SA;
+
+	/* Feed the watchdog of the valve bank */
+	j1939->this_valve_bank.valves[valve_number].received_command_time_stamp = Clock_Get_Milliseconds();
+	j1939->this_valve_bank.valves[valve_number].is_watched = true;
 }
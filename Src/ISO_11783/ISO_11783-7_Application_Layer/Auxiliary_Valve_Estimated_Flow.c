@@ -45,5 +45,6 @@ void ISO_11783_Read_Response_Request_Auxiliary_Estimated_Flow(J1939 *j1939, uint
 	j1939->from_other_ecu_auxiliary_valve_estimated_flow[valve_number].valve_state = data[2] & 0b00001111;
 	j1939->from_other_ecu_auxiliary_valve_estimated_flow[valve_number].limit = data[3] >> 5;
 	j1939->from_other_ecu_auxiliary_valve_estimated_flow[valve_number].from_ecu_address = SA;
+	j1939->this_valve_bank.valves[valve_number].feedback_time_stamp = Clock_Get_Milliseconds();		/* The valve is alive */
 }
 
@@ -44,4 +44,5 @@ void ISO_11783_Read_Response_Request_Auxiliary_Valve_Measured_Position(J1939 *j1
 	j1939->from_other_ecu_auxiliary_valve_measured_position[valve_number].valve_state = 0b00001111 & data[2];
 	j1939->from_other_ecu_auxiliary_valve_measured_position[valve_number].measured_position_micrometer = (data[4] << 8) | data[3];
 	j1939->from_other_ecu_auxiliary_valve_measured_position[valve_number].from_ecu_address = SA;
+	j1939->this_valve_bank.valves[valve_number].feedback_time_stamp = Clock_Get_Milliseconds();		/* The valve is alive */
 }
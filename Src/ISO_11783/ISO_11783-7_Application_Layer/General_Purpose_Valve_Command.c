@@ -37,4 +37,8 @@ void ISO_11783_Read_General_Purpose_Valve_Command(J1939 *j1939, uint8_t SA, uint
 	j1939->from_other_ecu_general_purpose_valve_command.valve_state = data[2] & 0b00001111;
 	j1939->from_other_ecu_general_purpose_valve_command.extended_flow = (data[4] << 8) | data[3];
 	j1939->from_other_ecu_general_purpose_valve_command.from_ecu_address = SA;
+
+	/* Feed the watchdog of the valve bank */
+	j1939->this_valve_bank.valves[VALVE_BANK_GENERAL_PURPOSE_VALVE].received_command_time_stamp = Clock_Get_Milliseconds();
+	j1939->this_valve_bank.valves[VALVE_BANK_GENERAL_PURPOSE_VALVE].is_watched = true;
 }
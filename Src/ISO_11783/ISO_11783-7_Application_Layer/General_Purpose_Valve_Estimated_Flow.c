@@ -50,4 +50,5 @@ void ISO_11783_Read_Response_Request_General_Purpose_Valve_Estimated_Flow(J1939
 	j1939->from_other_ecu_general_purpose_valve_estimated_flow.extend_estimated_flow_extended = (data[5] << 8) | data[4];
 	j1939->from_other_ecu_general_purpose_valve_estimated_flow.retract_estimated_flow_extended = (data[7] << 8) | data[6];
 	j1939->from_other_ecu_general_purpose_valve_estimated_flow.from_ecu_address = SA;
+	j1939->this_valve_bank.valves[VALVE_BANK_GENERAL_PURPOSE_VALVE].feedback_time_stamp = Clock_Get_Milliseconds();	/* The valve is alive */
 }
@@ -0,0 +1,145 @@
+/*
+ * Valve_Bank.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Application_Layer.h"
+
+/* Layers */
+#include "../../Hardware/Hardware.h"
+
+/* C standard library */
+#include <stddef.h>
+
+/*
+ * The valve bank holds the commands of this ECU for the 16 auxiliary valves and the general purpose valve.
+ * ISO_11783_Valve_Bank_Process sends a command when it has changed or when VALVE_BANK_COMMAND_INTERVAL has passed, so the application only sets the commands.
+ * The same tick marks the feedback as stale and puts the valves of this ECU in fail safe when the commands to them stop.
+ */
+
+/* Internal functions */
+static bool Set_Command(J1939 *j1939, uint8_t valve_number, uint8_t standard_flow, uint8_t fail_safe_mode, uint8_t valve_state, uint16_t extended_flow) {
+	if(valve_number >= VALVE_BANK_NUMBER_OF_VALVES)
+		return false;
+	struct Valve_bank_valve *valve = &j1939->this_valve_bank.valves[valve_number];
+	if(!valve->is_commanded){
+		valve->is_commanded = true;
+		valve->is_dirty = true;
+		valve->feedback_time_stamp = Clock_Get_Milliseconds();		/* The valve gets the full time to answer the first command */
+		valve->is_feedback_stale = false;
+	}
+	valve->is_dirty |= valve->standard_flow != standard_flow || valve->fail_safe_mode != fail_safe_mode || valve->valve_state != valve_state || valve->extended_flow != extended_flow;
+	valve->standard_flow = standard_flow;
+	valve->fail_safe_mode = fail_safe_mode;
+	valve->valve_state = valve_state;
+	valve->extended_flow = extended_flow;
+	return true;
+}
+
+static ENUM_J1939_STATUS_CODES Send_Command(J1939 *j1939, uint8_t valve_number, struct Valve_bank_valve *valve) {
+	if(valve_number == VALVE_BANK_GENERAL_PURPOSE_VALVE)
+		return ISO_11783_Send_General_Purpose_Valve_Command(j1939, j1939->this_valve_bank.general_purpose_valve_address, valve->standard_flow, valve->fail_safe_mode, valve->valve_state, valve->extended_flow);
+	return ISO_11783_Send_Auxiliary_Valve_Command(j1939, valve_number, valve->standard_flow, valve->fail_safe_mode, valve->valve_state);
+}
+
+/*
+ * The received command is what the application drives the valve with, so the last command is replaced by one without flow.
+ * Fail safe mode blocked means that the valve goes to neutral and fail safe mode activated means that the valve goes to floating
+ */
+static void Enter_Fail_Safe(J1939 *j1939, uint8_t valve_number) {
+	if(valve_number == VALVE_BANK_GENERAL_PURPOSE_VALVE){
+		struct General_purpose_valve_command *command = &j1939->from_other_ecu_general_purpose_valve_command;
+		command->valve_state = command->fail_safe_mode == FAIL_SAFE_MODE_ACTIVATED ? VALVE_STATE_FLOATING : VALVE_STATE_NEUTRAL;
+		command->standard_flow = 0;
+		command->extended_flow = 0;
+	}else{
+		struct Auxiliary_valve_command *command = &j1939->from_other_ecu_auxiliary_valve_command[valve_number];
+		command->valve_state = command->fail_safe_mode == FAIL_SAFE_MODE_ACTIVATED ? VALVE_STATE_FLOATING : VALVE_STATE_NEUTRAL;
+		command->standard_flow = 0;
+	}
+	j1939->this_valve_bank.valves[valve_number].is_fail_safe = true;
+	if(j1939->this_valve_bank.callback != NULL)
+		j1939->this_valve_bank.callback(valve_number, true, j1939->this_valve_bank.callback_context);
+}
+
+/*
+ * Set the command of an auxiliary valve. The command is sent at the next tick if it has changed, else every VALVE_BANK_COMMAND_INTERVAL
+ * PGN: 0x00FE30 (65072) to 0x00FE3F (65087)
+ */
+bool ISO_11783_Valve_Bank_Set_Auxiliary_Valve_Command(J1939 *j1939, uint8_t valve_number, uint8_t standard_flow, uint8_t fail_safe_mode, uint8_t valve_state) {
+	return valve_number < 16 && Set_Command(j1939, valve_number, standard_flow, fail_safe_mode, valve_state, 0);
+}
+
+/*
+ * Set the command of the general purpose valve at the ECU DA
+ * PGN: 0x00C400 (50176)
+ */
+void ISO_11783_Valve_Bank_Set_General_Purpose_Valve_Command(J1939 *j1939, uint8_t DA, uint8_t standard_flow, uint8_t fail_safe_mode, uint8_t valve_state, uint16_t extended_flow) {
+	if(j1939->this_valve_bank.general_purpose_valve_address != DA)
+		j1939->this_valve_bank.valves[VALVE_BANK_GENERAL_PURPOSE_VALVE].is_dirty = true;
+	j1939->this_valve_bank.general_purpose_valve_address = DA;
+	Set_Command(j1939, VALVE_BANK_GENERAL_PURPOSE_VALVE, standard_flow, fail_safe_mode, valve_state, extended_flow);
+}
+
+/* Stop sending commands to the valve. The valve will go to its fail safe when it notices that the commands have stopped */
+void ISO_11783_Valve_Bank_Stop_Command(J1939 *j1939, uint8_t valve_number) {
+	if(valve_number < VALVE_BANK_NUMBER_OF_VALVES){
+		j1939->this_valve_bank.valves[valve_number].is_commanded = false;
+		j1939->this_valve_bank.valves[valve_number].is_dirty = false;
+	}
+}
+
+/* The callback is called from the tick when a valve of this ECU goes to fail safe or gets commands again. context is given back to the callback */
+void ISO_11783_Valve_Bank_Set_Callback(J1939 *j1939, ISO_11783_Fail_Safe_Callback callback, void *context) {
+	j1939->this_valve_bank.callback = callback;
+	j1939->this_valve_bank.callback_context = context;
+}
+
+/* True if a commanded valve has not sent estimated flow or measured position in VALVE_BANK_FEEDBACK_TIMEOUT */
+bool ISO_11783_Valve_Bank_Is_Feedback_Stale(J1939 *j1939, uint8_t valve_number) {
+	return valve_number < VALVE_BANK_NUMBER_OF_VALVES && j1939->this_valve_bank.valves[valve_number].is_feedback_stale;
+}
+
+/* True if the valve of this ECU is in fail safe because the commands to it have stopped */
+bool ISO_11783_Valve_Bank_Is_Fail_Safe(J1939 *j1939, uint8_t valve_number) {
+	return valve_number < VALVE_BANK_NUMBER_OF_VALVES && j1939->this_valve_bank.valves[valve_number].is_fail_safe;
+}
+
+/*
+ * Send the commands that have changed or are due in one burst, mark stale feedback and watch the commands that this ECU receives.
+ * This is called from Open_SAE_J1939_Listen_For_Messages, so it needs no own thread
+ */
+void ISO_11783_Valve_Bank_Process(J1939 *j1939) {
+	uint32_t now = Clock_Get_Milliseconds();
+	bool is_bus_full = false;
+	for(uint8_t i = 0; i < VALVE_BANK_NUMBER_OF_VALVES; i++){
+		struct Valve_bank_valve *valve = &j1939->this_valve_bank.valves[i];
+
+		/* Commands from this ECU - A command that could not be sent stays dirty until the next tick */
+		if(valve->is_commanded){
+			if(!is_bus_full && (valve->is_dirty || (uint32_t)(now - valve->command_time_stamp) >= VALVE_BANK_COMMAND_INTERVAL)){
+				if(Send_Command(j1939, i, valve) == STATUS_SEND_OK){
+					valve->is_dirty = false;
+					valve->command_time_stamp = now;
+				}else{
+					is_bus_full = true;
+				}
+			}
+			valve->is_feedback_stale = (uint32_t)(now - valve->feedback_time_stamp) >= VALVE_BANK_FEEDBACK_TIMEOUT;
+		}
+
+		/* Commands to this ECU */
+		if(valve->is_watched){
+			bool is_command_lost = (uint32_t)(now - valve->received_command_time_stamp) >= VALVE_BANK_COMMAND_TIMEOUT;
+			if(is_command_lost && !valve->is_fail_safe){
+				Enter_Fail_Safe(j1939, i);
+			}else if(!is_command_lost && valve->is_fail_safe){
+				valve->is_fail_safe = false;
+				if(j1939->this_valve_bank.callback != NULL)
+					j1939->this_valve_bank.callback(i, false, j1939->this_valve_bank.callback_context);
+			}
+		}
+	}
+}
@@ -0,0 +1,133 @@
+/*
+ * Bulk_Decoder.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Open_SAE_J1939.h"
+
+/* C standard library */
+#include <math.h>
+
+/*
+ * Decoding of recorded frames into columns, one table per PGN. This is for log analysis on a PC and does not touch any J1939 struct.
+ * Every step is a plain loop over arrays without calls or early exits, so the compiler can vectorize it with -O3.
+ * Only single frame PGNs are decoded - A Transport Protocol message is shown as its TP.CM and TP.DT frames.
+ */
+#define BULK_BLOCK_SIZE 256                                     /* Frames that are decoded together - The ID columns of a block are on the stack */
+
+/* Same byte order on every host. The compiler turns this into one load on a little endian machine */
+static uint64_t Load_Little_Endian_64(const uint8_t data[]) {
+    uint64_t value = 0;
+    for (uint8_t i = 0; i < 8; i++)
+        value |= (uint64_t)data[i] << (8 * i);
+    return value;
+}
+
+/* The raw values from here and above are error or not available. 0xFE00 and 0xFF00 for 16 bits, 0xE and 0xF for 4 bits and so on */
+static uint64_t Get_Not_Valid_Limit(uint8_t length) {
+    if (length == 1)
+        return 2;                                               /* Both values are valid */
+    if (length < 8)
+        return ((1ULL << length) - 1) - 1;
+    return 0xFEULL << (length - 8);
+}
+
+static void Extract_Signal(const uint8_t data[][8], const uint32_t frame_index[], uint32_t first_row, uint32_t last_row, const J1939_Bulk_Signal *signal) {
+    uint64_t mask = (1ULL << signal->length) - 1;
+    uint8_t start_bit = signal->start_bit;
+    if (signal->raw != NULL)
+        for (uint32_t i = first_row; i < last_row; i++)
+            signal->raw[i] = (Load_Little_Endian_64(data[frame_index[i]]) >> start_bit) & mask;
+    if (signal->values != NULL) {
+        uint64_t limit = Get_Not_Valid_Limit(signal->length);
+        float resolution = signal->resolution;
+        float offset = signal->offset;
+        for (uint32_t i = first_row; i < last_row; i++) {
+            uint64_t raw = (Load_Little_Endian_64(data[frame_index[i]]) >> start_bit) & mask;
+            signal->values[i] = raw >= limit ? NAN : (float)raw * resolution + offset;
+        }
+    }
+}
+
+/* Decode the IDs into the PGN, SA and DA columns. Same rules as Open_SAE_J1939_Decode_Frame */
+void Open_SAE_J1939_Bulk_Decode_ID(const uint32_t ID[], uint32_t number_of_frames, uint32_t PGN[], uint8_t SA[], uint8_t DA[]) {
+    for (uint32_t i = 0; i < number_of_frames; i++) {
+        bool is_PDU1 = ((ID[i] >> 16) & 0xFF) < 0xF0;           /* The lowest byte of the PGN is the destination address */
+        PGN[i] = (ID[i] >> 8) & (is_PDU1 ? 0x3FF00 : 0x3FFFF);
+        DA[i] = is_PDU1 ? (uint8_t)(ID[i] >> 8) : 0xFF;
+        SA[i] = ID[i];
+    }
+}
+
+/* A table must have the frame_index column and signals that fit inside 8 bytes */
+bool Open_SAE_J1939_Bulk_Check_Table(const J1939_Bulk_Table *table) {
+    if (table->frame_index == NULL || table->number_of_rows > table->capacity)
+        return false;
+    if (table->number_of_signals > 0 && table->signals == NULL)
+        return false;
+    for (uint8_t i = 0; i < table->number_of_signals; i++) {
+        const J1939_Bulk_Signal *signal = &table->signals[i];
+        if (signal->length == 0 || signal->length > 32 || signal->start_bit + signal->length > 64)
+            return false;
+    }
+    return true;
+}
+
+/*
+ * Add the frames to the tables with the same PGN. The rows are added after number_of_rows, so a large log can be decoded in parts.
+ * frame_index is counted from the first frame in this call. time_stamps can be NULL. Tables that fail Open_SAE_J1939_Bulk_Check_Table are not touched.
+ * Returns how many rows were added to all the tables
+ */
+uint32_t Open_SAE_J1939_Bulk_Decode(const uint64_t time_stamps[], const uint32_t ID[], const uint8_t data[][8], uint32_t number_of_frames, J1939_Bulk_Table tables[], uint8_t number_of_tables) {
+    uint32_t PGN[BULK_BLOCK_SIZE];
+    uint8_t SA[BULK_BLOCK_SIZE];
+    uint8_t DA[BULK_BLOCK_SIZE];
+    uint32_t added_rows = 0;
+    for (uint32_t first_frame = 0; first_frame < number_of_frames; first_frame += BULK_BLOCK_SIZE) {
+        uint32_t block_length = number_of_frames - first_frame < BULK_BLOCK_SIZE ? number_of_frames - first_frame : BULK_BLOCK_SIZE;
+        Open_SAE_J1939_Bulk_Decode_ID(ID + first_frame, block_length, PGN, SA, DA);
+
+        for (uint8_t t = 0; t < number_of_tables; t++) {
+            J1939_Bulk_Table *table = &tables[t];
+            if (!Open_SAE_J1939_Bulk_Check_Table(table))
+                continue;
+
+            /* Collect the frames of the PGN. Without a branch when the whole block fits */
+            uint32_t first_row = table->number_of_rows;
+            uint32_t row = first_row;
+            if (table->capacity - row >= block_length) {
+                for (uint32_t i = 0; i < block_length; i++) {
+                    table->frame_index[row] = first_frame + i;
+                    row += PGN[i] == table->PGN;
+                }
+            } else {
+                for (uint32_t i = 0; i < block_length; i++) {
+                    if (PGN[i] != table->PGN)
+                        continue;
+                    if (row < table->capacity)
+                        table->frame_index[row++] = first_frame + i;
+                    else
+                        table->number_of_dropped_rows++;
+                }
+            }
+            table->number_of_rows = row;
+            added_rows += row - first_row;
+
+            /* Fill the columns of the new rows */
+            if (table->time_stamps != NULL && time_stamps != NULL)
+                for (uint32_t i = first_row; i < row; i++)
+                    table->time_stamps[i] = time_stamps[table->frame_index[i]];
+            if (table->SA != NULL)
+                for (uint32_t i = first_row; i < row; i++)
+                    table->SA[i] = SA[table->frame_index[i] - first_frame];
+            if (table->DA != NULL)
+                for (uint32_t i = first_row; i < row; i++)
+                    table->DA[i] = DA[table->frame_index[i] - first_frame];
+            for (uint8_t s = 0; s < table->number_of_signals; s++)
+                Extract_Signal(data, table->frame_index, first_row, row, &table->signals[s]);
+        }
+    }
+    return added_rows;
+}
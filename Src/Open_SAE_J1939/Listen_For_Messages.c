@@ -14,6 +14,8 @@
 
 static OPEN_SAE_Callback callback_list[PGN_QTY] = {NULL};
 static void *context_list[PGN_QTY] = {0};
+static OPEN_SAE_Frame_Callback frame_callback_list[PGN_QTY] = {NULL};
+static void *frame_context_list[PGN_QTY] = {0};
 
 static uint32_t asked_id;
 static uint8_t id_asked_flag = 0;
@@ -23,6 +25,36 @@ void Open_SAE_J1939_ConfigCallback(OPEN_SAE_Callback callback, void *context, pg
     context_list[pgn] = context;
 }
 
+/* Same as Open_SAE_J1939_ConfigCallback, but the callback gets the decoded frame, so it does not need to read j1939->ID and j1939->data */
+void Open_SAE_J1939_ConfigFrameCallback(OPEN_SAE_Frame_Callback callback, void *context, pgn_list_t pgn) {
+    frame_callback_list[pgn] = callback;
+    frame_context_list[pgn] = context;
+}
+
+/* Decode a CAN frame into its J1939 fields. data must live as long as the frame is used */
+void Open_SAE_J1939_Decode_Frame(uint32_t ID, uint8_t DLC, const uint8_t data[], uint32_t time_stamp, J1939_Frame *frame) {
+    uint8_t PF = ID >> 16;                                      /* PDU format */
+    frame->ID = ID;
+    frame->PGN = (ID >> 8) & 0x3FFFF;
+    frame->DA = 0xFF;
+    if (PF < 0xF0) {
+        frame->PGN &= 0x3FF00;                                  /* PDU1 - The lowest byte is the destination address */
+        frame->DA = ID >> 8;
+    }
+    frame->SA = ID;
+    frame->priority = (ID >> 26) & 0x7;
+    frame->DLC = DLC;
+    frame->data = data;
+    frame->time_stamp = time_stamp;
+}
+
+static void Call_Callbacks(pgn_list_t pgn_index, const J1939_Frame *frame) {
+    if (callback_list[pgn_index] != NULL)
+        callback_list[pgn_index](context_list[pgn_index]);
+    if (frame_callback_list[pgn_index] != NULL)
+        frame_callback_list[pgn_index](frame, frame_context_list[pgn_index]);
+}
+
 void Open_SAE_J1939_ReadID(uint32_t id, uint8_t times) {
     asked_id = id;
     id_asked_flag = times;
@@ -30,99 +62,175 @@ void Open_SAE_J1939_ReadID(uint32_t id, uint8_t times) {
 
 #include "BOARD/communication_pc.h"
 #include <stdio.h>
+static void Read_Multi_PG(J1939 *j1939, uint32_t ID, const uint8_t data[], uint8_t length, uint32_t time_stamp_us);
+
+/* Give a frame to the function that reads it */
+static void Read_Frame(J1939 *j1939, uint32_t ID, uint8_t data[], uint8_t length, uint32_t time_stamp_us) {
+    /* Save latest */
+    if ((ID == asked_id) && id_asked_flag) {
+        char str[150] = {0};
+        sprintf(str, "%.8X ", ID);
+        for (uint8_t i = 0; i < 8; i++) {
+            char data_i[8];
+            sprintf(data_i, "%.2X ", (uint8_t)data[i]);
+            strcat(str, data_i);
+        }
+        COMMUNICATION_PC_WriteL(str);
+        id_asked_flag--;
+        // asked_id = 0;
+    }
+    j1939->ID = ID;
+    memcpy(j1939->data, data, length);
+    j1939->DLC = length;
+    j1939->ID_and_data_is_updated = true;
+    j1939->ID_and_data_time_stamp_us = time_stamp_us;
+    J1939_Frame frame;
+    uint32_t time_stamp = Clock_Get_Milliseconds() - (Clock_Get_Microseconds() - time_stamp_us) / 1000;   /* From the time stamp in microseconds, so it's from the CAN hardware too. The age is used because the microseconds wrap before the milliseconds */
+    Open_SAE_J1939_Decode_Frame(ID, length, data, time_stamp, &frame);
+    frame.time_stamp_us = time_stamp_us;
+
+    uint8_t id0 = ID >> 24;
+    uint8_t id1 = ID >> 16;
+    uint8_t DA = ID >> 8;   /* Destination address which is this ECU. if DA = 0xFF = broadcast to all ECU. Sometimes DA can be an ID number too */
+    uint8_t SA = ID;        /* Source address of the ECU that we got the message from */
+
+    /* Read request from other ECU */
+    if (id0 == 0x18 && id1 == 0xEA && (DA == j1939->information_this_ECU.this_ECU_address || DA == 0xFF))
+        SAE_J1939_Read_Request(j1939, SA, data);
+    else if (id0 == 0x18 && id1 == 0xD9 && DA == j1939->information_this_ECU.this_ECU_address)
+        SAE_J1939_Read_Request_DM14(j1939, SA, data);
+
+    /* Read status from other ECU. A broadcast acknowledgement tells the address it acknowledges in byte 5 */
+    else if (id0 == 0x18 && id1 == 0xE8 && (DA == j1939->information_this_ECU.this_ECU_address || (DA == 0xFF && data[4] == j1939->information_this_ECU.this_ECU_address)))
+        SAE_J1939_Read_Acknowledgement(j1939, SA, data);
+    else if (id0 == 0x18 && id1 == 0xD8 && DA == j1939->information_this_ECU.this_ECU_address)
+        SAE_J1939_Read_Response_DM15(j1939, SA, data);
+    else if (id0 == 0x18 && id1 == 0xD7 && DA == j1939->information_this_ECU.this_ECU_address && data[0] < 8)
+        SAE_J1939_Read_Binary_Data_Transfer_DM16(j1939, SA, data, length);                                        /* Larger DM16 comes with the Transport Protocol */
+
+
+    /* Read Transport Protocol information from other ECU */
+    else if (id0 == 0x1C && id1 == 0xEC && (DA == j1939->information_this_ECU.this_ECU_address || (DA == 0xFF && data[0] == CONTROL_BYTE_TP_CM_BAM)))
+        SAE_J1939_Read_Transport_Protocol_Connection_Management(j1939, SA, data);
+    else if (id0 == 0x1C && id1 == 0xEB && DA == j1939->information_this_ECU.this_ECU_address)
+        SAE_J1939_Read_Transport_Protocol_Data_Transfer(j1939, SA, data);
+    else if (id0 == 0x1C && id1 == 0xEB && DA == 0xFF)
+        SAE_J1939_Read_Transport_Protocol_Data_Transfer_BAM(j1939, SA, data);                              /* Every broadcasting ECU has its own BAM session */
+
+    /* Read FD Transport Protocol information from other ECU - SAE J1939-22 */
+    else if (id0 == 0x1C && id1 == 0x4D && (DA == j1939->information_this_ECU.this_ECU_address || (DA == 0xFF && (data[0] & 0xF) == CONTROL_BYTE_FD_TP_CM_BAM)))
+        SAE_J1939_Read_FD_Transport_Protocol_Connection_Management(j1939, SA, data, length);
+    else if (id0 == 0x1C && id1 == 0x4E && DA == j1939->information_this_ECU.this_ECU_address)
+        SAE_J1939_Read_FD_Transport_Protocol_Data_Transfer(j1939, SA, data, length);
+    else if (id0 == 0x1C && id1 == 0x4E && DA == 0xFF)
+        SAE_J1939_Read_FD_Transport_Protocol_Data_Transfer_BAM(j1939, SA, data, length);
+
+    /* Read the short parameter groups that other ECU has packed into one CAN FD frame - SAE J1939-22 */
+    else if (frame.PGN == pgn_value[PGN_MULTI_PG] && (DA == j1939->information_this_ECU.this_ECU_address || DA == 0xFF))
+        Read_Multi_PG(j1939, ID, data, length, time_stamp_us);
+
+    /* Read response request from other ECU - This are response request. They are responses from other ECU about request from this ECU */
+    else if (id0 == 0x18 && id1 == 0xEE && DA == 0xFF && SA != 0xFE)
+        SAE_J1939_Read_Response_Request_Address_Claimed(j1939, SA, data);                                   /* This is a broadcast response request */
+    else if (id0 == 0x18 && id1 == 0xEE && DA == 0xFF && SA == 0xFE)
+        SAE_J1939_Read_Address_Not_Claimed(j1939, SA, data);                                                /* This is error */
+    else if (id0 == 0x18 && id1 == 0xFE && DA == 0xCA)
+        SAE_J1939_Read_Response_Request_DM1(j1939, SA, data, 1);                                            /* Assume that errors_dm1_active = 1 */
+    else if (id0 == 0x18 && id1 == 0xFE && DA == 0xCB)
+        SAE_J1939_Read_Response_Request_DM2(j1939, SA, data, 1);                                            /* Assume that errors_dm2_active = 1 */
+    else if (id0 == 0x18 && id1 == 0xFE && DA == 0xDA)
+        SAE_J1939_Read_Response_Request_Software_Identification(j1939, SA, data);
+    else if (id0 == 0x18 && id1 == 0xFD && DA == 0xC5)
+        SAE_J1939_Read_Response_Request_ECU_Identification(j1939, SA, data);
+    else if (id0 == 0x18 && id1 == 0xFE && DA == 0xEB)
+        SAE_J1939_Read_Response_Request_Component_Identification(j1939, SA, data);
+    else if (id0 == 0x0C && id1 == 0xFE && DA >= 0x10 && DA <= 0x1F)
+        ISO_11783_Read_Response_Request_Auxiliary_Estimated_Flow(j1939, SA, DA & 0xF, data);                /* DA & 0xF = Valve number. Total 16 valves from 0 to 15 */
+    else if (id0 == 0x0C && id1 == 0xC6 && DA == j1939->information_this_ECU.this_ECU_address)
+        ISO_11783_Read_Response_Request_General_Purpose_Valve_Estimated_Flow(j1939, SA, data);
+    else if (id0 == 0x0C && id1 == 0xFF && DA >= 0x20 && DA <= 0x2F)
+        ISO_11783_Read_Response_Request_Auxiliary_Valve_Measured_Position(j1939, SA, DA & 0xF, data);       /* DA & 0xF = Valve number. Total 16 valves from 0 to 15 */
+
+    /* Read command from other ECU */
+    else if (id0 == 0x0C && id1 == 0xFE && DA >= 0x30 && DA <= 0x3F)
+        ISO_11783_Read_Auxiliary_Valve_Command(j1939, SA, DA & 0xF, data);                                  /* DA & 0xF = Valve number. Total 16 valves from 0 to 15 */
+    else if (id0 == 0x0C && id1 == 0xC4 && DA == j1939->information_this_ECU.this_ECU_address)
+        ISO_11783_Read_General_Purpose_Valve_Command(j1939, SA, data);                                      /* General Purpose Valve Command have only one valve */
+    else if (id0 == 0x0 && id1 == 0x2 && (DA == j1939->information_this_ECU.this_ECU_address || DA == 0xFF))
+        SAE_J1939_Read_Address_Delete(j1939, data);                                                         /* Not a SAE J1939 standard */
+    /* Add more else if statement here */
+
+    /* Every frame goes to the callbacks of its PGN, also the frames that were read above. The dashboard command has its PGN moved by the ICU type */
+    pgn_list_t pgn_index = Open_SAE_J1939_Find_PGN((uint16_t) (id1 << 8) | DA);                           /* Some PGN in the list have the destination address in them */
+    if (pgn_index == PGN_QTY)
+        pgn_index = Open_SAE_J1939_Find_PGN(frame.PGN);
+    if ((pgn_value[PGN_VOLTU_PROPIETARY_B_DASHBOARD_CMD] + PARAMETER_GetValue(PARAMETER_ICU_TYPE)) == ((uint16_t) (id1 << 8) | DA))
+        pgn_index = PGN_VOLTU_PROPIETARY_B_DASHBOARD_CMD;
+    else if (pgn_index == PGN_VOLTU_PROPIETARY_B_DASHBOARD_CMD)
+        pgn_index = PGN_QTY;                                                                                /* The dashboard command of another ICU type */
+    if (pgn_index != PGN_QTY)
+        Call_Callbacks(pgn_index, &frame);
+
+    /* Give single frame responses to the requests that are waiting for them. Transport Protocol and Acknowledgement do this by them self */
+    uint32_t PGN = frame.PGN;
+    bool is_for_this_ECU = frame.DA == j1939->information_this_ECU.this_ECU_address || frame.DA == 0xFF;
+    if (is_for_this_ECU && PGN != pgn_value[PGN_TP_CM] && PGN != pgn_value[PGN_TP_DT] && PGN != pgn_value[PGN_FD_TP_CM] && PGN != pgn_value[PGN_FD_TP_DT] && PGN != pgn_value[PGN_MULTI_PG] && PGN != pgn_value[PGN_ACKNOWLEDGEMENT] && PGN != pgn_value[PGN_REQUEST])
+        SAE_J1939_Complete_Pending_Request(j1939, SA, PGN, REQUEST_STATUS_RESPONSE, GROUP_FUNCTION_VALUE_NORMAL, data, frame.DLC);
+}
+
+/* Read every C-PG of a multi-PG frame as if it came alone. The C-PG gets the default priority of its PGN, because its own priority is not sent - SAE J1939-22 */
+static void Read_Multi_PG(J1939 *j1939, uint32_t ID, const uint8_t data[], uint8_t length, uint32_t time_stamp_us) {
+    uint8_t offset = 0;
+    uint32_t PGN;
+    const uint8_t *payload;
+    uint8_t payload_length;
+    while (SAE_J1939_Read_Multi_PG(data, length, &offset, &PGN, &payload, &payload_length)) {
+        uint8_t C_PG[CAN_MAX_DATA_LENGTH];
+        memset(C_PG, 0xFF, sizeof(C_PG));                      /* The functions that read a frame take 8 bytes, also from a shorter C-PG */
+        memcpy(C_PG, payload, payload_length);
+        pgn_list_t pgn_index = Open_SAE_J1939_Find_PGN(((PGN >> 8) & 0xFF) < 0xF0 ? PGN & 0x3FF00 : PGN);
+        uint8_t priority = pgn_index != PGN_QTY ? pgn_information[pgn_index].default_priority : (ID >> 26) & 0x7;
+        Read_Frame(j1939, ((uint32_t)priority << 26) | (PGN << 8) | (ID & 0xFF), C_PG, payload_length, time_stamp_us);
+    }
+}
+
 /* This function should be called all the time, or be placed inside an interrupt listener */
 bool Open_SAE_J1939_Listen_For_Messages(J1939 *j1939) {
+    /* Other tasks wait while the J1939 is changed here, but not while we wait for a frame */
+    Open_SAE_J1939_Lock();
+
+    /* Abort Transport Protocol sessions and requests that have timed out */
+    SAE_J1939_Check_Transport_Protocol_Timeout(j1939);
+    SAE_J1939_Check_FD_Transport_Protocol_Timeout(j1939);
+    SAE_J1939_Check_Pending_Request_Timeout(j1939);
+
+    /* Answer the requests that waited for their rate limit */
+    SAE_J1939_Check_Request_Limits(j1939);
+
+    /* Stream the next chunk of a DM14 memory read and keep the memory operation of this ECU going */
+    SAE_J1939_Memory_Access_Process(j1939);
+    SAE_J1939_Memory_Client_Process(j1939);
+
+    /* Send the valve commands that are due and watch the valves - ISO 11783-7 */
+    ISO_11783_Valve_Bank_Process(j1939);
+
+    /* Send the short parameter groups that have waited their latency in the multi-PG frame - SAE J1939-22 */
+    SAE_J1939_Multi_PG_Process(j1939);
+    Open_SAE_J1939_Unlock();
+
+    /* Save the information about this ECU that e.g a commanded address changed, if no storage task does it. Not in Read_Frame, so a frame is never read while the storage is written */
+    if (!Save_Information_This_ECU_Has_Task())
+        Save_Information_This_ECU_Process(j1939);
+
     uint32_t ID = 0;
-    uint8_t data[8] = {0};
-    bool is_new_message = CAN_Read_Message(&ID, data);
+    uint8_t data[CAN_MAX_DATA_LENGTH] = {0};
+    uint8_t length = 8;
+    uint32_t time_stamp_us = 0;
+    bool is_new_message = CAN_Read_Message_FD(&ID, data, &length, &time_stamp_us);
     if (is_new_message) {
-        /* Save latest */
-        if ((ID == asked_id) && id_asked_flag) {
-            char str[150] = {0};
-            sprintf(str, "%.8X ", ID);
-            for (uint8_t i = 0; i < 8; i++) {
-                char data_i[8];
-                sprintf(data_i, "%.2X ", (uint8_t)data[i]);
-                strcat(str, data_i);
-            }
-            COMMUNICATION_PC_WriteL(str);
-            id_asked_flag--;
-            // asked_id = 0;
-        }
-        j1939->ID = ID;
-        memcpy(j1939->data, data, 8);
-        j1939->ID_and_data_is_updated = true;
-
-        uint8_t id0 = ID >> 24;
-        uint8_t id1 = ID >> 16;
-        uint8_t DA = ID >> 8;   /* Destination address which is this ECU. if DA = 0xFF = broadcast to all ECU. Sometimes DA can be an ID number too */
-        uint8_t SA = ID;        /* Source address of the ECU that we got the message from */
-
-        /* Read request from other ECU */
-        if (id0 == 0x18 && id1 == 0xEA && (DA == j1939->information_this_ECU.this_ECU_address || DA == 0xFF))
-            SAE_J1939_Read_Request(j1939, SA, data);
-        else if (id0 == 0x18 && id1 == 0xD9 && DA == j1939->information_this_ECU.this_ECU_address)
-            SAE_J1939_Read_Request_DM14(j1939, SA, data);
-
-        /* Read status from other ECU */
-        else if (id0 == 0x18 && id1 == 0xE8 && DA == j1939->information_this_ECU.this_ECU_address)
-            SAE_J1939_Read_Acknowledgement(j1939, SA, data);
-        else if (id0 == 0x18 && id1 == 0xD8 && DA == j1939->information_this_ECU.this_ECU_address)
-            SAE_J1939_Read_Response_DM15(j1939, SA, data);
-
-
-        /* Read Transport Protocol information from other ECU */
-        else if (id0 == 0x1C && id1 == 0xEC && DA == j1939->information_this_ECU.this_ECU_address)
-            SAE_J1939_Read_Transport_Protocol_Connection_Management(j1939, SA, data);
-        else if (id0 == 0x1C && id1 == 0xEB && DA == j1939->information_this_ECU.this_ECU_address)
-            SAE_J1939_Read_Transport_Protocol_Data_Transfer(j1939, SA, data);
-
-        /* Read response request from other ECU - This are response request. They are responses from other ECU about request from this ECU */
-        else if (id0 == 0x18 && id1 == 0xEE && DA == 0xFF && SA != 0xFE)
-            SAE_J1939_Read_Response_Request_Address_Claimed(j1939, SA, data);                                   /* This is a broadcast response request */
-        else if (id0 == 0x18 && id1 == 0xEE && DA == 0xFF && SA == 0xFE)
-            SAE_J1939_Read_Address_Not_Claimed(j1939, SA, data);                                                /* This is error */
-        else if (id0 == 0x18 && id1 == 0xFE && DA == 0xCA)
-            SAE_J1939_Read_Response_Request_DM1(j1939, SA, data, 1);                                            /* Assume that errors_dm1_active = 1 */
-        else if (id0 == 0x18 && id1 == 0xFE && DA == 0xCB)
-            SAE_J1939_Read_Response_Request_DM2(j1939, SA, data, 1);                                            /* Assume that errors_dm2_active = 1 */
-        else if (id0 == 0x18 && id1 == 0xFE && DA == 0xDA)
-            SAE_J1939_Read_Response_Request_Software_Identification(j1939, SA, data);
-        else if (id0 == 0x18 && id1 == 0xFD && DA == 0xC5)
-            SAE_J1939_Read_Response_Request_ECU_Identification(j1939, SA, data);
-        else if (id0 == 0x18 && id1 == 0xFE && DA == 0xEB)
-            SAE_J1939_Read_Response_Request_Component_Identification(j1939, SA, data);
-        else if (id0 == 0x0C && id1 == 0xFE && DA >= 0x10 && DA <= 0x1F)
-            ISO_11783_Read_Response_Request_Auxiliary_Estimated_Flow(j1939, SA, DA & 0xF, data);                /* DA & 0xF = Valve number. Total 16 valves from 0 to 15 */
-        else if (id0 == 0x0C && id1 == 0xC6 && DA == j1939->information_this_ECU.this_ECU_address)
-            ISO_11783_Read_Response_Request_General_Purpose_Valve_Estimated_Flow(j1939, SA, data);
-        else if (id0 == 0x0C && id1 == 0xFF && DA >= 0x20 && DA <= 0x2F)
-            ISO_11783_Read_Response_Request_Auxiliary_Valve_Measured_Position(j1939, SA, DA & 0xF, data);       /* DA & 0xF = Valve number. Total 16 valves from 0 to 15 */
-
-        /* Read command from other ECU */
-        else if (id0 == 0x0C && id1 == 0xFE && DA >= 0x30 && DA <= 0x3F)
-            ISO_11783_Read_Auxiliary_Valve_Command(j1939, SA, DA & 0xF, data);                                  /* DA & 0xF = Valve number. Total 16 valves from 0 to 15 */
-        else if (id0 == 0x0C && id1 == 0xC4 && DA == j1939->information_this_ECU.this_ECU_address)
-            ISO_11783_Read_General_Purpose_Valve_Command(j1939, SA, data);                                      /* General Purpose Valve Command have only one valve */
-        else if (id0 == 0x0 && id1 == 0x2 && (DA == j1939->information_this_ECU.this_ECU_address || DA == 0xFF))
-            SAE_J1939_Read_Address_Delete(j1939, data);                                                         /* Not a SAE J1939 standard */
-        else if ((pgn_value[PGN_VOLTU_PROPIETARY_B_DASHBOARD_CMD] + PARAMETER_GetValue(PARAMETER_ICU_TYPE)) == ((uint16_t) (id1 << 8) | DA)) {
-            if (callback_list[PGN_VOLTU_PROPIETARY_B_DASHBOARD_CMD] != NULL) {
-                callback_list[PGN_VOLTU_PROPIETARY_B_DASHBOARD_CMD](context_list[PGN_VOLTU_PROPIETARY_B_DASHBOARD_CMD]);
-            }
-        }
-        else {
-            uint32_t PGN = (uint16_t) (id1 << 8) | DA;
-            for (pgn_list_t pgn_index = 0; pgn_index < PGN_QTY; pgn_index++) {
-                if (pgn_value[pgn_index] == PGN && (PGN_VOLTU_PROPIETARY_B_DASHBOARD_CMD != pgn_index)) {
-                    if (callback_list[pgn_index] != NULL) {
-                        callback_list[pgn_index](context_list[pgn_index]);
-                    }
-                    break;
-                }
-            }
-        }
-        /* Add more else if statement here */
+        Open_SAE_J1939_Lock();
+        Read_Frame(j1939, ID, data, length, time_stamp_us);
+        Open_SAE_J1939_Unlock();
     }
     return is_new_message;
 }
@@ -16,16 +16,31 @@
 #include "../SAE_J1939/SAE_J1939-73_Diagnostics_Layer/Diagnostics_Layer.h"
 #include "../SAE_J1939/SAE_J1939-81_Network_Management_Layer/Network_Management_Layer.h"
 #include "../SAE_J1939/SAE_J1939-21_Transport_Layer/Transport_Layer.h"
+#include "../SAE_J1939/SAE_J1939-22_FD_Transport_Layer/FD_Transport_Layer.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 void Open_SAE_J1939_ConfigCallback(OPEN_SAE_Callback callback, void *context, pgn_list_t pgn);
+void Open_SAE_J1939_ConfigFrameCallback(OPEN_SAE_Frame_Callback callback, void *context, pgn_list_t pgn);
+void Open_SAE_J1939_Decode_Frame(uint32_t ID, uint8_t DLC, const uint8_t data[], uint32_t time_stamp, J1939_Frame *frame);
+
+/* Offline decoding of recorded frames into columns - One table per PGN */
+void Open_SAE_J1939_Bulk_Decode_ID(const uint32_t ID[], uint32_t number_of_frames, uint32_t PGN[], uint8_t SA[], uint8_t DA[]);
+bool Open_SAE_J1939_Bulk_Check_Table(const J1939_Bulk_Table *table);
+uint32_t Open_SAE_J1939_Bulk_Decode(const uint64_t time_stamps[], const uint32_t ID[], const uint8_t data[][8], uint32_t number_of_frames, J1939_Bulk_Table tables[], uint8_t number_of_tables);
 
 /* This functions must be called all the time, or be placed inside an interrupt listener */
 bool Open_SAE_J1939_Listen_For_Messages(J1939 *j1939);
 
+/* FreeRTOS only - Start a RX task that runs Open_SAE_J1939_Listen_For_Messages when a frame arrives and a TX task that sends the queued frames */
+bool Open_SAE_J1939_Start_Tasks(J1939 *j1939);
+
+/* With the tasks, every call from another task than the RX task must be between these two */
+void Open_SAE_J1939_Lock(void);
+void Open_SAE_J1939_Unlock(void);
+
 /* This function should ONLY be called at your ECU startup */
 bool Open_SAE_J1939_Startup_ECU(J1939 *j1939);
 
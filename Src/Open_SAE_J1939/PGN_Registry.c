@@ -0,0 +1,32 @@
+/*
+ * PGN_Registry.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "../SAE_J1939/SAE_J1939_Enums/Enum_PGN.h"
+
+/* The tables are made from PGN_REGISTRY in Enum_PGN.h. The respond and read functions are made into tables in Request.c and Transport_Protocol_Data_Transfer.c */
+const uint32_t pgn_value[PGN_QTY] = {
+#define PGN_VALUE(name, PGN, priority, respond, read) [PGN_##name] = PGN,
+    PGN_REGISTRY(PGN_VALUE)
+#undef PGN_VALUE
+};
+
+const pgn_information_t pgn_information[PGN_QTY] = {
+#define PGN_INFORMATION(name, PGN, priority, respond, read) [PGN_##name] = { priority },
+    PGN_REGISTRY(PGN_INFORMATION)
+#undef PGN_INFORMATION
+};
+
+/* The compiler sorts the cases into a jump table or a binary search. Two entries with the same PGN will not compile */
+pgn_list_t Open_SAE_J1939_Find_PGN(uint32_t PGN) {
+    switch (PGN) {
+#define PGN_CASE(name, PGN, priority, respond, read) case PGN: return PGN_##name;
+    PGN_REGISTRY(PGN_CASE)
+#undef PGN_CASE
+    default:
+        return PGN_QTY;
+    }
+}
@@ -20,7 +20,7 @@ bool Open_SAE_J1939_Startup_ECU(J1939 *j1939) {
     uint32_t ECU_information_length = sizeof(Information_this_ECU);
     uint8_t ECU_information_data[ECU_information_length];
     memset(ECU_information_data, 0, ECU_information_length);
-    // if (!Load_Struct(ECU_information_data, ECU_information_length, (char *)INFORMATION_THIS_ECU))
+    // if (!Load_Information_This_ECU(j1939))
     //     return false; /* Problems occurs */
     HardCodeStruct((Information_this_ECU *) &ECU_information_data);
     memcpy(&j1939->information_this_ECU, (Information_this_ECU *)ECU_information_data, ECU_information_length);
@@ -31,6 +31,9 @@ bool Open_SAE_J1939_Startup_ECU(J1939 *j1939) {
     j1939->from_other_ecu_identifications.ecu_identification.length_of_each_field = 30;
     j1939->from_other_ecu_identifications.component_identification.length_of_each_field = 30;
 
+    /* The information about this ECU is new - Encode the responses again at the first request */
+    memset(&j1939->this_response_cache, 0, sizeof(j1939->this_response_cache));
+
     /* Clear other ECU addresses by setting the broadcast address to them */
     memset(j1939->other_ECU_address, 0xFF, 0xFF);
     j1939->number_of_cannot_claim_address = 0;
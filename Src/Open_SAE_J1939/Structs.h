@@ -14,9 +14,65 @@
 
 typedef void (*OPEN_SAE_Callback)(void *);
 
+/* CAN FD with SAE J1939-22 - Frames with up to 64 bytes. With 0 every frame is a classic 8 byte frame and the frame queues take less RAM */
+#ifndef CAN_FD
+#define CAN_FD 0
+#endif
+#if CAN_FD
+#define CAN_MAX_DATA_LENGTH 64
+#else
+#define CAN_MAX_DATA_LENGTH 8
+#endif
+
+/* A received CAN frame decoded into its J1939 fields. It's given to the frame callbacks by reference and is only valid inside the callback */
+typedef struct {
+    uint32_t ID;                                    /* The CAN bus ID */
+    uint32_t PGN;                                   /* Parameter Group Number - For PDU1 the destination address is not a part of the PGN */
+    uint8_t SA;                                     /* Source address */
+    uint8_t DA;                                     /* Destination address - 0xFF for broadcast and for all PDU2 frames */
+    uint8_t priority;                               /* 0 to 7 where 0 is the highest */
+    uint8_t DLC;                                    /* How many bytes of data */
+    const uint8_t *data;                            /* The payload */
+    uint32_t time_stamp;                            /* When the frame was received in milliseconds */
+    uint32_t time_stamp_us;                         /* When the frame arrived in microseconds of Clock_Get_Microseconds - From the CAN hardware if the platform has it */
+} J1939_Frame;
+
+typedef void (*OPEN_SAE_Frame_Callback)(const J1939_Frame *frame, void *context);
+
+/* A signal inside the data field of a PGN, as in SAE J1939-71. Little endian and at most 32 bits. The columns are given by the caller and can be NULL if they are not needed */
+typedef struct {
+    uint8_t start_bit;                              /* 0 is the lowest bit of data[0] - start_bit + length must not be more than 64 */
+    uint8_t length;                                 /* 1 to 32 bits */
+    float resolution;
+    float offset;
+    uint32_t *raw;                                  /* Column with the raw values */
+    float *values;                                  /* Column with raw * resolution + offset - NAN if the raw value is error or not available */
+} J1939_Bulk_Signal;
+
+/* All frames of one PGN as columns. Every column has capacity rows and the bulk decoder adds the rows after number_of_rows */
+typedef struct {
+    uint32_t PGN;                                   /* For PDU1 the destination address is not a part of the PGN */
+    uint32_t capacity;
+    uint32_t number_of_rows;
+    uint32_t number_of_dropped_rows;                /* Frames that did not fit */
+    uint32_t *frame_index;                          /* Column with the index of the frame in the input - Must be given */
+    uint64_t *time_stamps;                          /* Columns that can be NULL */
+    uint8_t *SA;
+    uint8_t *DA;
+    J1939_Bulk_Signal *signals;
+    uint8_t number_of_signals;
+} J1939_Bulk_Table;
+
 /* This text name follows 8.3 filename standard - Important if you want to save to SD card */
 #define INFORMATION_THIS_ECU "ECUINFO.TXT"
 
+/* Two files, so a power cut during a write always leaves one valid copy of the information about this ECU */
+#define INFORMATION_THIS_ECU_SLOT_A "ECUINFOA.TXT"
+#define INFORMATION_THIS_ECU_SLOT_B "ECUINFOB.TXT"
+
+/* How many bytes of field updates a slot holds before everything is written to the other slot */
+#define INFORMATION_THIS_ECU_JOURNAL_SIZE 256
+
 /* PGN: 0x00E800 - Storing the Acknowledgement from the reading process */
 struct Acknowledgement {
     uint8_t control_byte;                           /* This indicates the status of the requested information about PGN: */
@@ -33,13 +89,65 @@ struct TP_CM {
     uint8_t number_of_packages;                     /* How many times we are going to send packages via TP_DT - 2 to 224 because 1785/8 is 224 rounded up */
     uint32_t PGN_of_the_packeted_message;           /* Our message is going to activate a PGN */
     uint8_t from_ecu_address;                       /* From which ECU came this message */
+    uint8_t to_ecu_address;                         /* To which ECU this ECU is sending the message - Only used by this ECU */
+    uint32_t time_stamp;                            /* When the session had activity the last time in milliseconds */
+    uint16_t timeout;                               /* How many milliseconds without activity until the session is aborted - 0 means that no session is open */
+    uint8_t session_number;                         /* Only used by the FD Transport Protocol - 0 to 15 */
 };
 
 /* PGN: 0x00EB00 - Storing the Transport Protocol Data Transfer from the reading process */
 struct TP_DT {
-    uint8_t sequence_number;                        /* When this sequence number is the same as number_of_packages from TP_CM, then we have our complete message */
-    uint8_t data[1785];                             /* This is the collected data we are going to send. Also we are using this as a filler */
+    uint8_t sequence_number;                        /* The last sequence number that arrived */
+    uint8_t *data;                                  /* Borrowed from the Transport Protocol buffer pool while the session needs it - NULL when no buffer is borrowed */
+    uint16_t data_size;                             /* Size of the borrowed buffer */
     uint8_t from_ecu_address;                       /* From which ECU came this message */
+    uint8_t received_packages[32];                  /* One bit for every sequence number that has arrived - Only used when receiving */
+    uint8_t number_of_received_packages;            /* When this is the same as number_of_packages from TP_CM, then we have our complete message */
+    uint8_t last_requested_package;                 /* The last sequence number that our latest CTS asked for */
+    uint8_t max_packages_per_CTS;                   /* From the RTS - 0xFF means no limit */
+    uint8_t number_of_retransmit_requests;          /* CTS that asked again for missing packages since the last new package */
+};
+
+/* How many ECU can broadcast a message with BAM to this ECU at the same time */
+#define MAX_BAM_SESSIONS 4
+
+/* PGN: 0x00EC00 - A message that another ECU broadcasts with BAM. Every broadcasting ECU has its own session */
+struct BAM_session {
+    struct TP_CM tp_cm;                             /* timeout 0 means that the session is free */
+    uint8_t next_sequence_number;                   /* BAM packages come in order without retransmission - A missing package ends the session */
+    uint8_t *data;                                  /* Borrowed from the Transport Protocol buffer pool while the session is open */
+};
+
+/* The largest message the Transport Protocol can carry - 255 packages with 7 bytes each */
+#define TP_MAX_MESSAGE_SIZE 1785
+
+/*
+ * The Transport Protocol sessions borrow their buffers from a pool of fixed blocks, so the RAM follows how many sessions are open at the same time and not the largest message.
+ * A session takes the smallest block that the message fits in. Most messages are DM1, DM2, commanded address and identifications that fit in a small block.
+ * The large blocks are for DM16 memory transfers and other messages up to TP_MAX_MESSAGE_SIZE.
+ * A session that finds no free block is not opened - A RTS gets an abort, a BAM is ignored and a send returns STATUS_SEND_BUSY.
+ * The default pool is 2.2 KB. Set TP_POOL_LARGE_BLOCKS to 2 if this ECU sends and receives DM16 at the same time, e.g as a memory client and a memory server.
+ * With CAN_FD, the FD Transport Protocol borrows from the same pool. Count one block for every FD session that can be open at the same time.
+ * TP_POOL_LARGE_BLOCK_SIZE can be lowered to the largest message this ECU will send or receive
+ */
+#ifndef TP_POOL_SMALL_BLOCK_SIZE
+#define TP_POOL_SMALL_BLOCK_SIZE 64
+#endif
+#ifndef TP_POOL_SMALL_BLOCKS
+#define TP_POOL_SMALL_BLOCKS 6
+#endif
+#ifndef TP_POOL_LARGE_BLOCK_SIZE
+#define TP_POOL_LARGE_BLOCK_SIZE TP_MAX_MESSAGE_SIZE
+#endif
+#ifndef TP_POOL_LARGE_BLOCKS
+#define TP_POOL_LARGE_BLOCKS 1
+#endif
+
+struct TP_buffer_pool {
+    uint8_t small_blocks[TP_POOL_SMALL_BLOCKS][TP_POOL_SMALL_BLOCK_SIZE];
+    uint8_t large_blocks[TP_POOL_LARGE_BLOCKS][TP_POOL_LARGE_BLOCK_SIZE];
+    bool is_small_block_borrowed[TP_POOL_SMALL_BLOCKS];
+    bool is_large_block_borrowed[TP_POOL_LARGE_BLOCKS];
 };
 
 /* PGN: 0x00EE00 - Storing the Address claimed from the reading process */
@@ -185,6 +293,203 @@ struct Auxiliary_valve_measured_position {
     uint8_t from_ecu_address;                       /* From which ECU came this message */
 };
 
+/* The valve bank sends the commands of this ECU again after the interval and watches the feedback and the commands that this ECU receives - ISO 11783-7 */
+#define VALVE_BANK_COMMAND_INTERVAL 100             /* Milliseconds between two commands to the same valve */
+#define VALVE_BANK_FEEDBACK_TIMEOUT 300             /* Milliseconds without estimated flow or measured position until the feedback is stale */
+#define VALVE_BANK_COMMAND_TIMEOUT 300              /* Milliseconds without command until a valve of this ECU goes to fail safe */
+#define VALVE_BANK_GENERAL_PURPOSE_VALVE 16         /* Index of the general purpose valve. 0 to 15 are the auxiliary valves */
+#define VALVE_BANK_NUMBER_OF_VALVES 17
+
+typedef void (*ISO_11783_Fail_Safe_Callback)(uint8_t valve_number, bool is_fail_safe, void *context);
+
+/* One valve of the valve bank. The command is sent by this ECU, the watchdog is for the commands that this ECU receives as a valve */
+struct Valve_bank_valve {
+    bool is_commanded;                              /* This ECU sends commands to the valve */
+    bool is_dirty;                                  /* The command has changed and is sent at the next tick */
+    uint8_t standard_flow;                          /* Command flow */
+    uint8_t fail_safe_mode;                         /* If the valve shall go to neutral when the commands stop */
+    uint8_t valve_state;                            /* Retract, Extend, Neutral, Init, Error etc */
+    uint16_t extended_flow;                         /* Another command flow - Only the general purpose valve */
+    uint32_t command_time_stamp;                    /* When the command was sent the last time in milliseconds */
+    uint32_t feedback_time_stamp;                   /* When the estimated flow or measured position arrived the last time in milliseconds */
+    bool is_feedback_stale;                         /* The valve has not answered in VALVE_BANK_FEEDBACK_TIMEOUT */
+    bool is_watched;                                /* This ECU has received a command for the valve */
+    uint32_t received_command_time_stamp;           /* When the last command arrived in milliseconds */
+    bool is_fail_safe;                              /* The commands have stopped and the valve is in fail safe */
+};
+
+struct Valve_bank {
+    struct Valve_bank_valve valves[VALVE_BANK_NUMBER_OF_VALVES];
+    uint8_t general_purpose_valve_address;          /* The ECU that has the general purpose valve */
+    ISO_11783_Fail_Safe_Callback callback;          /* Tells the application when a valve of this ECU goes to or leaves fail safe */
+    void *callback_context;                         /* Given back to the callback */
+};
+
+/* Pre-encoded response about this ECU - Encoded at the first request and reused until information_this_ECU changes */
+struct Encoded_response {
+    bool is_encoded;                                /* If false, the response will be encoded again from information_this_ECU */
+    bool use_transport_protocol;                    /* If true, the response is larger than one CAN message and need to be sent with TP CM and TP DT */
+    uint16_t length;                                /* How many bytes of data that are used */
+    uint8_t data[120];                              /* Encoded response - The largest is 4 identification fields * 30 bytes */
+};
+
+/* Storing the pre-encoded responses about this ECU. Clear this struct with memset if information_this_ECU changes */
+struct Response_cache {
+    bool name_is_encoded;                           /* If false, the NAME will be encoded again from information_this_ECU */
+    uint8_t name[8];                                /* PGN: 0x00EE00 - NAME of this ECU, used by address claimed and address not claimed */
+    struct Encoded_response software_identification;
+    struct Encoded_response ecu_identification;
+    struct Encoded_response component_identification;
+};
+
+/* How many requests this ECU can wait for at the same time */
+#define MAX_PENDING_REQUESTS 8
+
+/* A request that is answered with busy is sent again after the backoff. The backoff is doubled for every retry */
+#define REQUEST_MAX_BUSY_RETRIES 3
+#define REQUEST_BUSY_BACKOFF 50                     /* Milliseconds before the first retry */
+
+/* The answer to a request from this ECU. The response has already been decoded into the from_other_ecu fields when the callback is called */
+struct Request_response {
+    uint16_t handle;                                /* The handle that was given when the request was sent */
+    uint8_t status;                                 /* ENUM_REQUEST_STATUS_CODES */
+    uint32_t PGN;                                   /* The requested PGN */
+    uint8_t from_ecu_address;                       /* From which ECU came the answer */
+    uint8_t group_function_value;                   /* The cause of a NACK, access denied or busy */
+    const uint8_t *data;                            /* The raw response - Only valid inside the callback */
+    uint16_t length;                                /* How many bytes of data the response has */
+    uint32_t time_stamp_us;                         /* When the last frame of the response arrived in microseconds - For a timeout it's when the timeout was found */
+};
+
+typedef void (*SAE_J1939_Request_Callback)(const struct Request_response *response, void *context);
+
+/* A request from this ECU that waits for an answer from other ECU */
+struct Pending_request {
+    SAE_J1939_Request_Callback callback;            /* NULL means that this slot is free */
+    void *context;                                  /* Given back to the callback */
+    uint32_t PGN;                                   /* The requested PGN */
+    uint8_t DA;                                     /* The ECU that we are asking. 0xFF means every ECU */
+    uint8_t generation;                             /* Counts up for every use of this slot, so an old handle cannot cancel a new request */
+    uint32_t time_stamp;                            /* When the request was sent or the response had activity the last time in milliseconds */
+    uint16_t timeout;                               /* How many milliseconds we wait for the answer */
+    uint8_t number_of_busy_retries;                 /* How many times the request has been sent again after busy */
+    uint16_t retry_delay;                           /* Milliseconds from time_stamp until the request is sent again - 0 means that no retry is waiting */
+};
+
+/* The rate limit of the responses to requests from other ECU. A repeated request inside the interval is answered once when the interval has passed */
+#define MAX_REQUEST_LIMITS 16                       /* How many PGN and requester pairs are remembered */
+#define MAX_REQUEST_INTERVALS 8                     /* How many PGN can have their own interval */
+#define REQUEST_MIN_RESPONSE_INTERVAL 100           /* Milliseconds between two responses to the same PGN and requester, if the PGN has no own interval. Not for the address claim */
+
+struct Request_limit {
+    uint32_t PGN;                                   /* The requested PGN */
+    uint8_t SA;                                     /* The ECU that asked - 0xFF when many ECU asked for a broadcast PGN */
+    bool is_used;
+    bool is_pending;                                /* A request came inside the interval and waits for the response */
+    uint32_t response_time;                         /* When the last response was sent in milliseconds */
+};
+
+struct Request_interval {
+    uint32_t PGN;
+    uint16_t interval;                              /* Milliseconds - 0 turns off the rate limit for this PGN */
+};
+
+struct Request_limiter {
+    struct Request_limit limits[MAX_REQUEST_LIMITS];
+    struct Request_interval intervals[MAX_REQUEST_INTERVALS];
+    uint8_t number_of_intervals;
+    uint32_t number_of_coalesced_requests;          /* Requests that did not give an own response */
+};
+
+/* How many memory regions other ECU can reach with DM14 */
+#define MAX_MEMORY_REGIONS 4
+
+/* How many bytes one DM16 carries when a large read is streamed - The number of occurrences is one byte */
+#define MEMORY_ACCESS_CHUNK_SIZE 255
+
+/* How many milliseconds a DM14 operation can be quiet before it fails */
+#define MEMORY_ACCESS_TIMEOUT 5000
+
+/* Memory backend for DM14. offset is counted from the start of the region. Return false if the memory could not be accessed */
+typedef bool (*Memory_Read_Callback)(void *context, uint32_t offset, uint8_t data[], uint16_t length);
+typedef bool (*Memory_Write_Callback)(void *context, uint32_t offset, const uint8_t data[], uint16_t length);
+typedef bool (*Memory_Erase_Callback)(void *context, uint32_t offset, uint32_t length);
+typedef uint16_t (*Memory_Key_Callback)(void *context, uint16_t seed);
+
+/* A memory area of this ECU that other ECU can read, write or erase with DM14 */
+struct Memory_region {
+    uint32_t address;                               /* (pointer extension << 24) | pointer of the first byte */
+    uint32_t length;                                /* How many bytes - 0 means that this slot is free */
+    Memory_Read_Callback read;                      /* NULL if the region cannot be read */
+    Memory_Write_Callback write;                    /* NULL if the region cannot be written */
+    Memory_Erase_Callback erase;                    /* NULL if the region cannot be erased */
+    Memory_Key_Callback key;                        /* Computes the expected key from the seed - NULL if no key is needed */
+    void *context;                                  /* Given back to the callbacks */
+};
+
+/* The memory regions of this ECU and the DM14 operation from other ECU that is in progress */
+struct Memory_access {
+    struct Memory_region regions[MAX_MEMORY_REGIONS];
+    bool is_open;                                   /* An operation is in progress */
+    bool is_sending;                                /* A DM16 chunk is on its way with the Transport Protocol */
+    uint8_t command;                                /* ENUM_DM14_CODES */
+    uint8_t from_ecu_address;                       /* The ECU that asked for the operation */
+    uint8_t region_index;                           /* Which region we are working in */
+    uint32_t offset;                                /* Next byte to read or write, counted from the start of the region */
+    uint16_t number_of_bytes;                       /* How many bytes the operation has */
+    uint16_t remaining_bytes;                       /* How many bytes that are left to read or write */
+    uint32_t time_stamp;                            /* When the operation had activity the last time in milliseconds */
+    bool is_seed_sent;                              /* A seed waits for a key */
+    uint16_t seed;                                  /* The seed that was sent */
+    uint8_t seed_to_ecu_address;                    /* The ECU that got the seed */
+};
+
+/* How many bytes the memory client asks for with every DM14 - One DM16 */
+#define MEMORY_CLIENT_CHUNK_SIZE 255
+
+/* How long the memory client waits before it asks again when the other ECU is busy, and how many times it asks */
+#define MEMORY_CLIENT_BUSY_DELAY 50
+#define MEMORY_CLIENT_MAX_BUSY_RETRIES 10
+
+/* What the memory client tells its callback */
+struct Memory_client_status {
+    uint8_t status;                                 /* ENUM_MEMORY_CLIENT_STATUS_CODES */
+    uint8_t from_ecu_address;                       /* The ECU whose memory we read or write */
+    uint32_t address;                               /* First address of the operation */
+    uint32_t length;                                /* How many bytes the operation has */
+    uint32_t transferred_bytes;                     /* How many bytes that have been read or written - Counts from 0 again when the write is verified */
+    uint16_t checksum;                              /* CRC-16/CCITT of the transferred bytes */
+    uint32_t EDC_parameter;                         /* The error indicator from DM15 when the other ECU failed the operation */
+};
+
+typedef void (*Memory_Client_Callback)(const struct Memory_client_status *status, void *context);
+
+/* A memory read or write from this ECU at other ECU, split into DM14 requests */
+struct Memory_client {
+    Memory_Client_Callback callback;                /* NULL means that no operation is in progress */
+    void *context;                                  /* Given back to every callback */
+    Memory_Write_Callback destination;              /* Where the read bytes go - offset is counted from address */
+    Memory_Read_Callback source;                    /* Where the bytes to write come from - offset is counted from address */
+    Memory_Key_Callback key;                        /* Computes the key from the seed - NULL if the other ECU needs no key */
+    uint8_t DA;                                     /* The ECU whose memory we read or write */
+    uint8_t command;                                /* COMMAND_DM14_READ or COMMAND_DM14_WRITE - Verify reads */
+    bool verify;                                    /* Read back the written bytes and compare the checksum */
+    bool is_verifying;                              /* The written bytes are read back */
+    bool is_data_waiting;                           /* DM16 must be sent when the Transport Protocol is free */
+    bool is_data_sent;                              /* DM16 has been sent for the last DM14 write */
+    uint32_t address;                               /* First address of the operation */
+    uint32_t length;                                /* How many bytes the operation has */
+    uint32_t requested_bytes;                       /* How many bytes that have been asked for with DM14 */
+    uint32_t transferred_bytes;                     /* How many bytes that have been read or written */
+    uint32_t request_address;                       /* Address of the last DM14 */
+    uint16_t request_bytes;                         /* Number of bytes of the last DM14 */
+    uint16_t checksum;                              /* CRC of the transferred bytes */
+    uint16_t written_checksum;                      /* CRC of the written bytes when they are verified */
+    uint8_t busy_retries;                           /* How many times the other ECU has been busy in a row */
+    bool is_busy;                                   /* The last DM14 is sent again after MEMORY_CLIENT_BUSY_DELAY */
+    uint32_t time_stamp;                            /* When the operation had activity the last time in milliseconds */
+};
+
 /* This struct is used for save information and load information from hard drive/SD-card/flash etc. due to the large size of J1939 */
 typedef struct {
     struct Name this_name;
@@ -192,12 +497,40 @@ typedef struct {
     struct Identifications this_identifications;
 } Information_this_ECU;
 
+/* Called by the storage worker when a requested save is done. is_saved is false if the storage failed */
+typedef void (*Information_Save_Callback)(bool is_saved, void *context);
+
+/* What the slots hold. Only the bytes that differ from saved are written at the next save */
+struct Information_storage {
+    Information_this_ECU saved;                     /* The information as it is in the storage */
+    bool is_valid;                                  /* saved, slot and sequence are known */
+    uint8_t slot;                                   /* The slot in use - 0 is A and 1 is B */
+    uint32_t sequence;                              /* Counts up for every complete write - The valid slot with the highest sequence is the newest */
+    uint16_t journal_length;                        /* How many bytes of field updates that follow the information in the slot */
+
+    /* Requested saves that the storage worker has not done yet - Only the latest copy is kept */
+    Information_this_ECU pending;
+    bool is_pending;
+    Information_Save_Callback callback;
+    void *callback_context;
+};
+
+/* Short parameter groups (C-PG) that wait to be packed into one multi-PG frame - SAE J1939-22 */
+struct Multi_PG {
+    uint8_t data[CAN_MAX_DATA_LENGTH];              /* A 4 byte header in front of every C-PG */
+    uint8_t length;                                 /* How many bytes are packed - 0 means that nothing waits */
+    uint8_t priority;                               /* The highest priority of the packed C-PG, 0 is the highest */
+    uint32_t deadline;                              /* The frame is sent when Clock_Get_Milliseconds has passed this */
+};
+
 /* This struct is used for handling J1939 information */
 typedef struct {
     /* Latest CAN message */
     uint32_t ID;                                    /* This is the CAN bus ID */
-    uint8_t data[8];                                /* This is the CAN bus data */
+    uint8_t data[CAN_MAX_DATA_LENGTH];              /* This is the CAN bus data */
+    uint8_t DLC;                                    /* How many bytes of data - A classic frame has always 8 */
     bool ID_and_data_is_updated;                    /* This is a flag that going to be set to true for every time ID and data updates */
+    uint32_t ID_and_data_time_stamp_us;             /* When the latest CAN message arrived in microseconds */
 
     /* Store addresses of ECU */
     uint8_t number_of_other_ECU;                    /* How many other ECU are connected */
@@ -209,6 +542,7 @@ typedef struct {
     struct Acknowledgement from_other_ecu_acknowledgement;
     struct TP_CM from_other_ecu_tp_cm;
     struct TP_DT from_other_ecu_tp_dt;
+    struct BAM_session from_other_ecu_bam[MAX_BAM_SESSIONS];
     struct DM from_other_ecu_dm;
     struct Identifications from_other_ecu_identifications;
 
@@ -216,6 +550,31 @@ typedef struct {
     struct TP_CM this_ecu_tp_cm;
     struct TP_DT this_ecu_tp_dt;
 
+    /* The same for the FD Transport Protocol - SAE J1939-22 */
+    bool is_CAN_FD;                                 /* The bus is CAN FD - Messages larger than 8 bytes are sent with the FD Transport Protocol */
+    struct TP_CM from_other_ecu_fd_tp_cm;
+    struct TP_DT from_other_ecu_fd_tp_dt;
+    struct BAM_session from_other_ecu_fd_bam[MAX_BAM_SESSIONS];
+    struct TP_CM this_ecu_fd_tp_cm;
+    struct TP_DT this_ecu_fd_tp_dt;
+    uint8_t this_ecu_fd_tp_session_number;          /* Counts up for every message, so the other ECU can tell the sessions apart */
+    struct Multi_PG this_multi_pg;
+
+    /* The buffers of the Transport Protocol sessions above */
+    struct TP_buffer_pool this_tp_buffer_pool;
+
+    /* Requests from this ECU that wait for an answer from other ECU */
+    struct Pending_request this_pending_requests[MAX_PENDING_REQUESTS];
+
+    /* Rate limit of the responses to requests from other ECU */
+    struct Request_limiter this_request_limiter;
+
+    /* Memory of this ECU that other ECU can reach with DM14, DM15 and DM16 */
+    struct Memory_access this_memory_access;
+
+    /* Memory of other ECU that this ECU reads or writes with DM14, DM15 and DM16 */
+    struct Memory_client this_memory_client;
+
     /* Temporary store the valve information from the reading process - ISO 11783-7 */
     struct Auxiliary_valve_estimated_flow from_other_ecu_auxiliary_valve_estimated_flow[16];
     struct Auxiliary_valve_measured_position from_other_ecu_auxiliary_valve_measured_position[16];
@@ -225,12 +584,15 @@ typedef struct {
 
     /* For ID information about this ECU - SAE J1939 */
     Information_this_ECU information_this_ECU;
+    struct Response_cache this_response_cache;
+    struct Information_storage this_information_storage;
     struct DM this_dm;
 
     /* For valve information about this ECU - ISO 11783-7 */
     struct Auxiliary_valve_estimated_flow this_auxiliary_valve_estimated_flow[16];
     struct Auxiliary_valve_measured_position this_auxiliary_valve_measured_position[16];
     struct General_purpose_valve_estimated_flow this_general_purpose_valve_estimated_flow;
+    struct Valve_bank this_valve_bank;
 } J1939;
 
 
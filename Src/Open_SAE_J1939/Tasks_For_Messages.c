@@ -0,0 +1,63 @@
+/*
+ * Tasks_For_Messages.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Open_SAE_J1939.h"
+
+/* Layers */
+#include "../Hardware/Hardware.h"
+
+/* The task model needs FreeRTOS, which only the PIC port uses */
+#if PROCESSOR_CHOICE == PIC
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Internal fields */
+static SemaphoreHandle_t j1939_mutex = NULL;                    /* Recursive, so a callback in the RX task can take it again */
+
+/* CAN_Read_Message blocks on the queue from the receive ISR, so this task sleeps until a frame arrives or CAN_RX_WAIT_MS has passed */
+static void Open_SAE_J1939_Receive_Task(void *parameter) {
+    J1939 *j1939 = (J1939 *) parameter;
+    for (;;)
+        Open_SAE_J1939_Listen_For_Messages(j1939);
+}
+
+/*
+ * Start the RX task, the TX task and the storage task. Call this after Open_SAE_J1939_Startup_ECU and before the scheduler starts.
+ * The application must not call Open_SAE_J1939_Listen_For_Messages by itself after this. An application task that calls the other functions with the same J1939 must do it between Open_SAE_J1939_Lock and Open_SAE_J1939_Unlock
+ */
+bool Open_SAE_J1939_Start_Tasks(J1939 *j1939) {
+    if (j1939_mutex == NULL)
+        j1939_mutex = xSemaphoreCreateRecursiveMutex();
+    if (j1939_mutex == NULL)
+        return false;
+    if (!CAN_Start_Transmit_Task())
+        return false;
+    if (!Save_Information_This_ECU_Start_Task(j1939))
+        return false;
+    return xTaskCreate(Open_SAE_J1939_Receive_Task, "J1939 RX", CAN_RX_TASK_STACK_SIZE, j1939, CAN_RX_TASK_PRIORITY, NULL) == pdPASS;
+}
+#endif
+
+/*
+ * The RX task reads frames, checks the timeouts and runs the callbacks with the lock, but it does not hold the lock while it waits for a frame.
+ * Take the lock around every call from another task that sends or changes the J1939, e.g. SAE_J1939_Send_Request or ISO_11783_Valve_Bank_Set_Auxiliary_Valve_Command, so the Transport Protocol sessions and the buffer pool are never changed by two tasks at once.
+ * The callbacks run in the RX task and already have the lock. Without the tasks of Open_SAE_J1939_Start_Tasks, this does nothing
+ */
+void Open_SAE_J1939_Lock(void) {
+#if PROCESSOR_CHOICE == PIC
+    if (j1939_mutex != NULL)
+        xSemaphoreTakeRecursive(j1939_mutex, portMAX_DELAY);
+#endif
+}
+
+void Open_SAE_J1939_Unlock(void) {
+#if PROCESSOR_CHOICE == PIC
+    if (j1939_mutex != NULL)
+        xSemaphoreGiveRecursive(j1939_mutex);
+#endif
+}
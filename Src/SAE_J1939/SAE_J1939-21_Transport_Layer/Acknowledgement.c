@@ -17,6 +17,24 @@ void SAE_J1939_Read_Acknowledgement(J1939 *j1939, uint8_t SA, uint8_t data[]) {
 	j1939->from_other_ecu_acknowledgement.address = data[4]; 							/* The source address from the ECU */
 	j1939->from_other_ecu_acknowledgement.PGN_of_requested_info = (data[7] << 16) | (data[6] << 8) | data[5];
 	j1939->from_other_ecu_acknowledgement.from_ecu_address = SA;						/* From where came the message */
+
+	/* Tell the request that is waiting for this acknowledgement */
+	uint8_t status;
+	switch(data[0]){
+	case CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_SUPPORTED:
+		status = REQUEST_STATUS_ACK;
+		break;
+	case CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_ACCESS_DENIED:
+		status = REQUEST_STATUS_ACCESS_DENIED;
+		break;
+	case CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_BUSY:
+		status = REQUEST_STATUS_BUSY;
+		break;
+	default:
+		status = REQUEST_STATUS_NACK;
+		break;
+	}
+	SAE_J1939_Complete_Pending_Request(j1939, SA, j1939->from_other_ecu_acknowledgement.PGN_of_requested_info, status, data[1], data, 8);
 }
 
 /*
@@ -0,0 +1,180 @@
+/*
+ * Pending_Request.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Transport_Layer.h"
+
+/* C standard library */
+#include <stddef.h>
+
+/* Internal functions */
+static uint16_t Get_Handle(J1939 *j1939, uint8_t index) {
+    return (j1939->this_pending_requests[index].generation << 8) | index;
+}
+
+/*
+ * A Transport Protocol or BAM session from the asked ECU carries the answer to the request.
+ * A global request is never kept alive, because ECU that broadcast the PGN with BAM all the time would keep it open for ever
+ */
+static bool Is_Response_On_Its_Way(const struct TP_CM *tp_cm, const struct Pending_request *pending_request) {
+    return tp_cm->timeout > 0 && tp_cm->PGN_of_the_packeted_message == pending_request->PGN && pending_request->DA == tp_cm->from_ecu_address;
+}
+
+/* Free the slot before the callback is called, so the callback can send a new request directly */
+static void Finish_Pending_Request(J1939 *j1939, uint8_t index, struct Request_response *response) {
+    struct Pending_request pending_request = j1939->this_pending_requests[index];
+    response->handle = Get_Handle(j1939, index);
+    response->PGN = pending_request.PGN;
+    j1939->this_pending_requests[index].callback = NULL;
+    pending_request.callback(response, pending_request.context);
+}
+
+/* Busy means that the other ECU cannot answer right now. Wait a bit longer every time, so we don't take its time from other requests */
+static bool Schedule_Busy_Retry(struct Pending_request *pending_request) {
+    if (pending_request->number_of_busy_retries >= REQUEST_MAX_BUSY_RETRIES)
+        return false;
+    pending_request->retry_delay = REQUEST_BUSY_BACKOFF << pending_request->number_of_busy_retries;
+    pending_request->number_of_busy_retries++;
+    pending_request->time_stamp = Clock_Get_Milliseconds();
+    return true;
+}
+
+/*
+ * Request PGN information at other ECU and get the answer in a callback instead of polling the from_other_ecu fields.
+ * The callback is called once with the response, ACK, NACK, access denied, busy or timeout. Busy is only given when the retries after busy have been used.
+ * If DA is 0xFF, every ECU can answer. Then the callback is called for every response and last with REQUEST_STATUS_TIMEOUT when the time is up. A response that is still on its way then is not waited for.
+ * handle can be NULL if the request will not be cancelled. Returns STATUS_SEND_BUSY if there is no free slot or if the same request is already waiting
+ * PGN: 0x00EA00 (59904)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Request_Async(J1939 *j1939, uint8_t DA, uint32_t PGN_code, uint16_t timeout, SAE_J1939_Request_Callback callback, void *context, uint16_t *handle) {
+    if (callback == NULL || timeout == 0)
+        return STATUS_SEND_ERROR;
+
+    /* Find a free slot. A second request for the same PGN at the same ECU cannot be told apart from the first */
+    uint8_t index = MAX_PENDING_REQUESTS;
+    for (uint8_t i = 0; i < MAX_PENDING_REQUESTS; i++) {
+        struct Pending_request *pending_request = &j1939->this_pending_requests[i];
+        if (pending_request->callback == NULL) {
+            if (index == MAX_PENDING_REQUESTS)
+                index = i;
+        } else if (pending_request->PGN == PGN_code && pending_request->DA == DA) {
+            return STATUS_SEND_BUSY;
+        }
+    }
+    if (index == MAX_PENDING_REQUESTS)
+        return STATUS_SEND_BUSY;
+
+    ENUM_J1939_STATUS_CODES status = SAE_J1939_Send_Request(j1939, DA, PGN_code);
+    if (status != STATUS_SEND_OK)
+        return status;
+
+    struct Pending_request *pending_request = &j1939->this_pending_requests[index];
+    pending_request->callback = callback;
+    pending_request->context = context;
+    pending_request->PGN = PGN_code;
+    pending_request->DA = DA;
+    pending_request->generation++;
+    if (pending_request->generation == 0)
+        pending_request->generation = 1;                        /* Handle 0 is never given out */
+    pending_request->time_stamp = Clock_Get_Milliseconds();
+    pending_request->timeout = timeout;
+    pending_request->number_of_busy_retries = 0;
+    pending_request->retry_delay = 0;
+    if (handle != NULL)
+        *handle = Get_Handle(j1939, index);
+    return status;
+}
+
+/* Stop waiting for an answer. The callback will not be called. Returns false if the request is already done */
+bool SAE_J1939_Cancel_Request(J1939 *j1939, uint16_t handle) {
+    uint8_t index = handle & 0xFF;
+    if (index >= MAX_PENDING_REQUESTS)
+        return false;
+    struct Pending_request *pending_request = &j1939->this_pending_requests[index];
+    if (pending_request->callback == NULL || pending_request->generation != handle >> 8)
+        return false;
+    pending_request->callback = NULL;
+    return true;
+}
+
+/*
+ * Give an answer from other ECU to the requests that are waiting for it. Matching is done on PGN and source address.
+ * This is called by Listen_For_Messages, the Transport Protocol and the Acknowledgement after the answer has been decoded
+ */
+void SAE_J1939_Complete_Pending_Request(J1939 *j1939, uint8_t SA, uint32_t PGN, uint8_t status, uint8_t group_function_value, const uint8_t data[], uint16_t length) {
+    for (uint8_t i = 0; i < MAX_PENDING_REQUESTS; i++) {
+        struct Pending_request *pending_request = &j1939->this_pending_requests[i];
+        if (pending_request->callback == NULL || pending_request->PGN != PGN)
+            continue;
+        if (pending_request->DA != SA && pending_request->DA != 0xFF)
+            continue;
+
+        struct Request_response response = {0};
+        response.status = status;
+        response.from_ecu_address = SA;
+        response.group_function_value = group_function_value;
+        response.data = data;
+        response.length = length;
+        response.time_stamp_us = j1939->ID_and_data_time_stamp_us;                         /* The frame that completed the answer - The last package with the Transport Protocol */
+        if (pending_request->DA == 0xFF) {
+            /* A global request is open until the time is up, because we don't know how many ECU will answer */
+            if (status == REQUEST_STATUS_RESPONSE) {
+                response.handle = Get_Handle(j1939, i);
+                response.PGN = pending_request->PGN;
+                pending_request->callback(&response, pending_request->context);
+            }
+        } else if (status != REQUEST_STATUS_BUSY || !Schedule_Busy_Retry(pending_request)) {
+            Finish_Pending_Request(j1939, i, &response);
+        }
+    }
+}
+
+/*
+ * Call the callback with REQUEST_STATUS_TIMEOUT for the requests that have not been answered in time.
+ * A response that is on its way with the Transport Protocol keeps a request to one ECU alive. A global request ends when its time is up. A request that got busy is sent again here when the backoff has passed.
+ * This is called from Open_SAE_J1939_Listen_For_Messages
+ */
+void SAE_J1939_Check_Pending_Request_Timeout(J1939 *j1939) {
+    uint32_t now = Clock_Get_Milliseconds();
+    for (uint8_t i = 0; i < MAX_PENDING_REQUESTS; i++) {
+        struct Pending_request *pending_request = &j1939->this_pending_requests[i];
+        if (pending_request->callback == NULL)
+            continue;
+
+        /* Send again after busy. If the bus is full, we try again on the next call. The timeout starts over when the request has been sent */
+        if (pending_request->retry_delay > 0) {
+            if ((uint32_t)(now - pending_request->time_stamp) >= pending_request->retry_delay && SAE_J1939_Send_Request(j1939, pending_request->DA, pending_request->PGN) == STATUS_SEND_OK) {
+                pending_request->retry_delay = 0;
+                pending_request->time_stamp = now;
+            }
+            continue;
+        }
+
+        /* The response is coming with the Transport Protocol or the FD Transport Protocol */
+        if (Is_Response_On_Its_Way(&j1939->from_other_ecu_tp_cm, pending_request) || Is_Response_On_Its_Way(&j1939->from_other_ecu_fd_tp_cm, pending_request)) {
+            pending_request->time_stamp = now;
+            continue;
+        }
+        bool is_bam_on_its_way = false;
+        for (uint8_t j = 0; j < MAX_BAM_SESSIONS; j++) {
+            is_bam_on_its_way |= Is_Response_On_Its_Way(&j1939->from_other_ecu_bam[j].tp_cm, pending_request);
+            is_bam_on_its_way |= Is_Response_On_Its_Way(&j1939->from_other_ecu_fd_bam[j].tp_cm, pending_request);
+        }
+        if (is_bam_on_its_way) {
+            pending_request->time_stamp = now;
+            continue;
+        }
+
+        if ((uint32_t)(now - pending_request->time_stamp) >= pending_request->timeout) {
+            struct Request_response response = {0};
+            response.status = REQUEST_STATUS_TIMEOUT;
+            response.from_ecu_address = pending_request->DA;
+            response.group_function_value = GROUP_FUNCTION_VALUE_ABORT_TIME_OUT;
+            response.time_stamp_us = Clock_Get_Microseconds();
+            Finish_Pending_Request(j1939, i, &response);
+        }
+    }
+}
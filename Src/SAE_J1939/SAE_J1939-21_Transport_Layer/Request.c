@@ -13,49 +13,176 @@
 #include "../SAE_J1939-71_Application_Layer/Application_Layer.h"
 #include "../SAE_J1939-81_Network_Management_Layer/Network_Management_Layer.h"
 
+/* Internal functions */
+static void Respond_Request(J1939 *j1939, uint8_t SA, uint32_t PGN);
+
+static uint16_t Get_Request_Interval(J1939 *j1939, uint32_t PGN) {
+	for (uint8_t i = 0; i < j1939->this_request_limiter.number_of_intervals; i++)
+		if (j1939->this_request_limiter.intervals[i].PGN == PGN)
+			return j1939->this_request_limiter.intervals[i].interval;
+	if (PGN == pgn_value[PGN_ADDRESS_CLAIMED])
+		return 0;															/* SAE J1939-81 wants every request for the address claim answered */
+	return REQUEST_MIN_RESPONSE_INTERVAL;
+}
+
+/* A PDU2 PGN is broadcast, so every requester gets the same response. Then the limit is for the PGN and not for each requester */
+static bool Is_Broadcast_Response(uint32_t PGN) {
+	return ((PGN >> 8) & 0xFF) >= 0xF0;
+}
+
+/* Returns true if the request can be answered now. Else the request is remembered and answered by SAE_J1939_Check_Request_Limits */
+static bool Check_Request_Limit(J1939 *j1939, uint8_t SA, uint32_t PGN) {
+	uint16_t interval = Get_Request_Interval(j1939, PGN);
+	if (interval == 0)
+		return true;
+	uint32_t now = Clock_Get_Milliseconds();
+	struct Request_limit *free_limit = NULL;
+	for (uint8_t i = 0; i < MAX_REQUEST_LIMITS; i++) {
+		struct Request_limit *limit = &j1939->this_request_limiter.limits[i];
+		if (limit->is_used && limit->PGN == PGN && (limit->SA == SA || Is_Broadcast_Response(PGN))) {
+			if (!limit->is_pending && now - limit->response_time >= interval) {
+				limit->SA = SA;
+				limit->response_time = now;
+				return true;
+			}
+			if (limit->is_pending) {
+				j1939->this_request_limiter.number_of_coalesced_requests++;	/* One response is already on its way */
+				if (limit->SA != SA)
+					limit->SA = 0xFF;										/* Many ECU have asked - A response that is not a single frame goes with BAM to all of them */
+			} else {
+				limit->SA = SA;
+			}
+			limit->is_pending = true;
+			return false;
+		}
+
+		/* Use a free slot, else the slot that has been quiet the longest time */
+		if (!limit->is_used)
+			free_limit = limit;
+		else if (!limit->is_pending && (free_limit == NULL || (free_limit->is_used && (int32_t)(limit->response_time - free_limit->response_time) < 0)))
+			free_limit = limit;
+	}
+	if (free_limit != NULL) {
+		free_limit->is_used = true;
+		free_limit->is_pending = false;
+		free_limit->PGN = PGN;
+		free_limit->SA = SA;
+		free_limit->response_time = now;
+	}
+	return true;															/* Every slot waits for a response - Answer rather than drop the request */
+}
+
 /*
- * Read a PGN request from another ECU about PGN information at this ECU. All listed PGN should be here
+ * Read a PGN request from another ECU about PGN information at this ECU. Repeated requests from the same ECU are rate limited.
+ * Requests for a broadcast PGN are rate limited for all ECU together, so requests that come close to each other give one response
  * PGN: 0x00EA00 (59904)
  */
 void SAE_J1939_Read_Request(J1939 *j1939, uint8_t SA, uint8_t data[]) {
 	uint32_t PGN = (data[2] << 16) | (data[1] << 8) | data[0];
-	if (PGN == pgn_value[PGN_ACKNOWLEDGEMENT]) {
-		SAE_J1939_Send_Acknowledgement(j1939, SA, CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_SUPPORTED, GROUP_FUNCTION_VALUE_NORMAL, PGN);
-	} else if (PGN == pgn_value[PGN_ADDRESS_CLAIMED]){
-		SAE_J1939_Response_Request_Address_Claimed(j1939);
-	} else if (PGN == pgn_value[PGN_COMMANDED_ADDRESS]) {
-		SAE_J1939_Send_Acknowledgement(j1939, SA, CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_SUPPORTED, GROUP_FUNCTION_VALUE_NORMAL, PGN);
-	} else if (PGN == pgn_value[PGN_ADDRESS_DELETE]) {
-		SAE_J1939_Send_Acknowledgement(j1939, SA, CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_SUPPORTED, GROUP_FUNCTION_VALUE_NORMAL, PGN); /* Not SAE J1939 standard */
-	} else if (PGN == pgn_value[PGN_DM1]) {
-		SAE_J1939_Response_Request_DM1(j1939, SA);
-	} else if (PGN == pgn_value[PGN_DM2]) {
-		SAE_J1939_Response_Request_DM2(j1939, SA);
-		SAE_J1939_Send_Acknowledgement(j1939, SA, CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_SUPPORTED, GROUP_FUNCTION_VALUE_NORMAL, PGN);
-	} else if (PGN == pgn_value[PGN_DM3]) {
-		SAE_J1939_Response_Request_DM3(j1939, SA);
-	} else if (PGN == pgn_value[PGN_REQUEST]) {
-		SAE_J1939_Send_Acknowledgement(j1939, SA, CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_SUPPORTED, GROUP_FUNCTION_VALUE_NORMAL, PGN);
-	} else if (PGN == pgn_value[PGN_TP_CM]) {
-		SAE_J1939_Send_Acknowledgement(j1939, SA, CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_SUPPORTED, GROUP_FUNCTION_VALUE_NORMAL, PGN);
-	} else if (PGN == pgn_value[PGN_TP_DT]) {
-		SAE_J1939_Send_Acknowledgement(j1939, SA, CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_SUPPORTED, GROUP_FUNCTION_VALUE_NORMAL, PGN);
-	} else if (PGN >= pgn_value[PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_0] && PGN <= pgn_value[PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_15]) {
-		ISO_11783_Response_Request_Auxiliary_Valve_Estimated_Flow(j1939, PGN & 0xF); /* PGN & 0xF = valve_number */
-	} else if (PGN == pgn_value[PGN_GENERAL_PURPOSE_VALVE_ESTIMATED_FLOW]){
-		ISO_11783_Response_Request_General_Purpose_Valve_Estimated_Flow(j1939, SA);
-	} else if (PGN >= pgn_value[PGN_AUXILIARY_VALVE_MEASURED_POSITION_0] && PGN <= pgn_value[PGN_AUXILIARY_VALVE_MEASURED_POSITION_15]) {
-		ISO_11783_Response_Request_Auxiliary_Valve_Measured_Position(j1939, PGN & 0xF); /* PGN & 0xF = valve_number */
-	} else if (PGN == pgn_value[PGN_SOFTWARE_IDENTIFICATION]) {
-		SAE_J1939_Response_Request_Software_Identification(j1939, SA);
-	} else if (PGN == pgn_value[PGN_ECU_IDENTIFICATION]) {
-		SAE_J1939_Response_Request_ECU_Identification(j1939, SA);
-	} else if (PGN == pgn_value[PGN_COMPONENT_IDENTIFICATION]) {
-		SAE_J1939_Response_Request_Component_Identification(j1939, SA);
-	} else {
+	bool is_answered = Check_Request_Limit(j1939, SA, PGN);
+	TRACE_EVENT(TRACE_EVENT_REQUEST_RECEIVED, PGN, SA, j1939->information_this_ECU.this_ECU_address, !is_answered);
+	if (is_answered)
+		Respond_Request(j1939, SA, PGN);
+}
+
+/*
+ * Set the minimum time in milliseconds between two responses to the same requester for a PGN. 0 turns off the rate limit for the PGN.
+ * Returns false if there is no room for more PGN
+ * PGN: 0x00EA00 (59904)
+ */
+bool SAE_J1939_Set_Request_Interval(J1939 *j1939, uint32_t PGN, uint16_t interval) {
+	struct Request_limiter *limiter = &j1939->this_request_limiter;
+	for (uint8_t i = 0; i < limiter->number_of_intervals; i++) {
+		if (limiter->intervals[i].PGN == PGN) {
+			limiter->intervals[i].interval = interval;
+			return true;
+		}
+	}
+	if (limiter->number_of_intervals >= MAX_REQUEST_INTERVALS)
+		return false;
+	limiter->intervals[limiter->number_of_intervals].PGN = PGN;
+	limiter->intervals[limiter->number_of_intervals++].interval = interval;
+	return true;
+}
+
+/*
+ * Answer the requests that came inside their interval, when the interval has passed
+ * PGN: 0x00EA00 (59904)
+ */
+void SAE_J1939_Check_Request_Limits(J1939 *j1939) {
+	uint32_t now = Clock_Get_Milliseconds();
+	for (uint8_t i = 0; i < MAX_REQUEST_LIMITS; i++) {
+		struct Request_limit *limit = &j1939->this_request_limiter.limits[i];
+		if (!limit->is_pending || now - limit->response_time < Get_Request_Interval(j1939, limit->PGN))
+			continue;
+		limit->is_pending = false;
+		limit->response_time = now;
+		Respond_Request(j1939, limit->SA, limit->PGN);
+	}
+}
+
+/* The functions that respond to a request. They are listed for every PGN in PGN_REGISTRY */
+static void Respond_Acknowledgement(J1939 *j1939, uint8_t SA, uint32_t PGN) {
+	SAE_J1939_Send_Acknowledgement(j1939, SA, CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_SUPPORTED, GROUP_FUNCTION_VALUE_NORMAL, PGN);
+}
+
+static void Respond_Address_Claimed(J1939 *j1939, uint8_t SA, uint32_t PGN) {
+	SAE_J1939_Response_Request_Address_Claimed(j1939);
+}
+
+static void Respond_DM1(J1939 *j1939, uint8_t SA, uint32_t PGN) {
+	SAE_J1939_Response_Request_DM1(j1939, SA);
+}
+
+static void Respond_DM2(J1939 *j1939, uint8_t SA, uint32_t PGN) {
+	SAE_J1939_Response_Request_DM2(j1939, SA);
+	SAE_J1939_Send_Acknowledgement(j1939, SA, CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_SUPPORTED, GROUP_FUNCTION_VALUE_NORMAL, PGN);
+}
+
+static void Respond_DM3(J1939 *j1939, uint8_t SA, uint32_t PGN) {
+	SAE_J1939_Response_Request_DM3(j1939, SA);
+}
+
+static void Respond_Auxiliary_Valve_Estimated_Flow(J1939 *j1939, uint8_t SA, uint32_t PGN) {
+	ISO_11783_Response_Request_Auxiliary_Valve_Estimated_Flow(j1939, PGN & 0xF); /* PGN & 0xF = valve_number */
+}
+
+static void Respond_General_Purpose_Valve_Estimated_Flow(J1939 *j1939, uint8_t SA, uint32_t PGN) {
+	ISO_11783_Response_Request_General_Purpose_Valve_Estimated_Flow(j1939, SA);
+}
+
+static void Respond_Auxiliary_Valve_Measured_Position(J1939 *j1939, uint8_t SA, uint32_t PGN) {
+	ISO_11783_Response_Request_Auxiliary_Valve_Measured_Position(j1939, PGN & 0xF); /* PGN & 0xF = valve_number */
+}
+
+static void Respond_Software_Identification(J1939 *j1939, uint8_t SA, uint32_t PGN) {
+	SAE_J1939_Response_Request_Software_Identification(j1939, SA);
+}
+
+static void Respond_ECU_Identification(J1939 *j1939, uint8_t SA, uint32_t PGN) {
+	SAE_J1939_Response_Request_ECU_Identification(j1939, SA);
+}
+
+static void Respond_Component_Identification(J1939 *j1939, uint8_t SA, uint32_t PGN) {
+	SAE_J1939_Response_Request_Component_Identification(j1939, SA);
+}
+
+/* The respond function of every PGN in PGN_REGISTRY - Add a new respond function to the registry in Enum_PGN.h */
+static void (*const respond_functions[PGN_QTY])(J1939 *j1939, uint8_t SA, uint32_t PGN) = {
+#define PGN_RESPOND(name, PGN, priority, respond, read) [PGN_##name] = respond,
+	PGN_REGISTRY(PGN_RESPOND)
+#undef PGN_RESPOND
+};
+
+static void Respond_Request(J1939 *j1939, uint8_t SA, uint32_t PGN) {
+	pgn_list_t pgn_index = Open_SAE_J1939_Find_PGN(PGN);
+	if (pgn_index == PGN_QTY || respond_functions[pgn_index] == NULL) {
 		SAE_J1939_Send_Acknowledgement(j1939, SA, CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_NOT_SUPPORTED, GROUP_FUNCTION_VALUE_NO_CAUSE, PGN);
+		TRACE_EVENT(TRACE_EVENT_REQUEST_ANSWERED, PGN, j1939->information_this_ECU.this_ECU_address, SA, 1);
+		return;
 	}
-	/* Add more else if statements here for more read request */
+	respond_functions[pgn_index](j1939, SA, PGN);
+	TRACE_EVENT(TRACE_EVENT_REQUEST_ANSWERED, PGN, j1939->information_this_ECU.this_ECU_address, SA, 0);
 }
 
 /*
@@ -16,11 +16,18 @@
 #include "../SAE_J1939_Enums/Enum_Group_Function_Value.h"
 #include "../SAE_J1939_Enums/Enum_NAME.h"
 #include "../SAE_J1939_Enums/Enum_PGN.h"
+#include "../SAE_J1939_Enums/Enum_Request_Status.h"
 #include "../SAE_J1939_Enums/Enum_Send_Status.h"
 
 /* Layers */
 #include "../../Hardware/Hardware.h"
 
+/* Transport Protocol timeouts in milliseconds according to SAE J1939-21 */
+#define TP_TIMEOUT_T1 750								/* Receiver - Time between two TP DT packages and from CTS to the first package */
+#define TP_TIMEOUT_T3 1250								/* Originator - Time from the last TP DT package or RTS to CTS or EndOfMsgACK */
+#define TP_TIMEOUT_T4 1050								/* Originator - Time from CTS that hold the connection open to the next CTS */
+#define TP_MAX_RETRANSMIT_REQUESTS 2					/* Receiver - CTS that ask again for missing packages after a timeout before the session is aborted */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -33,14 +40,37 @@ ENUM_J1939_STATUS_CODES SAE_J1939_Send_Acknowledgement(J1939 *j1939, uint8_t DA,
 /* Request */
 void SAE_J1939_Read_Request(J1939 *j1939, uint8_t SA, uint8_t data[]);
 ENUM_J1939_STATUS_CODES SAE_J1939_Send_Request(J1939 *j1939, uint8_t DA, uint32_t PGN_code);
+bool SAE_J1939_Set_Request_Interval(J1939 *j1939, uint32_t PGN, uint16_t interval);
+void SAE_J1939_Check_Request_Limits(J1939 *j1939);
+
+/* Pending Request */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Request_Async(J1939 *j1939, uint8_t DA, uint32_t PGN_code, uint16_t timeout, SAE_J1939_Request_Callback callback, void *context, uint16_t *handle);
+bool SAE_J1939_Cancel_Request(J1939 *j1939, uint16_t handle);
+void SAE_J1939_Complete_Pending_Request(J1939 *j1939, uint8_t SA, uint32_t PGN, uint8_t status, uint8_t group_function_value, const uint8_t data[], uint16_t length);
+void SAE_J1939_Check_Pending_Request_Timeout(J1939 *j1939);
 
 /* Transport Protocol Connection Management */
 void SAE_J1939_Read_Transport_Protocol_Connection_Management(J1939 *j1939, uint8_t SA, uint8_t data[]);
 ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_Connection_Management(J1939 *j1939, uint8_t DA);
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_Message(J1939 *j1939, uint8_t DA, uint32_t PGN, uint8_t data[], uint16_t total_message_size);
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_Clear_To_Send(J1939 *j1939);
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_End_Of_Message_Acknowledgement(J1939 *j1939, uint8_t DA, uint16_t total_message_size, uint8_t number_of_packages, uint32_t PGN);
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_Connection_Abort(J1939 *j1939, uint8_t DA, uint8_t abort_reason, uint32_t PGN);
+struct TP_CM *SAE_J1939_Get_Transport_Protocol_Transmit_Session(J1939 *j1939);
+void SAE_J1939_Check_Transport_Protocol_Timeout(J1939 *j1939);
+
+/* Transport Protocol Buffer Pool */
+uint8_t *SAE_J1939_Borrow_Transport_Protocol_Buffer(J1939 *j1939, uint16_t size);
+void SAE_J1939_Return_Transport_Protocol_Buffer(J1939 *j1939, uint8_t **buffer);
+uint8_t *SAE_J1939_Get_Transport_Protocol_Transmit_Buffer(J1939 *j1939, uint16_t size);
+uint8_t *SAE_J1939_Get_FD_Transport_Protocol_Transmit_Buffer(J1939 *j1939, uint16_t size);
 
 /* Transport Protocol Data Transfer */
+void SAE_J1939_Read_Transport_Protocol_Complete_Message(J1939 *j1939, uint8_t SA, uint32_t PGN, uint8_t complete_data[], uint16_t total_message_size);
 void SAE_J1939_Read_Transport_Protocol_Data_Transfer(J1939 *j1939, uint8_t SA, uint8_t data[]);
+void SAE_J1939_Read_Transport_Protocol_Data_Transfer_BAM(J1939 *j1939, uint8_t SA, uint8_t data[]);
 ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_Data_Transfer(J1939 *j1939, uint8_t DA);
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_Data_Transfer_Packages(J1939 *j1939, uint8_t DA, uint8_t next_package, uint8_t number_of_packages);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,80 @@
+/*
+ * Transport_Protocol_Buffer_Pool.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Transport_Layer.h"
+
+/* C standard library */
+#include <stddef.h>
+#include <string.h>
+
+/* Borrow a buffer from the pool that holds at least size bytes. The smallest block that fits is taken first. Returns NULL if every block that fits is borrowed */
+uint8_t *SAE_J1939_Borrow_Transport_Protocol_Buffer(J1939 *j1939, uint16_t size) {
+    struct TP_buffer_pool *pool = &j1939->this_tp_buffer_pool;
+    if (size <= TP_POOL_SMALL_BLOCK_SIZE) {
+        for (uint8_t i = 0; i < TP_POOL_SMALL_BLOCKS; i++) {
+            if (!pool->is_small_block_borrowed[i]) {
+                pool->is_small_block_borrowed[i] = true;
+                return pool->small_blocks[i];
+            }
+        }
+    }
+    if (size <= TP_POOL_LARGE_BLOCK_SIZE) {
+        for (uint8_t i = 0; i < TP_POOL_LARGE_BLOCKS; i++) {
+            if (!pool->is_large_block_borrowed[i]) {
+                pool->is_large_block_borrowed[i] = true;
+                return pool->large_blocks[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Give a borrowed buffer back to the pool and set the pointer to NULL. Nothing happens if the pointer is already NULL */
+void SAE_J1939_Return_Transport_Protocol_Buffer(J1939 *j1939, uint8_t **buffer) {
+    struct TP_buffer_pool *pool = &j1939->this_tp_buffer_pool;
+    if (*buffer == NULL)
+        return;
+    for (uint8_t i = 0; i < TP_POOL_SMALL_BLOCKS; i++)
+        if (*buffer == pool->small_blocks[i])
+            pool->is_small_block_borrowed[i] = false;
+    for (uint8_t i = 0; i < TP_POOL_LARGE_BLOCKS; i++)
+        if (*buffer == pool->large_blocks[i])
+            pool->is_large_block_borrowed[i] = false;
+    *buffer = NULL;
+}
+
+/* Internal functions */
+static uint8_t *Get_Transmit_Buffer(J1939 *j1939, struct TP_CM *tp_cm, struct TP_DT *tp_dt, uint16_t size) {
+    if (tp_cm->timeout > 0)
+        return NULL;
+    if (tp_dt->data != NULL && tp_dt->data_size >= size)
+        return tp_dt->data;
+    uint8_t *buffer = SAE_J1939_Borrow_Transport_Protocol_Buffer(j1939, size);
+    if (buffer == NULL)
+        return NULL;
+    if (tp_dt->data != NULL)
+        memcpy(buffer, tp_dt->data, tp_dt->data_size);
+    SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &tp_dt->data);
+    tp_dt->data = buffer;
+    tp_dt->data_size = size;
+    return buffer;
+}
+
+/*
+ * Get the transmit buffer of this ECU with room for size bytes, so a message can be built directly in it and then be sent with SAE_J1939_Send_Transport_Protocol_Message.
+ * What is already in the buffer is kept if a larger block is needed. Returns NULL if a session is sending or if no block is free. On a CAN FD bus it is the buffer of the FD Transport Protocol
+ */
+uint8_t *SAE_J1939_Get_Transport_Protocol_Transmit_Buffer(J1939 *j1939, uint16_t size) {
+    if (j1939->is_CAN_FD)
+        return SAE_J1939_Get_FD_Transport_Protocol_Transmit_Buffer(j1939, size);
+    return Get_Transmit_Buffer(j1939, &j1939->this_ecu_tp_cm, &j1939->this_ecu_tp_dt, size);
+}
+
+/* Same as SAE_J1939_Get_Transport_Protocol_Transmit_Buffer, but always for the FD Transport Protocol */
+uint8_t *SAE_J1939_Get_FD_Transport_Protocol_Transmit_Buffer(J1939 *j1939, uint16_t size) {
+    return Get_Transmit_Buffer(j1939, &j1939->this_ecu_fd_tp_cm, &j1939->this_ecu_fd_tp_dt, size);
+}
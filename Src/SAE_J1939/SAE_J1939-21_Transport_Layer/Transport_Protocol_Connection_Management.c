@@ -7,27 +7,166 @@
 
 #include "Transport_Layer.h"
 
+/* Layers */
+#include "../SAE_J1939-22_FD_Transport_Layer/FD_Transport_Layer.h"
+
+/* The C standard library */
+#include <string.h>
+
+/* Internal functions */
+/* Byte 1 to 4 depends on the control byte. The PGN of the packeted message is always in byte 5 to 7 */
+static ENUM_J1939_STATUS_CODES Send_Connection_Management(J1939 *j1939, uint8_t DA, uint8_t control_byte, uint8_t byte1, uint8_t byte2, uint8_t byte3, uint8_t byte4, uint32_t PGN) {
+	uint32_t ID = (0x1CEC << 16) | (DA << 8) | j1939->information_this_ECU.this_ECU_address;
+	uint8_t data[8];
+	data[0] = control_byte;
+	data[1] = byte1;
+	data[2] = byte2;
+	data[3] = byte3;
+	data[4] = byte4;
+	data[5] = PGN;
+	data[6] = PGN >> 8;
+	data[7] = PGN >> 16;
+	return CAN_Send_Message(ID, data);
+}
+
+static void Start_Session(struct TP_CM *tp_cm, uint16_t timeout) {
+	tp_cm->time_stamp = Clock_Get_Milliseconds();
+	tp_cm->timeout = timeout;
+}
+
+static void Close_Receive_Session(J1939 *j1939) {
+	SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &j1939->from_other_ecu_tp_dt.data);
+	memset(&j1939->from_other_ecu_tp_dt, 0, sizeof(j1939->from_other_ecu_tp_dt));
+	memset(&j1939->from_other_ecu_tp_cm, 0, sizeof(j1939->from_other_ecu_tp_cm));
+}
+
+static void Close_Transmit_Session(J1939 *j1939) {
+	j1939->this_ecu_tp_cm.timeout = 0;
+	SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &j1939->this_ecu_tp_dt.data);
+}
+
+/* A new BAM from the same ECU replaces the old one. Returns false if every session is taken or no buffer is free for the message */
+static bool Open_BAM_Session(J1939 *j1939, uint8_t SA, uint16_t total_message_size, uint8_t number_of_packages, uint32_t PGN) {
+	if(total_message_size > TP_MAX_MESSAGE_SIZE || number_of_packages == 0 || number_of_packages != (total_message_size + 6) / 7)
+		return false;
+	struct BAM_session *bam = NULL;
+	for(uint8_t i = 0; i < MAX_BAM_SESSIONS; i++){
+		struct BAM_session *session = &j1939->from_other_ecu_bam[i];
+		if(session->tp_cm.timeout > 0 && session->tp_cm.from_ecu_address == SA){
+			bam = session;
+			break;
+		}
+		if(session->tp_cm.timeout == 0 && bam == NULL)
+			bam = session;
+	}
+	if(bam == NULL)
+		return false;
+	memset(&bam->tp_cm, 0, sizeof(bam->tp_cm));
+	SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &bam->data);
+	bam->data = SAE_J1939_Borrow_Transport_Protocol_Buffer(j1939, total_message_size);
+	if(bam->data == NULL)
+		return false;
+	bam->tp_cm.control_byte = CONTROL_BYTE_TP_CM_BAM;
+	bam->tp_cm.total_message_size = total_message_size;
+	bam->tp_cm.number_of_packages = number_of_packages;
+	bam->tp_cm.PGN_of_the_packeted_message = PGN;
+	bam->tp_cm.from_ecu_address = SA;
+	bam->next_sequence_number = 1;
+	Start_Session(&bam->tp_cm, TP_TIMEOUT_T1);
+	TRACE_EVENT(TRACE_EVENT_TP_RECEIVE_OPEN, PGN, SA, 0xFF, number_of_packages);
+	return true;
+}
+
+static bool Is_Package_Received(struct TP_DT *tp_dt, uint16_t sequence_number) {
+	uint8_t index = sequence_number - 1;
+	return (tp_dt->received_packages[index >> 3] >> (index & 7)) & 1;
+}
+
+/* The control byte is left as abort, so the sender can see afterwards that the message never arrived */
+static void Abort_Transmit_Session(J1939 *j1939) {
+	j1939->this_ecu_tp_cm.control_byte = CONTROL_BYTE_TP_CM_ABORT;
+	Close_Transmit_Session(j1939);
+}
+
 /*
  * Store information about sequence data packages from other ECU who are going to send to this ECU
  * PGN: 0x00EC00 (60416)
  */
 void SAE_J1939_Read_Transport_Protocol_Connection_Management(J1939 *j1939, uint8_t SA, uint8_t data[]) {
-	j1939->from_other_ecu_tp_cm.control_byte = data[0];
-	j1939->from_other_ecu_tp_cm.total_message_size = (data[2] << 8) | data[1];
-	j1939->from_other_ecu_tp_cm.number_of_packages = data[3];
-	j1939->from_other_ecu_tp_cm.PGN_of_the_packeted_message = (data[7] << 16) | (data[6] << 8) | data[5];
-	j1939->from_other_ecu_tp_cm.from_ecu_address = SA;
+	uint8_t control_byte = data[0];
+	uint16_t total_message_size = (data[2] << 8) | data[1];
+	uint32_t PGN = (data[7] << 16) | (data[6] << 8) | data[5];
+	struct TP_CM *rx = &j1939->from_other_ecu_tp_cm;
+	struct TP_CM *tx = &j1939->this_ecu_tp_cm;
 
-	/* Check if we got the Request To Send control byte - We need to answer with CTS - Clear To Send */
-	if(j1939->from_other_ecu_tp_cm.control_byte == CONTROL_BYTE_TP_CM_RTS){
-		j1939->this_ecu_tp_cm = j1939->from_other_ecu_tp_cm; 			/* Copy - We need to have the same data */
-		j1939->this_ecu_tp_cm.control_byte = CONTROL_BYTE_TP_CM_CTS;	/* We only need to change the control byte from RTS to CTS */
-		SAE_J1939_Send_Transport_Protocol_Connection_Management(j1939, SA);
-	}
+	switch(control_byte){
+	case CONTROL_BYTE_TP_CM_BAM:
+		/* Nobody answers a BAM, so a BAM that cannot be received is only dropped */
+		if(!Open_BAM_Session(j1939, SA, total_message_size, data[3], PGN))
+			TRACE_EVENT(TRACE_EVENT_TP_BAM_DROPPED, PGN, SA, 0xFF, GROUP_FUNCTION_VALUE_LACKING_NECESSARY_RESOURCES);
+		break;
+	case CONTROL_BYTE_TP_CM_RTS:
+		/* A new RTS from the same ECU replaces the old session. Other ECU must wait until the open session is done */
+		if(rx->timeout > 0 && rx->from_ecu_address != SA){
+			SAE_J1939_Send_Transport_Protocol_Connection_Abort(j1939, SA, GROUP_FUNCTION_VALUE_CANNOT_MAINTAIN_ANOTHER_CONNECTION, PGN);
+			return;
+		}
+		if(total_message_size > TP_MAX_MESSAGE_SIZE){
+			SAE_J1939_Send_Transport_Protocol_Connection_Abort(j1939, SA, GROUP_FUNCTION_VALUE_TOTAL_MESSAGE_SIZE_TOO_LARGE, PGN);
+			return;
+		}
+		if(data[3] == 0 || data[3] != (total_message_size + 6) / 7){
+			SAE_J1939_Send_Transport_Protocol_Connection_Abort(j1939, SA, GROUP_FUNCTION_VALUE_NO_CAUSE, PGN);
+			return;
+		}
+		Close_Receive_Session(j1939);
+		j1939->from_other_ecu_tp_dt.data = SAE_J1939_Borrow_Transport_Protocol_Buffer(j1939, total_message_size);
+		if(j1939->from_other_ecu_tp_dt.data == NULL){
+			SAE_J1939_Send_Transport_Protocol_Connection_Abort(j1939, SA, GROUP_FUNCTION_VALUE_LACKING_NECESSARY_RESOURCES, PGN);
+			return;
+		}
+		rx->control_byte = control_byte;
+		rx->total_message_size = total_message_size;
+		rx->number_of_packages = data[3];
+		rx->PGN_of_the_packeted_message = PGN;
+		rx->from_ecu_address = SA;
+		j1939->from_other_ecu_tp_dt.max_packages_per_CTS = data[4];
+		TRACE_EVENT(TRACE_EVENT_TP_RECEIVE_OPEN, PGN, SA, j1939->information_this_ECU.this_ECU_address, data[3]);
 
-	/* When we answer with CTS, it means we are going to send the Transport Protocol Data Transfer package */
-	if(j1939->from_other_ecu_tp_cm.control_byte == CONTROL_BYTE_TP_CM_CTS)
-		SAE_J1939_Send_Transport_Protocol_Data_Transfer(j1939, SA);
+		/* We need to answer with CTS - Clear To Send */
+		SAE_J1939_Send_Transport_Protocol_Clear_To_Send(j1939);
+		break;
+	case CONTROL_BYTE_TP_CM_CTS:
+		/* Only the ECU we have sent RTS to can give us a CTS */
+		if(tx->timeout == 0 || tx->to_ecu_address != SA)
+			return;
+		if(data[1] == 0){
+			Start_Session(tx, TP_TIMEOUT_T4);						/* The other ECU want us to hold the connection open */
+			return;
+		}
+		/* The other ECU tells how many packages it can take and from which package - It can ask again for packages that it missed */
+		if(data[2] == 0 || data[2] + data[1] - 1 > tx->number_of_packages){
+			SAE_J1939_Send_Transport_Protocol_Connection_Abort(j1939, SA, GROUP_FUNCTION_VALUE_BAD_SEQUENCE_NUMBER, tx->PGN_of_the_packeted_message);
+			Abort_Transmit_Session(j1939);
+			return;
+		}
+		SAE_J1939_Send_Transport_Protocol_Data_Transfer_Packages(j1939, SA, data[2], data[1]);
+		Start_Session(tx, TP_TIMEOUT_T3);
+		break;
+	case CONTROL_BYTE_TP_CM_EndOfMsgACK:
+		if(tx->timeout > 0 && tx->to_ecu_address == SA){
+			TRACE_EVENT(TRACE_EVENT_TP_TRANSMIT_COMPLETE, tx->PGN_of_the_packeted_message, j1939->information_this_ECU.this_ECU_address, SA, tx->number_of_packages);
+			Close_Transmit_Session(j1939);
+		}
+		break;
+	case CONTROL_BYTE_TP_CM_ABORT:
+		TRACE_EVENT(TRACE_EVENT_TP_ABORT_RECEIVED, PGN, SA, j1939->information_this_ECU.this_ECU_address, data[1]);
+		if(tx->timeout > 0 && tx->to_ecu_address == SA && tx->PGN_of_the_packeted_message == PGN)
+			Abort_Transmit_Session(j1939);
+		if(rx->timeout > 0 && rx->from_ecu_address == SA && rx->PGN_of_the_packeted_message == PGN)
+			Close_Receive_Session(j1939);
+		break;
+	}
 }
 
 /*
@@ -35,15 +174,137 @@ void SAE_J1939_Read_Transport_Protocol_Connection_Management(J1939 *j1939, uint8
  * PGN: 0x00EC00 (60416)
  */
 ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_Connection_Management(J1939 *j1939, uint8_t DA) {
-	uint32_t ID = (0x1CEC << 16) | (DA << 8) | j1939->information_this_ECU.this_ECU_address;
-	uint8_t data[8];
-	data[0] = j1939->this_ecu_tp_cm.control_byte;
-	data[1] = j1939->this_ecu_tp_cm.total_message_size;
-	data[2] = j1939->this_ecu_tp_cm.total_message_size >> 8;
-	data[3] = j1939->this_ecu_tp_cm.number_of_packages;
-	data[4] = 0xFF; 															/* Reserved */
-	data[5] = j1939->this_ecu_tp_cm.PGN_of_the_packeted_message;
-	data[6] = j1939->this_ecu_tp_cm.PGN_of_the_packeted_message >> 8;
-	data[7] = j1939->this_ecu_tp_cm.PGN_of_the_packeted_message >> 16;
-	return CAN_Send_Message(ID, data);
+	struct TP_CM *tx = &j1939->this_ecu_tp_cm;
+
+	/* A RTS opens a session that waits for CTS from the other ECU */
+	if(tx->control_byte == CONTROL_BYTE_TP_CM_RTS){
+		tx->to_ecu_address = DA;
+		Start_Session(tx, TP_TIMEOUT_T3);
+	}
+	TRACE_EVENT(TRACE_EVENT_TP_TRANSMIT_OPEN, tx->PGN_of_the_packeted_message, j1939->information_this_ECU.this_ECU_address, DA, tx->number_of_packages);
+	return Send_Connection_Management(j1939, DA, tx->control_byte, tx->total_message_size, tx->total_message_size >> 8, tx->number_of_packages, 0xFF, tx->PGN_of_the_packeted_message);
+}
+
+/*
+ * Load a message larger than 8 bytes into the Transport Protocol of this ECU and send it to other ECU. On a CAN FD bus the FD Transport Protocol sends it.
+ * If DA is broadcast, the data is sent directly with BAM. Else RTS is sent and the data is sent when the other ECU answer with CTS
+ * PGN: 0x00EC00 (60416)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_Message(J1939 *j1939, uint8_t DA, uint32_t PGN, uint8_t data[], uint16_t total_message_size) {
+	/* A CAN FD bus takes 60 bytes in every segment */
+	if(j1939->is_CAN_FD)
+		return SAE_J1939_Send_FD_Transport_Protocol_Message(j1939, DA, PGN, data, total_message_size);
+	if(total_message_size > TP_MAX_MESSAGE_SIZE)
+		return STATUS_SEND_ERROR;
+
+	/* Only one session at the time - Wait until the other ECU has answered with EndOfMsgACK, abort or timeout. The pool can also be empty until other sessions are done */
+	uint8_t *buffer = SAE_J1939_Get_Transport_Protocol_Transmit_Buffer(j1939, total_message_size);
+	if(buffer == NULL)
+		return STATUS_SEND_BUSY;
+
+	/* Multiple messages - Load data. data can already be in the buffer */
+	memmove(buffer, data, total_message_size);
+	j1939->this_ecu_tp_cm.total_message_size = total_message_size;
+	j1939->this_ecu_tp_cm.number_of_packages = total_message_size % 7 > 0 ? total_message_size/7 + 1 : total_message_size/7; /* Rounding up - Every package holds 7 bytes of data */
+	j1939->this_ecu_tp_cm.PGN_of_the_packeted_message = PGN;
+	j1939->this_ecu_tp_cm.control_byte = DA == 0xFF ? CONTROL_BYTE_TP_CM_BAM : CONTROL_BYTE_TP_CM_RTS; /* If broadcast, then use BAM control byte */
+
+	/* Send TP CM */
+	ENUM_J1939_STATUS_CODES status = SAE_J1939_Send_Transport_Protocol_Connection_Management(j1939, DA);
+	if(status != STATUS_SEND_OK){
+		Close_Transmit_Session(j1939);
+		return status;
+	}
+
+	/* Check if we are going to send it directly (BAM) - Else, the TP CM will send a RTS control byte to the other ECU and the ECU will answer with control byte CTS */
+	if(j1939->this_ecu_tp_cm.control_byte == CONTROL_BYTE_TP_CM_BAM){
+		status = SAE_J1939_Send_Transport_Protocol_Data_Transfer(j1939, DA);
+		if(status == STATUS_SEND_OK)
+			TRACE_EVENT(TRACE_EVENT_TP_TRANSMIT_COMPLETE, PGN, j1939->information_this_ECU.this_ECU_address, DA, j1939->this_ecu_tp_cm.number_of_packages);
+		Close_Transmit_Session(j1939);
+	}
+	return status;
+}
+
+/* The transmit session that SAE_J1939_Send_Transport_Protocol_Message uses - The FD Transport Protocol on a CAN FD bus */
+struct TP_CM *SAE_J1939_Get_Transport_Protocol_Transmit_Session(J1939 *j1939) {
+	return j1939->is_CAN_FD ? &j1939->this_ecu_fd_tp_cm : &j1939->this_ecu_tp_cm;
+}
+
+/*
+ * Send a connection abort to the other ECU
+ * PGN: 0x00EC00 (60416)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_Connection_Abort(J1939 *j1939, uint8_t DA, uint8_t abort_reason, uint32_t PGN) {
+	TRACE_EVENT(TRACE_EVENT_TP_ABORT_SENT, PGN, j1939->information_this_ECU.this_ECU_address, DA, abort_reason);
+	return Send_Connection_Management(j1939, DA, CONTROL_BYTE_TP_CM_ABORT, abort_reason, 0xFF, 0xFF, 0xFF, PGN);
+}
+
+/*
+ * Ask the other ECU for the first packages that are still missing. The first CTS asks from package 1. Nothing is sent if every package has arrived
+ * PGN: 0x00EC00 (60416)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_Clear_To_Send(J1939 *j1939) {
+	struct TP_CM *rx = &j1939->from_other_ecu_tp_cm;
+	struct TP_DT *tp_dt = &j1939->from_other_ecu_tp_dt;
+	uint16_t next_package = 1;
+	while(next_package <= rx->number_of_packages && Is_Package_Received(tp_dt, next_package))
+		next_package++;
+	if(next_package > rx->number_of_packages)
+		return STATUS_SEND_OK;
+
+	/* Ask for the missing packages in a row, but not more than the other ECU can send after one CTS */
+	uint8_t max_packages = tp_dt->max_packages_per_CTS == 0 ? 0xFF : tp_dt->max_packages_per_CTS;
+	uint8_t number_of_packages = 0;
+	while(number_of_packages < max_packages && next_package + number_of_packages <= rx->number_of_packages && !Is_Package_Received(tp_dt, next_package + number_of_packages))
+		number_of_packages++;
+	tp_dt->last_requested_package = next_package + number_of_packages - 1;
+	Start_Session(rx, TP_TIMEOUT_T1);										/* T1 and not T2 of SAE J1939-21, so a lost CTS can be sent again before the other ECU gives up after T3 */
+	return Send_Connection_Management(j1939, rx->from_ecu_address, CONTROL_BYTE_TP_CM_CTS, number_of_packages, next_package, 0xFF, 0xFF, rx->PGN_of_the_packeted_message);
+}
+
+/*
+ * Tell the other ECU that the whole message has been received
+ * PGN: 0x00EC00 (60416)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_End_Of_Message_Acknowledgement(J1939 *j1939, uint8_t DA, uint16_t total_message_size, uint8_t number_of_packages, uint32_t PGN) {
+	return Send_Connection_Management(j1939, DA, CONTROL_BYTE_TP_CM_EndOfMsgACK, total_message_size, total_message_size >> 8, number_of_packages, 0xFF, PGN);
+}
+
+/*
+ * Abort the sessions that have been quiet for too long. BAM is only dropped because nobody is waiting for an answer
+ * This is called from Open_SAE_J1939_Listen_For_Messages, so it needs no own thread
+ */
+void SAE_J1939_Check_Transport_Protocol_Timeout(J1939 *j1939) {
+	uint32_t now = Clock_Get_Milliseconds();
+	struct TP_CM *rx = &j1939->from_other_ecu_tp_cm;
+	struct TP_CM *tx = &j1939->this_ecu_tp_cm;
+
+	/* Receive session - Ask again for the missing packages before we give up */
+	if(rx->timeout > 0 && (uint32_t)(now - rx->time_stamp) >= rx->timeout){
+		struct TP_DT *tp_dt = &j1939->from_other_ecu_tp_dt;
+		if(tp_dt->number_of_retransmit_requests < TP_MAX_RETRANSMIT_REQUESTS){
+			tp_dt->number_of_retransmit_requests++;
+			SAE_J1939_Send_Transport_Protocol_Clear_To_Send(j1939);
+		}else{
+			SAE_J1939_Send_Transport_Protocol_Connection_Abort(j1939, rx->from_ecu_address, GROUP_FUNCTION_VALUE_MAXIMUM_RETRANSMIT_REQUEST_REACHED, rx->PGN_of_the_packeted_message);
+			Close_Receive_Session(j1939);
+		}
+	}
+
+	/* BAM sessions - The time between two packages is T1 */
+	for(uint8_t i = 0; i < MAX_BAM_SESSIONS; i++){
+		struct BAM_session *bam = &j1939->from_other_ecu_bam[i];
+		if(bam->tp_cm.timeout > 0 && (uint32_t)(now - bam->tp_cm.time_stamp) >= bam->tp_cm.timeout){
+			bam->tp_cm.timeout = 0;
+			SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &bam->data);
+			TRACE_EVENT(TRACE_EVENT_TP_BAM_DROPPED, bam->tp_cm.PGN_of_the_packeted_message, bam->tp_cm.from_ecu_address, 0xFF, GROUP_FUNCTION_VALUE_ABORT_TIME_OUT);
+		}
+	}
+
+	/* Transmit session */
+	if(tx->timeout > 0 && (uint32_t)(now - tx->time_stamp) >= tx->timeout){
+		SAE_J1939_Send_Transport_Protocol_Connection_Abort(j1939, tx->to_ecu_address, GROUP_FUNCTION_VALUE_ABORT_TIME_OUT, tx->PGN_of_the_packeted_message);
+		Abort_Transmit_Session(j1939);
+	}
 }
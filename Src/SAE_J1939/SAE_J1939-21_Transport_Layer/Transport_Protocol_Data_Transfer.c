@@ -12,65 +12,139 @@
 #include "../SAE_J1939-73_Diagnostics_Layer/Diagnostics_Layer.h"
 #include "../SAE_J1939-71_Application_Layer/Application_Layer.h"
 
+/* The functions that read a complete message. They are listed for every PGN in PGN_REGISTRY that this ECU reads from the Transport Protocol */
+static void Read_Commanded_Address(J1939 *j1939, uint8_t SA, uint8_t complete_data[], uint16_t total_message_size) {
+    SAE_J1939_Read_Commanded_Address(j1939, complete_data);                                 /* Insert new name and new address to this ECU */
+}
+
+static void Read_DM1(J1939 *j1939, uint8_t SA, uint8_t complete_data[], uint16_t total_message_size) {
+    SAE_J1939_Read_Response_Request_DM1(j1939, SA, complete_data, complete_data[8]);        /* Sequence number is the last index */
+}
+
+static void Read_DM2(J1939 *j1939, uint8_t SA, uint8_t complete_data[], uint16_t total_message_size) {
+    SAE_J1939_Read_Response_Request_DM2(j1939, SA, complete_data, complete_data[8]);        /* Sequence number is the last index */
+}
+
+static void Read_DM16(J1939 *j1939, uint8_t SA, uint8_t complete_data[], uint16_t total_message_size) {
+    SAE_J1939_Read_Binary_Data_Transfer_DM16(j1939, SA, complete_data, total_message_size);
+}
+
+static void Read_Software_Identification(J1939 *j1939, uint8_t SA, uint8_t complete_data[], uint16_t total_message_size) {
+    SAE_J1939_Read_Response_Request_Software_Identification(j1939, SA, complete_data);
+}
+
+static void Read_ECU_Identification(J1939 *j1939, uint8_t SA, uint8_t complete_data[], uint16_t total_message_size) {
+    SAE_J1939_Read_Response_Request_ECU_Identification(j1939, SA, complete_data);
+}
+
+static void Read_Component_Identification(J1939 *j1939, uint8_t SA, uint8_t complete_data[], uint16_t total_message_size) {
+    SAE_J1939_Read_Response_Request_Component_Identification(j1939, SA, complete_data);
+}
+
+/* The read function of every PGN in PGN_REGISTRY - Add a new read function to the registry in Enum_PGN.h */
+static void (*const read_functions[PGN_QTY])(J1939 *j1939, uint8_t SA, uint8_t complete_data[], uint16_t total_message_size) = {
+#define PGN_READ(name, PGN, priority, respond, read) [PGN_##name] = read,
+    PGN_REGISTRY(PGN_READ)
+#undef PGN_READ
+};
+
+/* Check what type of function that message want this ECU to do. The FD Transport Protocol gives its complete messages here too */
+void SAE_J1939_Read_Transport_Protocol_Complete_Message(J1939 *j1939, uint8_t SA, uint32_t PGN, uint8_t complete_data[], uint16_t total_message_size) {
+    pgn_list_t pgn_index = Open_SAE_J1939_Find_PGN(PGN);
+    if (pgn_index != PGN_QTY && read_functions[pgn_index] != NULL)
+        read_functions[pgn_index](j1939, SA, complete_data, total_message_size);
+
+    /* Give the complete message to the request that is waiting for it */
+    SAE_J1939_Complete_Pending_Request(j1939, SA, PGN, REQUEST_STATUS_RESPONSE, GROUP_FUNCTION_VALUE_NORMAL, complete_data, total_message_size);
+}
+
 /*
  * Store the sequence data packages from other ECU
  * PGN: 0x00EB00 (60160)
  */
 void SAE_J1939_Read_Transport_Protocol_Data_Transfer(J1939 *j1939, uint8_t SA, uint8_t data[]) {
-    /* Save the sequence data */
-    j1939->from_other_ecu_tp_dt.sequence_number = data[0];
-    j1939->from_other_ecu_tp_dt.from_ecu_address = SA;
+    struct TP_CM *tp_cm = &j1939->from_other_ecu_tp_cm;
+    struct TP_DT *tp_dt = &j1939->from_other_ecu_tp_dt;
+
+    /* Only accept packages from the ECU that has an open session with this ECU */
+    if (tp_cm->timeout == 0 || tp_cm->from_ecu_address != SA)
+        return;
+    if (data[0] == 0 || data[0] > tp_cm->number_of_packages)
+        return;
+
+    /* A package that has already arrived is ignored - The first copy is kept */
     uint8_t index = data[0] - 1;
-    for (uint8_t i = 1; i < 8; i++)
-        j1939->from_other_ecu_tp_dt.data[index * 7 + i - 1] = data[i]; /* For every package, we send 7 bytes of data where the first byte data[0] is the sequence number */
+    uint8_t bit = 1 << (index & 7);
+    if (tp_dt->received_packages[index >> 3] & bit)
+        return;
+    tp_dt->received_packages[index >> 3] |= bit;
+    tp_dt->number_of_received_packages++;
+    tp_dt->number_of_retransmit_requests = 0;
+    tp_cm->time_stamp = Clock_Get_Milliseconds();
+    tp_cm->timeout = TP_TIMEOUT_T1;
 
-    /* Check if we have completed our message - Return = Not completed */
-    if (j1939->from_other_ecu_tp_cm.number_of_packages != j1939->from_other_ecu_tp_dt.sequence_number || j1939->from_other_ecu_tp_cm.number_of_packages == 0)
+    /* Save the sequence data. For every package, we send 7 bytes of data where the first byte data[0] is the sequence number */
+    tp_dt->sequence_number = data[0];
+    tp_dt->from_ecu_address = SA;
+    uint16_t offset = index * 7;
+    for (uint8_t i = 0; i < 7 && offset + i < tp_cm->total_message_size; i++)
+        tp_dt->data[offset + i] = data[i + 1];
+
+    /* Check if we have completed our message - When the last package of the CTS has arrived, ask for the packages that are missing */
+    if (tp_dt->number_of_received_packages < tp_cm->number_of_packages) {
+        if (data[0] >= tp_dt->last_requested_package)
+            SAE_J1939_Send_Transport_Protocol_Clear_To_Send(j1939);
         return;
+    }
 
-    /* Our message are complete - Build it and call it complete_data[total_message_size] */
-    uint32_t PGN = j1939->from_other_ecu_tp_cm.PGN_of_the_packeted_message;
-    uint16_t total_message_size = j1939->from_other_ecu_tp_cm.total_message_size;
-    uint8_t complete_data[total_message_size];
-    uint16_t inserted_bytes = 0;
-    for (uint8_t i = 0; i < j1939->from_other_ecu_tp_dt.sequence_number; i++)
-        for (uint8_t j = 0; j < 7; j++)
-            if (inserted_bytes < total_message_size)
-                complete_data[inserted_bytes++] = j1939->from_other_ecu_tp_dt.data[i * 7 + j];
+    /* Our message are complete - Send an end of message ACK back */
+    uint32_t PGN = tp_cm->PGN_of_the_packeted_message;
+    uint16_t total_message_size = tp_cm->total_message_size;
+    TRACE_EVENT(TRACE_EVENT_TP_RECEIVE_COMPLETE, PGN, SA, j1939->information_this_ECU.this_ECU_address, tp_cm->number_of_packages);
+    if (tp_cm->control_byte == CONTROL_BYTE_TP_CM_RTS)
+        SAE_J1939_Send_Transport_Protocol_End_Of_Message_Acknowledgement(j1939, SA, total_message_size, tp_cm->number_of_packages, PGN);
 
-    /* Send an end of message ACK back */
-    if (j1939->from_other_ecu_tp_cm.control_byte == CONTROL_BYTE_TP_CM_RTS)
-        SAE_J1939_Send_Acknowledgement(j1939, SA, CONTROL_BYTE_TP_CM_EndOfMsgACK, GROUP_FUNCTION_VALUE_NORMAL, PGN);
+    /* Delete TP DT and TP CM, but keep the buffer until the message has been read. Then the buffer goes back to the pool */
+    uint8_t *complete_data = tp_dt->data;
+    memset(tp_dt, 0, sizeof(*tp_dt));
+    memset(tp_cm, 0, sizeof(*tp_cm));
+    SAE_J1939_Read_Transport_Protocol_Complete_Message(j1939, SA, PGN, complete_data, total_message_size);
+    SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &complete_data);
+}
 
-    /* Check what type of function that message want this ECU to do */
+/*
+ * Store the sequence data packages that other ECU broadcast with BAM. Every broadcasting ECU has its own session, so BAM from many ECU can be received at the same time
+ * PGN: 0x00EB00 (60160)
+ */
+void SAE_J1939_Read_Transport_Protocol_Data_Transfer_BAM(J1939 *j1939, uint8_t SA, uint8_t data[]) {
+    struct BAM_session *bam = NULL;
+    for (uint8_t i = 0; i < MAX_BAM_SESSIONS && bam == NULL; i++)
+        if (j1939->from_other_ecu_bam[i].tp_cm.timeout > 0 && j1939->from_other_ecu_bam[i].tp_cm.from_ecu_address == SA)
+            bam = &j1939->from_other_ecu_bam[i];
+    if (bam == NULL)
+        return;
 
-    if (pgn_value[PGN_COMMANDED_ADDRESS] == PGN) {
-        SAE_J1939_Read_Commanded_Address(j1939, complete_data);                             /* Insert new name and new address to this ECU */
-    }
-    else if (pgn_value[PGN_DM1] == PGN) {
-        SAE_J1939_Read_Response_Request_DM1(j1939, SA, complete_data, complete_data[8]);    /* Sequence number is the last index */
-    }
-    else if (pgn_value[PGN_DM2] == PGN) {
-        SAE_J1939_Read_Response_Request_DM2(j1939, SA, complete_data, complete_data[8]);    /* Sequence number is the last index */
-    }
-    else if (pgn_value[PGN_DM16] == PGN) {
-        SAE_J1939_Read_Binary_Data_Transfer_DM16(j1939, SA, complete_data);
-    }
-    else if (pgn_value[PGN_SOFTWARE_IDENTIFICATION] == PGN) {
-        SAE_J1939_Read_Response_Request_Software_Identification(j1939, SA, complete_data);
-    }
-    else if (pgn_value[PGN_ECU_IDENTIFICATION] == PGN) {
-        SAE_J1939_Read_Response_Request_ECU_Identification(j1939, SA, complete_data);
-    }
-    else if (pgn_value[PGN_COMPONENT_IDENTIFICATION] == PGN) {
-        SAE_J1939_Read_Response_Request_Component_Identification(j1939, SA, complete_data);
+    /* There is no retransmission with BAM - A package that is missing, repeated or in wrong order makes the message useless */
+    if (data[0] != bam->next_sequence_number) {
+        TRACE_EVENT(TRACE_EVENT_TP_BAM_DROPPED, bam->tp_cm.PGN_of_the_packeted_message, SA, 0xFF, GROUP_FUNCTION_VALUE_BAD_SEQUENCE_NUMBER);
+        bam->tp_cm.timeout = 0;
+        SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &bam->data);
+        return;
     }
-    /* Add more here */
-
+    bam->tp_cm.time_stamp = Clock_Get_Milliseconds();
+    uint16_t offset = (data[0] - 1) * 7;
+    for (uint8_t i = 0; i < 7 && offset + i < bam->tp_cm.total_message_size; i++)
+        bam->data[offset + i] = data[i + 1];
+    if (bam->next_sequence_number++ < bam->tp_cm.number_of_packages)
+        return;
 
-    /* Delete TP DT and TP CM */
-    memset(&j1939->from_other_ecu_tp_dt, 0, sizeof(j1939->from_other_ecu_tp_dt));
-    memset(&j1939->from_other_ecu_tp_cm, 0, sizeof(j1939->from_other_ecu_tp_cm));
+    /* Complete - Free the session before the message is read, so the same ECU can start a new BAM from the callbacks. Then the buffer goes back to the pool */
+    TRACE_EVENT(TRACE_EVENT_TP_RECEIVE_COMPLETE, bam->tp_cm.PGN_of_the_packeted_message, SA, 0xFF, bam->tp_cm.number_of_packages);
+    uint8_t *complete_data = bam->data;
+    bam->data = NULL;
+    bam->tp_cm.timeout = 0;
+    SAE_J1939_Read_Transport_Protocol_Complete_Message(j1939, SA, bam->tp_cm.PGN_of_the_packeted_message, complete_data, bam->tp_cm.total_message_size);
+    SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &complete_data);
 }
 
 /*
@@ -78,11 +152,22 @@ void SAE_J1939_Read_Transport_Protocol_Data_Transfer(J1939 *j1939, uint8_t SA, u
  * PGN: 0x00EB00 (60160)
  */
 ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_Data_Transfer(J1939 *j1939, uint8_t DA) {
+    return SAE_J1939_Send_Transport_Protocol_Data_Transfer_Packages(j1939, DA, 1, j1939->this_ecu_tp_cm.number_of_packages);
+}
+
+/*
+ * Send number_of_packages of the loaded sequence data packages, starting with next_package. This is what a CTS asks for
+ * PGN: 0x00EB00 (60160)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Transport_Protocol_Data_Transfer_Packages(J1939 *j1939, uint8_t DA, uint8_t next_package, uint8_t number_of_packages) {
     uint32_t ID = (0x1CEB << 16) | (DA << 8) | j1939->information_this_ECU.this_ECU_address;
     uint8_t package[8];
-    uint16_t bytes_sent = 0;
+    uint16_t last_package = next_package + number_of_packages - 1;
+    if (j1939->this_ecu_tp_dt.data == NULL || next_package == 0 || number_of_packages == 0 || last_package > j1939->this_ecu_tp_cm.number_of_packages)
+        return STATUS_SEND_ERROR;
+    uint16_t bytes_sent = (next_package - 1) * 7;
     ENUM_J1939_STATUS_CODES status = STATUS_SEND_OK;
-    for (uint8_t i = 1; i <= j1939->this_ecu_tp_cm.number_of_packages; i++) {
+    for (uint16_t i = next_package; i <= last_package; i++) {
         package[0] = i;                                                                     /* Number of package */
         for (uint8_t j = 0; j < 7; j++)
             if (bytes_sent < j1939->this_ecu_tp_cm.total_message_size)
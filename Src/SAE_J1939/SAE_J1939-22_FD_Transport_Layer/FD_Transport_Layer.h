@@ -0,0 +1,52 @@
+/*
+ * FD_Transport_Layer.h
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#ifndef SAE_J1939_22_FD_TRANSPORT_LAYER_SAE_J1939_22_FD_TRANSPORT_LAYER_H_
+#define SAE_J1939_22_FD_TRANSPORT_LAYER_SAE_J1939_22_FD_TRANSPORT_LAYER_H_
+
+/* Layers */
+#include "../SAE_J1939-21_Transport_Layer/Transport_Layer.h"
+
+/* FD Transport Protocol according to SAE J1939-22 - The timeouts are the same as for the Transport Protocol */
+#define FD_TP_CM_LENGTH 12								/* Every FD TP CM is a 12 byte CAN FD frame */
+#define FD_TP_DT_HEADER_SIZE 4							/* Session number and 3 bytes of segment number */
+#define FD_TP_SEGMENT_SIZE 60							/* Bytes of the message in every FD TP DT segment - A 64 byte CAN FD frame */
+
+/* Multi-PG according to SAE J1939-22 - Short parameter groups (C-PG) in one CAN FD frame */
+#define MULTI_PG_HEADER_SIZE 4							/* Type of service, trailer format, PGN and length of every C-PG */
+#define MULTI_PG_TYPE_OF_SERVICE 2						/* C-PG without assurance data - The padding 0xAA gives type of service 5, so padding is never read as a C-PG */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* FD Transport Protocol Connection Management */
+void SAE_J1939_Read_FD_Transport_Protocol_Connection_Management(J1939 *j1939, uint8_t SA, uint8_t data[], uint8_t length);
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_Connection_Management(J1939 *j1939, uint8_t DA);
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_Message(J1939 *j1939, uint8_t DA, uint32_t PGN, uint8_t data[], uint16_t total_message_size);
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_Clear_To_Send(J1939 *j1939);
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_End_Of_Message_Status(J1939 *j1939, uint8_t DA);
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_End_Of_Message_Acknowledgement(J1939 *j1939, uint8_t DA, uint8_t session_number, uint16_t total_message_size, uint8_t number_of_segments, uint32_t PGN);
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_Connection_Abort(J1939 *j1939, uint8_t DA, uint8_t session_number, uint8_t abort_reason, uint32_t PGN);
+void SAE_J1939_Check_FD_Transport_Protocol_Timeout(J1939 *j1939);
+
+/* FD Transport Protocol Data Transfer */
+void SAE_J1939_Read_FD_Transport_Protocol_Data_Transfer(J1939 *j1939, uint8_t SA, uint8_t data[], uint8_t length);
+void SAE_J1939_Read_FD_Transport_Protocol_Data_Transfer_BAM(J1939 *j1939, uint8_t SA, uint8_t data[], uint8_t length);
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_Data_Transfer_Segments(J1939 *j1939, uint8_t DA, uint8_t next_segment, uint8_t number_of_segments);
+
+/* Multi-PG */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Multi_PG(J1939 *j1939, uint32_t ID, const uint8_t data[], uint8_t length, uint16_t latency);
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Multi_PG_Frame(J1939 *j1939);
+void SAE_J1939_Multi_PG_Process(J1939 *j1939);
+bool SAE_J1939_Read_Multi_PG(const uint8_t data[], uint8_t length, uint8_t *offset, uint32_t *PGN, const uint8_t **payload, uint8_t *payload_length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAE_J1939_22_FD_TRANSPORT_LAYER_SAE_J1939_22_FD_TRANSPORT_LAYER_H_ */
@@ -0,0 +1,357 @@
+/*
+ * FD_Transport_Protocol_Connection_Management.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "FD_Transport_Layer.h"
+
+/* The C standard library */
+#include <string.h>
+
+/*
+ * The FD TP CM is 12 bytes. Byte 1 has the session number in the highest 4 bits and the control byte in the lowest 4 bits.
+ * RTS, BAM, EndOfMsgStatus and EndOfMsgACK - Byte 2 to 4 are the message size, byte 5 to 7 are the number of segments and byte 8 is the max segments per CTS
+ * CTS - Byte 2 is the number of segments that can be sent and byte 3 to 5 are the next segment
+ * Abort - Byte 2 is the abort reason
+ * The PGN of the packeted message is always in byte 10 to 12. The bytes that are not used are 0xFF
+ */
+
+/* Internal functions */
+static void Set_Header(uint8_t data[], uint8_t session_number, uint8_t control_byte, uint32_t PGN) {
+	memset(data, 0xFF, FD_TP_CM_LENGTH);
+	data[0] = (session_number << 4) | control_byte;
+	data[9] = PGN;
+	data[10] = PGN >> 8;
+	data[11] = PGN >> 16;
+}
+
+static ENUM_J1939_STATUS_CODES Send_Connection_Management(J1939 *j1939, uint8_t DA, uint8_t data[]) {
+	uint32_t ID = (0x1C4D << 16) | (DA << 8) | j1939->information_this_ECU.this_ECU_address;
+	return CAN_Send_Message_FD(ID, data, FD_TP_CM_LENGTH);
+}
+
+static ENUM_J1939_STATUS_CODES Send_Message_Size(J1939 *j1939, uint8_t DA, uint8_t session_number, uint8_t control_byte, uint16_t total_message_size, uint8_t number_of_segments, uint8_t max_segments_per_CTS, uint32_t PGN) {
+	uint8_t data[FD_TP_CM_LENGTH];
+	Set_Header(data, session_number, control_byte, PGN);
+	data[1] = total_message_size;
+	data[2] = total_message_size >> 8;
+	data[3] = 0;
+	data[4] = number_of_segments;
+	data[5] = 0;
+	data[6] = 0;
+	data[7] = max_segments_per_CTS;
+	return Send_Connection_Management(j1939, DA, data);
+}
+
+static void Start_Session(struct TP_CM *tp_cm, uint16_t timeout) {
+	tp_cm->time_stamp = Clock_Get_Milliseconds();
+	tp_cm->timeout = timeout;
+}
+
+static void Close_Receive_Session(J1939 *j1939) {
+	SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &j1939->from_other_ecu_fd_tp_dt.data);
+	memset(&j1939->from_other_ecu_fd_tp_dt, 0, sizeof(j1939->from_other_ecu_fd_tp_dt));
+	memset(&j1939->from_other_ecu_fd_tp_cm, 0, sizeof(j1939->from_other_ecu_fd_tp_cm));
+}
+
+static void Close_Transmit_Session(J1939 *j1939) {
+	j1939->this_ecu_fd_tp_cm.timeout = 0;
+	SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &j1939->this_ecu_fd_tp_dt.data);
+}
+
+/* The control byte is left as abort, so the sender can see afterwards that the message never arrived */
+static void Abort_Transmit_Session(J1939 *j1939) {
+	j1939->this_ecu_fd_tp_cm.control_byte = CONTROL_BYTE_FD_TP_CM_ABORT;
+	Close_Transmit_Session(j1939);
+}
+
+static uint8_t Get_Number_Of_Segments(uint32_t total_message_size) {
+	return (total_message_size + FD_TP_SEGMENT_SIZE - 1) / FD_TP_SEGMENT_SIZE;
+}
+
+/* A new BAM from the same ECU replaces the old one. Returns false if every session is taken or no buffer is free for the message */
+static bool Open_BAM_Session(J1939 *j1939, uint8_t SA, uint8_t session_number, uint32_t total_message_size, uint32_t number_of_segments, uint32_t PGN) {
+	if(total_message_size > TP_MAX_MESSAGE_SIZE || number_of_segments == 0 || number_of_segments != Get_Number_Of_Segments(total_message_size))
+		return false;
+	struct BAM_session *bam = NULL;
+	for(uint8_t i = 0; i < MAX_BAM_SESSIONS; i++){
+		struct BAM_session *session = &j1939->from_other_ecu_fd_bam[i];
+		if(session->tp_cm.timeout > 0 && session->tp_cm.from_ecu_address == SA){
+			bam = session;
+			break;
+		}
+		if(session->tp_cm.timeout == 0 && bam == NULL)
+			bam = session;
+	}
+	if(bam == NULL)
+		return false;
+	memset(&bam->tp_cm, 0, sizeof(bam->tp_cm));
+	SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &bam->data);
+	bam->data = SAE_J1939_Borrow_Transport_Protocol_Buffer(j1939, total_message_size);
+	if(bam->data == NULL)
+		return false;
+	bam->tp_cm.control_byte = CONTROL_BYTE_FD_TP_CM_BAM;
+	bam->tp_cm.session_number = session_number;
+	bam->tp_cm.total_message_size = total_message_size;
+	bam->tp_cm.number_of_packages = number_of_segments;
+	bam->tp_cm.PGN_of_the_packeted_message = PGN;
+	bam->tp_cm.from_ecu_address = SA;
+	bam->next_sequence_number = 1;
+	Start_Session(&bam->tp_cm, TP_TIMEOUT_T1);
+	TRACE_EVENT(TRACE_EVENT_TP_RECEIVE_OPEN, PGN, SA, 0xFF, number_of_segments);
+	return true;
+}
+
+static bool Is_Segment_Received(struct TP_DT *tp_dt, uint16_t segment_number) {
+	uint8_t index = segment_number - 1;
+	return (tp_dt->received_packages[index >> 3] >> (index & 7)) & 1;
+}
+
+/*
+ * Store information about the segments that other ECU is going to send to this ECU
+ * PGN: 0x004D00 (19712)
+ */
+void SAE_J1939_Read_FD_Transport_Protocol_Connection_Management(J1939 *j1939, uint8_t SA, uint8_t data[], uint8_t length) {
+	if(length < FD_TP_CM_LENGTH)
+		return;
+	uint8_t session_number = data[0] >> 4;
+	uint8_t control_byte = data[0] & 0xF;
+	uint32_t total_message_size = (data[3] << 16) | (data[2] << 8) | data[1];
+	uint32_t number_of_segments = (data[6] << 16) | (data[5] << 8) | data[4];
+	uint32_t PGN = (data[11] << 16) | (data[10] << 8) | data[9];
+	struct TP_CM *rx = &j1939->from_other_ecu_fd_tp_cm;
+	struct TP_CM *tx = &j1939->this_ecu_fd_tp_cm;
+	bool is_transmit_session = tx->timeout > 0 && tx->to_ecu_address == SA && tx->session_number == session_number;
+	bool is_receive_session = rx->timeout > 0 && rx->from_ecu_address == SA && rx->session_number == session_number;
+
+	switch(control_byte){
+	case CONTROL_BYTE_FD_TP_CM_BAM:
+		/* Nobody answers a BAM, so a BAM that cannot be received is only dropped */
+		if(!Open_BAM_Session(j1939, SA, session_number, total_message_size, number_of_segments, PGN))
+			TRACE_EVENT(TRACE_EVENT_TP_BAM_DROPPED, PGN, SA, 0xFF, GROUP_FUNCTION_VALUE_LACKING_NECESSARY_RESOURCES);
+		break;
+	case CONTROL_BYTE_FD_TP_CM_RTS:
+		/* A new RTS from the same ECU replaces the old session. Other ECU must wait until the open session is done */
+		if(rx->timeout > 0 && rx->from_ecu_address != SA){
+			SAE_J1939_Send_FD_Transport_Protocol_Connection_Abort(j1939, SA, session_number, GROUP_FUNCTION_VALUE_CANNOT_MAINTAIN_ANOTHER_CONNECTION, PGN);
+			return;
+		}
+		if(total_message_size > TP_MAX_MESSAGE_SIZE){
+			SAE_J1939_Send_FD_Transport_Protocol_Connection_Abort(j1939, SA, session_number, GROUP_FUNCTION_VALUE_TOTAL_MESSAGE_SIZE_TOO_LARGE, PGN);
+			return;
+		}
+		if(number_of_segments == 0 || number_of_segments != Get_Number_Of_Segments(total_message_size)){
+			SAE_J1939_Send_FD_Transport_Protocol_Connection_Abort(j1939, SA, session_number, GROUP_FUNCTION_VALUE_NO_CAUSE, PGN);
+			return;
+		}
+		Close_Receive_Session(j1939);
+		j1939->from_other_ecu_fd_tp_dt.data = SAE_J1939_Borrow_Transport_Protocol_Buffer(j1939, total_message_size);
+		if(j1939->from_other_ecu_fd_tp_dt.data == NULL){
+			SAE_J1939_Send_FD_Transport_Protocol_Connection_Abort(j1939, SA, session_number, GROUP_FUNCTION_VALUE_LACKING_NECESSARY_RESOURCES, PGN);
+			return;
+		}
+		rx->control_byte = control_byte;
+		rx->session_number = session_number;
+		rx->total_message_size = total_message_size;
+		rx->number_of_packages = number_of_segments;
+		rx->PGN_of_the_packeted_message = PGN;
+		rx->from_ecu_address = SA;
+		j1939->from_other_ecu_fd_tp_dt.max_packages_per_CTS = data[7];
+		TRACE_EVENT(TRACE_EVENT_TP_RECEIVE_OPEN, PGN, SA, j1939->information_this_ECU.this_ECU_address, number_of_segments);
+
+		/* We need to answer with CTS - Clear To Send */
+		SAE_J1939_Send_FD_Transport_Protocol_Clear_To_Send(j1939);
+		break;
+	case CONTROL_BYTE_FD_TP_CM_CTS:
+		/* Only the ECU we have sent RTS to can give us a CTS */
+		if(!is_transmit_session)
+			return;
+		if(data[1] == 0){
+			Start_Session(tx, TP_TIMEOUT_T4);						/* The other ECU want us to hold the connection open */
+			return;
+		}
+		/* The other ECU tells how many segments it can take and from which segment - It can ask again for segments that it missed */
+		uint32_t next_segment = (data[4] << 16) | (data[3] << 8) | data[2];
+		if(next_segment == 0 || next_segment + data[1] - 1 > tx->number_of_packages){
+			SAE_J1939_Send_FD_Transport_Protocol_Connection_Abort(j1939, SA, tx->session_number, GROUP_FUNCTION_VALUE_BAD_SEQUENCE_NUMBER, tx->PGN_of_the_packeted_message);
+			Abort_Transmit_Session(j1939);
+			return;
+		}
+		if(SAE_J1939_Send_FD_Transport_Protocol_Data_Transfer_Segments(j1939, SA, next_segment, data[1]) == STATUS_SEND_OK && next_segment + data[1] > tx->number_of_packages)
+			SAE_J1939_Send_FD_Transport_Protocol_End_Of_Message_Status(j1939, SA);
+		Start_Session(tx, TP_TIMEOUT_T3);
+		break;
+	case CONTROL_BYTE_FD_TP_CM_EndOfMsgStatus:
+		/* The other ECU has sent the last segment. A session that is still open has missed segments, so ask for them again */
+		if(is_receive_session)
+			SAE_J1939_Send_FD_Transport_Protocol_Clear_To_Send(j1939);
+		break;
+	case CONTROL_BYTE_FD_TP_CM_EndOfMsgACK:
+		if(is_transmit_session){
+			TRACE_EVENT(TRACE_EVENT_TP_TRANSMIT_COMPLETE, tx->PGN_of_the_packeted_message, j1939->information_this_ECU.this_ECU_address, SA, tx->number_of_packages);
+			Close_Transmit_Session(j1939);
+		}
+		break;
+	case CONTROL_BYTE_FD_TP_CM_ABORT:
+		TRACE_EVENT(TRACE_EVENT_TP_ABORT_RECEIVED, PGN, SA, j1939->information_this_ECU.this_ECU_address, data[1]);
+		if(is_transmit_session)
+			Abort_Transmit_Session(j1939);
+		if(is_receive_session)
+			Close_Receive_Session(j1939);
+		break;
+	}
+}
+
+/*
+ * Send information to other ECU about how many segments this ECU is going to send to other ECU
+ * PGN: 0x004D00 (19712)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_Connection_Management(J1939 *j1939, uint8_t DA) {
+	struct TP_CM *tx = &j1939->this_ecu_fd_tp_cm;
+
+	/* A RTS opens a session that waits for CTS from the other ECU */
+	if(tx->control_byte == CONTROL_BYTE_FD_TP_CM_RTS){
+		tx->to_ecu_address = DA;
+		Start_Session(tx, TP_TIMEOUT_T3);
+	}
+	TRACE_EVENT(TRACE_EVENT_TP_TRANSMIT_OPEN, tx->PGN_of_the_packeted_message, j1939->information_this_ECU.this_ECU_address, DA, tx->number_of_packages);
+	return Send_Message_Size(j1939, DA, tx->session_number, tx->control_byte, tx->total_message_size, tx->number_of_packages, 0xFF, tx->PGN_of_the_packeted_message);
+}
+
+/*
+ * Load a message into the FD Transport Protocol of this ECU and send it to other ECU. Every segment carries 60 bytes, so a message needs up to 8 times fewer frames than with the Transport Protocol.
+ * If DA is broadcast, the data is sent directly with BAM. Else RTS is sent and the data is sent when the other ECU answer with CTS
+ * PGN: 0x004D00 (19712)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_Message(J1939 *j1939, uint8_t DA, uint32_t PGN, uint8_t data[], uint16_t total_message_size) {
+	if(total_message_size == 0 || total_message_size > TP_MAX_MESSAGE_SIZE)
+		return STATUS_SEND_ERROR;
+
+	/* Only one session at the time - Wait until the other ECU has answered with EndOfMsgACK, abort or timeout. The pool can also be empty until other sessions are done */
+	uint8_t *buffer = SAE_J1939_Get_FD_Transport_Protocol_Transmit_Buffer(j1939, total_message_size);
+	if(buffer == NULL)
+		return STATUS_SEND_BUSY;
+
+	/* Load data. data can already be in the buffer */
+	struct TP_CM *tx = &j1939->this_ecu_fd_tp_cm;
+	memmove(buffer, data, total_message_size);
+	tx->total_message_size = total_message_size;
+	tx->number_of_packages = Get_Number_Of_Segments(total_message_size);
+	tx->PGN_of_the_packeted_message = PGN;
+	tx->control_byte = DA == 0xFF ? CONTROL_BYTE_FD_TP_CM_BAM : CONTROL_BYTE_FD_TP_CM_RTS;
+	tx->session_number = j1939->this_ecu_fd_tp_session_number++ & 0xF;
+
+	/* Send FD TP CM */
+	ENUM_J1939_STATUS_CODES status = SAE_J1939_Send_FD_Transport_Protocol_Connection_Management(j1939, DA);
+	if(status != STATUS_SEND_OK){
+		Close_Transmit_Session(j1939);
+		return status;
+	}
+
+	/* BAM sends every segment directly - Else the other ECU answers the RTS with CTS */
+	if(tx->control_byte == CONTROL_BYTE_FD_TP_CM_BAM){
+		status = SAE_J1939_Send_FD_Transport_Protocol_Data_Transfer_Segments(j1939, DA, 1, tx->number_of_packages);
+		if(status == STATUS_SEND_OK)
+			TRACE_EVENT(TRACE_EVENT_TP_TRANSMIT_COMPLETE, PGN, j1939->information_this_ECU.this_ECU_address, DA, tx->number_of_packages);
+		Close_Transmit_Session(j1939);
+	}
+	return status;
+}
+
+/*
+ * Send a connection abort to the other ECU
+ * PGN: 0x004D00 (19712)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_Connection_Abort(J1939 *j1939, uint8_t DA, uint8_t session_number, uint8_t abort_reason, uint32_t PGN) {
+	TRACE_EVENT(TRACE_EVENT_TP_ABORT_SENT, PGN, j1939->information_this_ECU.this_ECU_address, DA, abort_reason);
+	uint8_t data[FD_TP_CM_LENGTH];
+	Set_Header(data, session_number, CONTROL_BYTE_FD_TP_CM_ABORT, PGN);
+	data[1] = abort_reason;
+	return Send_Connection_Management(j1939, DA, data);
+}
+
+/*
+ * Ask the other ECU for the first segments that are still missing. The first CTS asks from segment 1. Nothing is sent if every segment has arrived
+ * PGN: 0x004D00 (19712)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_Clear_To_Send(J1939 *j1939) {
+	struct TP_CM *rx = &j1939->from_other_ecu_fd_tp_cm;
+	struct TP_DT *tp_dt = &j1939->from_other_ecu_fd_tp_dt;
+	uint16_t next_segment = 1;
+	while(next_segment <= rx->number_of_packages && Is_Segment_Received(tp_dt, next_segment))
+		next_segment++;
+	if(next_segment > rx->number_of_packages)
+		return STATUS_SEND_OK;
+
+	/* Ask for the missing segments in a row, but not more than the other ECU can send after one CTS */
+	uint8_t max_segments = tp_dt->max_packages_per_CTS == 0 ? 0xFF : tp_dt->max_packages_per_CTS;
+	uint8_t number_of_segments = 0;
+	while(number_of_segments < max_segments && next_segment + number_of_segments <= rx->number_of_packages && !Is_Segment_Received(tp_dt, next_segment + number_of_segments))
+		number_of_segments++;
+	tp_dt->last_requested_package = next_segment + number_of_segments - 1;
+	Start_Session(rx, TP_TIMEOUT_T1);										/* T1 and not T2 of SAE J1939-21, so a lost CTS can be sent again before the other ECU gives up after T3 */
+	uint8_t data[FD_TP_CM_LENGTH];
+	Set_Header(data, rx->session_number, CONTROL_BYTE_FD_TP_CM_CTS, rx->PGN_of_the_packeted_message);
+	data[1] = number_of_segments;
+	data[2] = next_segment;
+	data[3] = next_segment >> 8;
+	data[4] = 0;
+	return Send_Connection_Management(j1939, rx->from_ecu_address, data);
+}
+
+/*
+ * Tell the other ECU that the last segment has been sent
+ * PGN: 0x004D00 (19712)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_End_Of_Message_Status(J1939 *j1939, uint8_t DA) {
+	struct TP_CM *tx = &j1939->this_ecu_fd_tp_cm;
+	return Send_Message_Size(j1939, DA, tx->session_number, CONTROL_BYTE_FD_TP_CM_EndOfMsgStatus, tx->total_message_size, tx->number_of_packages, 0xFF, tx->PGN_of_the_packeted_message);
+}
+
+/*
+ * Tell the other ECU that the whole message has been received
+ * PGN: 0x004D00 (19712)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_End_Of_Message_Acknowledgement(J1939 *j1939, uint8_t DA, uint8_t session_number, uint16_t total_message_size, uint8_t number_of_segments, uint32_t PGN) {
+	return Send_Message_Size(j1939, DA, session_number, CONTROL_BYTE_FD_TP_CM_EndOfMsgACK, total_message_size, number_of_segments, 0xFF, PGN);
+}
+
+/*
+ * Abort the sessions that have been quiet for too long. BAM is only dropped because nobody is waiting for an answer
+ * This is called from Open_SAE_J1939_Listen_For_Messages, so it needs no own thread
+ */
+void SAE_J1939_Check_FD_Transport_Protocol_Timeout(J1939 *j1939) {
+	uint32_t now = Clock_Get_Milliseconds();
+	struct TP_CM *rx = &j1939->from_other_ecu_fd_tp_cm;
+	struct TP_CM *tx = &j1939->this_ecu_fd_tp_cm;
+
+	/* Receive session - Ask again for the missing segments before we give up */
+	if(rx->timeout > 0 && (uint32_t)(now - rx->time_stamp) >= rx->timeout){
+		struct TP_DT *tp_dt = &j1939->from_other_ecu_fd_tp_dt;
+		if(tp_dt->number_of_retransmit_requests < TP_MAX_RETRANSMIT_REQUESTS){
+			tp_dt->number_of_retransmit_requests++;
+			SAE_J1939_Send_FD_Transport_Protocol_Clear_To_Send(j1939);
+		}else{
+			SAE_J1939_Send_FD_Transport_Protocol_Connection_Abort(j1939, rx->from_ecu_address, rx->session_number, GROUP_FUNCTION_VALUE_MAXIMUM_RETRANSMIT_REQUEST_REACHED, rx->PGN_of_the_packeted_message);
+			Close_Receive_Session(j1939);
+		}
+	}
+
+	/* BAM sessions - The time between two segments is T1 */
+	for(uint8_t i = 0; i < MAX_BAM_SESSIONS; i++){
+		struct BAM_session *bam = &j1939->from_other_ecu_fd_bam[i];
+		if(bam->tp_cm.timeout > 0 && (uint32_t)(now - bam->tp_cm.time_stamp) >= bam->tp_cm.timeout){
+			bam->tp_cm.timeout = 0;
+			SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &bam->data);
+			TRACE_EVENT(TRACE_EVENT_TP_BAM_DROPPED, bam->tp_cm.PGN_of_the_packeted_message, bam->tp_cm.from_ecu_address, 0xFF, GROUP_FUNCTION_VALUE_ABORT_TIME_OUT);
+		}
+	}
+
+	/* Transmit session */
+	if(tx->timeout > 0 && (uint32_t)(now - tx->time_stamp) >= tx->timeout){
+		SAE_J1939_Send_FD_Transport_Protocol_Connection_Abort(j1939, tx->to_ecu_address, tx->session_number, GROUP_FUNCTION_VALUE_ABORT_TIME_OUT, tx->PGN_of_the_packeted_message);
+		Abort_Transmit_Session(j1939);
+	}
+}
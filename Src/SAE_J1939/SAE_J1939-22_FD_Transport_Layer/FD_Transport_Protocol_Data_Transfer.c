@@ -0,0 +1,138 @@
+/*
+ * FD_Transport_Protocol_Data_Transfer.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "FD_Transport_Layer.h"
+
+/* C standard library */
+#include <string.h>
+
+/* Internal functions */
+/* Byte 1 has the session number in the highest 4 bits. Byte 2 to 4 are the segment number, where the first segment is 1 */
+static uint32_t Get_Segment_Number(const uint8_t data[]) {
+    return (data[3] << 16) | (data[2] << 8) | data[1];
+}
+
+/* Copy the data of a segment. The last segment can be shorter, and a padded frame has more bytes than the message */
+static void Copy_Segment(uint8_t message[], uint16_t total_message_size, uint32_t segment_number, const uint8_t data[], uint8_t length) {
+    uint16_t offset = (segment_number - 1) * FD_TP_SEGMENT_SIZE;
+    for (uint8_t i = 0; i < FD_TP_SEGMENT_SIZE && FD_TP_DT_HEADER_SIZE + i < length && offset + i < total_message_size; i++)
+        message[offset + i] = data[FD_TP_DT_HEADER_SIZE + i];
+}
+
+/*
+ * Store the segments from other ECU
+ * PGN: 0x004E00 (19968)
+ */
+void SAE_J1939_Read_FD_Transport_Protocol_Data_Transfer(J1939 *j1939, uint8_t SA, uint8_t data[], uint8_t length) {
+    struct TP_CM *tp_cm = &j1939->from_other_ecu_fd_tp_cm;
+    struct TP_DT *tp_dt = &j1939->from_other_ecu_fd_tp_dt;
+
+    /* Only accept segments from the ECU that has an open session with this ECU */
+    if (length <= FD_TP_DT_HEADER_SIZE || tp_cm->timeout == 0 || tp_cm->from_ecu_address != SA || tp_cm->session_number != data[0] >> 4)
+        return;
+    uint32_t segment_number = Get_Segment_Number(data);
+    if (segment_number == 0 || segment_number > tp_cm->number_of_packages)
+        return;
+
+    /* A segment that has already arrived is ignored - The first copy is kept */
+    uint8_t index = segment_number - 1;
+    uint8_t bit = 1 << (index & 7);
+    if (tp_dt->received_packages[index >> 3] & bit)
+        return;
+    tp_dt->received_packages[index >> 3] |= bit;
+    tp_dt->number_of_received_packages++;
+    tp_dt->number_of_retransmit_requests = 0;
+    tp_cm->time_stamp = Clock_Get_Milliseconds();
+    tp_cm->timeout = TP_TIMEOUT_T1;
+    tp_dt->sequence_number = segment_number;
+    tp_dt->from_ecu_address = SA;
+    Copy_Segment(tp_dt->data, tp_cm->total_message_size, segment_number, data, length);
+
+    /* Check if we have completed our message - When the last segment of the CTS has arrived, ask for the segments that are missing */
+    if (tp_dt->number_of_received_packages < tp_cm->number_of_packages) {
+        if (segment_number >= tp_dt->last_requested_package)
+            SAE_J1939_Send_FD_Transport_Protocol_Clear_To_Send(j1939);
+        return;
+    }
+
+    /* Our message are complete - Send an end of message ACK back */
+    uint32_t PGN = tp_cm->PGN_of_the_packeted_message;
+    uint16_t total_message_size = tp_cm->total_message_size;
+    TRACE_EVENT(TRACE_EVENT_TP_RECEIVE_COMPLETE, PGN, SA, j1939->information_this_ECU.this_ECU_address, tp_cm->number_of_packages);
+    SAE_J1939_Send_FD_Transport_Protocol_End_Of_Message_Acknowledgement(j1939, SA, tp_cm->session_number, total_message_size, tp_cm->number_of_packages, PGN);
+
+    /* Delete TP DT and TP CM, but keep the buffer until the message has been read. Then the buffer goes back to the pool */
+    uint8_t *complete_data = tp_dt->data;
+    memset(tp_dt, 0, sizeof(*tp_dt));
+    memset(tp_cm, 0, sizeof(*tp_cm));
+    SAE_J1939_Read_Transport_Protocol_Complete_Message(j1939, SA, PGN, complete_data, total_message_size);
+    SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &complete_data);
+}
+
+/*
+ * Store the segments that other ECU broadcast with BAM. Every broadcasting ECU has its own session, so BAM from many ECU can be received at the same time
+ * PGN: 0x004E00 (19968)
+ */
+void SAE_J1939_Read_FD_Transport_Protocol_Data_Transfer_BAM(J1939 *j1939, uint8_t SA, uint8_t data[], uint8_t length) {
+    if (length <= FD_TP_DT_HEADER_SIZE)
+        return;
+    struct BAM_session *bam = NULL;
+    for (uint8_t i = 0; i < MAX_BAM_SESSIONS && bam == NULL; i++)
+        if (j1939->from_other_ecu_fd_bam[i].tp_cm.timeout > 0 && j1939->from_other_ecu_fd_bam[i].tp_cm.from_ecu_address == SA && j1939->from_other_ecu_fd_bam[i].tp_cm.session_number == data[0] >> 4)
+            bam = &j1939->from_other_ecu_fd_bam[i];
+    if (bam == NULL)
+        return;
+
+    /* There is no retransmission with BAM - A segment that is missing, repeated or in wrong order makes the message useless */
+    uint32_t segment_number = Get_Segment_Number(data);
+    if (segment_number != bam->next_sequence_number) {
+        TRACE_EVENT(TRACE_EVENT_TP_BAM_DROPPED, bam->tp_cm.PGN_of_the_packeted_message, SA, 0xFF, GROUP_FUNCTION_VALUE_BAD_SEQUENCE_NUMBER);
+        bam->tp_cm.timeout = 0;
+        SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &bam->data);
+        return;
+    }
+    bam->tp_cm.time_stamp = Clock_Get_Milliseconds();
+    Copy_Segment(bam->data, bam->tp_cm.total_message_size, segment_number, data, length);
+    if (bam->next_sequence_number++ < bam->tp_cm.number_of_packages)
+        return;
+
+    /* Complete - Free the session before the message is read, so the same ECU can start a new BAM from the callbacks. Then the buffer goes back to the pool */
+    TRACE_EVENT(TRACE_EVENT_TP_RECEIVE_COMPLETE, bam->tp_cm.PGN_of_the_packeted_message, SA, 0xFF, bam->tp_cm.number_of_packages);
+    uint8_t *complete_data = bam->data;
+    bam->data = NULL;
+    bam->tp_cm.timeout = 0;
+    SAE_J1939_Read_Transport_Protocol_Complete_Message(j1939, SA, bam->tp_cm.PGN_of_the_packeted_message, complete_data, bam->tp_cm.total_message_size);
+    SAE_J1939_Return_Transport_Protocol_Buffer(j1939, &complete_data);
+}
+
+/*
+ * Send number_of_segments of the loaded segments, starting with next_segment. This is what a CTS asks for. The last segment is padded to a valid CAN FD length
+ * PGN: 0x004E00 (19968)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_FD_Transport_Protocol_Data_Transfer_Segments(J1939 *j1939, uint8_t DA, uint8_t next_segment, uint8_t number_of_segments) {
+    struct TP_CM *tx = &j1939->this_ecu_fd_tp_cm;
+    uint32_t ID = (0x1C4E << 16) | (DA << 8) | j1939->information_this_ECU.this_ECU_address;
+    uint8_t segment[FD_TP_DT_HEADER_SIZE + FD_TP_SEGMENT_SIZE];
+    uint16_t last_segment = next_segment + number_of_segments - 1;
+    if (j1939->this_ecu_fd_tp_dt.data == NULL || next_segment == 0 || number_of_segments == 0 || last_segment > tx->number_of_packages)
+        return STATUS_SEND_ERROR;
+    ENUM_J1939_STATUS_CODES status = STATUS_SEND_OK;
+    for (uint16_t i = next_segment; i <= last_segment; i++) {
+        uint16_t offset = (i - 1) * FD_TP_SEGMENT_SIZE;
+        uint8_t length = tx->total_message_size - offset < FD_TP_SEGMENT_SIZE ? tx->total_message_size - offset : FD_TP_SEGMENT_SIZE;
+        segment[0] = (tx->session_number << 4) | 0xF;
+        segment[1] = i;
+        segment[2] = i >> 8;
+        segment[3] = 0;
+        memcpy(&segment[FD_TP_DT_HEADER_SIZE], &j1939->this_ecu_fd_tp_dt.data[offset], length);
+
+        status = CAN_Send_Message_FD(ID, segment, FD_TP_DT_HEADER_SIZE + length);
+        if (status != STATUS_SEND_OK)
+            return status;
+    }
+    return status;
+}
@@ -0,0 +1,134 @@
+/*
+ * Multi_PG.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "FD_Transport_Layer.h"
+
+/* C standard library */
+#include <string.h>
+
+/*
+ * A multi-PG frame holds short parameter groups (C-PG) one after the other. Every C-PG has a 4 byte header in front of its data.
+ * The header is little endian - The payload length in the lowest 8 bits, then the 18 bit PGN, 3 bits of trailer format and 3 bits of type of service.
+ * A PDU1 PGN has the destination address in its lowest byte. The container is broadcast and has the source address of this ECU
+ */
+
+/* Internal functions */
+static void Write_Header(uint8_t data[], uint32_t PGN, uint8_t payload_length) {
+    uint32_t header = ((uint32_t)MULTI_PG_TYPE_OF_SERVICE << 29) | ((PGN & 0x3FFFF) << 8) | payload_length;    /* Trailer format 0 - No trailer */
+    data[0] = header;
+    data[1] = header >> 8;
+    data[2] = header >> 16;
+    data[3] = header >> 24;
+}
+
+static uint32_t Read_Header(const uint8_t data[]) {
+    return ((uint32_t)data[3] << 24) | ((uint32_t)data[2] << 16) | (data[1] << 8) | data[0];
+}
+
+/* A C-PG with the same PGN and length is replaced, so a cyclic message that comes again before the frame is sent only gives its newest value */
+static bool Replace_C_PG(struct Multi_PG *multi_pg, uint32_t PGN, const uint8_t data[], uint8_t length) {
+    uint8_t offset = 0;
+    uint32_t packed_PGN;
+    const uint8_t *payload;
+    uint8_t payload_length;
+    while (SAE_J1939_Read_Multi_PG(multi_pg->data, multi_pg->length, &offset, &packed_PGN, &payload, &payload_length)) {
+        if (packed_PGN == PGN && payload_length == length) {
+            memcpy(&multi_pg->data[offset - length], data, length);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Pack a short parameter group into the multi-PG frame of this ECU. ID is the CAN ID that the parameter group would have had alone.
+ * The frame is sent when the first C-PG in it has waited latency milliseconds or when the next C-PG does not fit. With latency 0, the frame is sent at the next call of SAE_J1939_Multi_PG_Process.
+ * Without CAN FD, the parameter group is sent directly as a classic frame
+ * PGN: 0x002500 (9472)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Multi_PG(J1939 *j1939, uint32_t ID, const uint8_t data[], uint8_t length, uint16_t latency) {
+    struct Multi_PG *multi_pg = &j1939->this_multi_pg;
+    uint32_t PGN = (ID >> 8) & 0x3FFFF;
+    uint8_t priority = (ID >> 26) & 0x7;
+    if (!j1939->is_CAN_FD) {
+        if (length > 8)
+            return STATUS_SEND_ERROR;
+        uint8_t frame[8];
+        memset(frame, 0xFF, sizeof(frame));
+        memcpy(frame, data, length);
+        return CAN_Send_Message(ID, frame);
+    }
+    if (length == 0 || MULTI_PG_HEADER_SIZE + length > CAN_MAX_DATA_LENGTH || PGN == pgn_value[PGN_MULTI_PG])
+        return STATUS_SEND_ERROR;
+
+    /* A new C-PG is put last. If it does not fit, the frame that is packed so far is sent first */
+    uint32_t deadline = Clock_Get_Milliseconds() + latency;
+    if (!Replace_C_PG(multi_pg, PGN, data, length)) {
+        if (multi_pg->length + MULTI_PG_HEADER_SIZE + length > CAN_MAX_DATA_LENGTH && SAE_J1939_Send_Multi_PG_Frame(j1939) != STATUS_SEND_OK)
+            return STATUS_SEND_BUSY;
+        Write_Header(&multi_pg->data[multi_pg->length], PGN, length);
+        memcpy(&multi_pg->data[multi_pg->length + MULTI_PG_HEADER_SIZE], data, length);
+        if (multi_pg->length == 0) {
+            multi_pg->priority = priority;
+            multi_pg->deadline = deadline;
+        }
+        multi_pg->length += MULTI_PG_HEADER_SIZE + length;
+    }
+
+    /* The frame waits no longer than the shortest latency and has the highest priority of its C-PG */
+    if ((int32_t)(deadline - multi_pg->deadline) < 0)
+        multi_pg->deadline = deadline;
+    if (priority < multi_pg->priority)
+        multi_pg->priority = priority;
+    return STATUS_SEND_OK;
+}
+
+/*
+ * Send the C-PG that are packed so far as one multi-PG frame. The C-PG are kept if the frame could not be sent, so they are sent again later
+ * PGN: 0x002500 (9472)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Send_Multi_PG_Frame(J1939 *j1939) {
+    struct Multi_PG *multi_pg = &j1939->this_multi_pg;
+    if (multi_pg->length == 0)
+        return STATUS_SEND_OK;
+    uint32_t ID = ((uint32_t)multi_pg->priority << 26) | (pgn_value[PGN_MULTI_PG] << 8) | (0xFF << 8) | j1939->information_this_ECU.this_ECU_address;
+    ENUM_J1939_STATUS_CODES status = CAN_Send_Message_FD(ID, multi_pg->data, multi_pg->length);
+    if (status == STATUS_SEND_OK)
+        multi_pg->length = 0;
+    return status;
+}
+
+/*
+ * Send the multi-PG frame when its latency has passed
+ * This is called from Open_SAE_J1939_Listen_For_Messages
+ */
+void SAE_J1939_Multi_PG_Process(J1939 *j1939) {
+    struct Multi_PG *multi_pg = &j1939->this_multi_pg;
+    if (multi_pg->length > 0 && (int32_t)(Clock_Get_Milliseconds() - multi_pg->deadline) >= 0)
+        SAE_J1939_Send_Multi_PG_Frame(j1939);
+}
+
+/*
+ * Find the next C-PG of a multi-PG frame. offset starts at 0 and is moved past the C-PG. The payload points into data.
+ * Returns false at the padding or when a header does not fit in the frame. A multi-PG inside a multi-PG is skipped
+ * PGN: 0x002500 (9472)
+ */
+bool SAE_J1939_Read_Multi_PG(const uint8_t data[], uint8_t length, uint8_t *offset, uint32_t *PGN, const uint8_t **payload, uint8_t *payload_length) {
+    while (*offset + MULTI_PG_HEADER_SIZE <= length) {
+        uint32_t header = Read_Header(&data[*offset]);
+        uint8_t size = header;
+        if (header >> 29 != MULTI_PG_TYPE_OF_SERVICE || size == 0 || *offset + MULTI_PG_HEADER_SIZE + size > length)
+            return false;
+        *PGN = (header >> 8) & 0x3FFFF;
+        *payload = &data[*offset + MULTI_PG_HEADER_SIZE];
+        *payload_length = size;
+        *offset += MULTI_PG_HEADER_SIZE + size;
+        if (*PGN != pgn_value[PGN_MULTI_PG])
+            return true;
+    }
+    return false;
+}
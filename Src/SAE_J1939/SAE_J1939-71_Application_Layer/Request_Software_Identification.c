@@ -11,6 +11,9 @@
 #include "../SAE_J1939-21_Transport_Layer/Transport_Layer.h"
 #include "../../Hardware/Hardware.h"
 
+/* The C standard library */
+#include <string.h>
+
 /*
  * Send request software identification to another ECU
  * PGN: 0x00FEDA (65242)
@@ -19,39 +22,35 @@ ENUM_J1939_STATUS_CODES SAE_J1939_Send_Request_Software_Identification(J1939 *j1
 	return SAE_J1939_Send_Request(j1939, DA, pgn_value[PGN_SOFTWARE_IDENTIFICATION]);
 }
 
+/*
+ * Encode the software identification about this ECU into the response cache
+ * PGN: 0x00FEDA (65242)
+ */
+static void Encode_Software_Identification(J1939 *j1939) {
+	struct Encoded_response *response = &j1939->this_response_cache.software_identification;
+	uint8_t number_of_fields = j1939->information_this_ECU.this_identifications.software_identification.number_of_fields;
+	if(number_of_fields > sizeof(j1939->information_this_ECU.this_identifications.software_identification.identifications))
+		number_of_fields = sizeof(j1939->information_this_ECU.this_identifications.software_identification.identifications);
+	response->data[0] = number_of_fields;
+	memcpy(&response->data[1], j1939->information_this_ECU.this_identifications.software_identification.identifications, sizeof(j1939->information_this_ECU.this_identifications.software_identification.identifications));
+	response->use_transport_protocol = number_of_fields >= 9;
+	response->length = response->use_transport_protocol ? number_of_fields + 1 : 8;
+	response->is_encoded = true;
+}
+
 /*
  * Response the request of the software identification about this ECU
  * PGN: 0x00FEDA (65242)
  */
 ENUM_J1939_STATUS_CODES SAE_J1939_Response_Request_Software_Identification(J1939* j1939, uint8_t DA) {
-	uint8_t number_of_fields = j1939->information_this_ECU.this_identifications.software_identification.number_of_fields;
-	if (number_of_fields < 9) {
+	struct Encoded_response *response = &j1939->this_response_cache.software_identification;
+	if(!response->is_encoded)
+		Encode_Software_Identification(j1939);
+	if(!response->use_transport_protocol) {
 		uint32_t ID = (0x18FEDA << 8) | j1939->information_this_ECU.this_ECU_address;
-		uint8_t data[8];
-		data[0] = number_of_fields;
-		for(uint8_t i = 0; i < 7; i++)
-			data[i+1] = j1939->information_this_ECU.this_identifications.software_identification.identifications[i];
-		return CAN_Send_Message(ID, data);
-	} else {
-		/* Multiple messages - Load data */
-		j1939->this_ecu_tp_cm.total_message_size = 0;
-		j1939->this_ecu_tp_dt.data[j1939->this_ecu_tp_cm.total_message_size++] = number_of_fields;
-		for(uint8_t i = 0; i < number_of_fields; i++)
-			j1939->this_ecu_tp_dt.data[j1939->this_ecu_tp_cm.total_message_size++] = j1939->information_this_ECU.this_identifications.software_identification.identifications[i];
-
-		/* Send TP CM */
-		j1939->this_ecu_tp_cm.number_of_packages = j1939->this_ecu_tp_cm.total_message_size % 8 > 0 ? j1939->this_ecu_tp_cm.total_message_size/8 + 1 : j1939->this_ecu_tp_cm.total_message_size/8; /* Rounding up */
-		j1939->this_ecu_tp_cm.PGN_of_the_packeted_message = pgn_value[PGN_SOFTWARE_IDENTIFICATION];
-		j1939->this_ecu_tp_cm.control_byte = DA == 0xFF ? CONTROL_BYTE_TP_CM_BAM : CONTROL_BYTE_TP_CM_RTS; /* If broadcast, then use BAM control byte */
-		ENUM_J1939_STATUS_CODES status = SAE_J1939_Send_Transport_Protocol_Connection_Management(j1939, DA);
-		if(status != STATUS_SEND_OK)
-			return status;
-
-		/* Check if we are going to send it directly (BAM) - Else, the TP CM will send a RTS control byte to the other ECU and the ECU will answer with control byte CTS */
-		if(j1939->this_ecu_tp_cm.control_byte == CONTROL_BYTE_TP_CM_BAM)
-			return SAE_J1939_Send_Transport_Protocol_Data_Transfer(j1939, DA);
-		return status;
+		return CAN_Send_Message(ID, response->data);
 	}
+	return SAE_J1939_Send_Transport_Protocol_Message(j1939, DA, pgn_value[PGN_SOFTWARE_IDENTIFICATION], response->data, response->length);
 }
 
 /*
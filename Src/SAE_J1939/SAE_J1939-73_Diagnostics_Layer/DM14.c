@@ -19,7 +19,7 @@ ENUM_J1939_STATUS_CODES SAE_J1939_Send_Request_DM14(J1939 *j1939, uint8_t DA, ui
 	uint32_t ID = (0x18D9 << 16) | (DA << 8) | j1939->information_this_ECU.this_ECU_address;
 	uint8_t data[8];
 	data[0] = number_of_requested_bytes;
-	data[1] = (number_of_requested_bytes >> 3) | (pointer_type << 4) | (command << 1) | 0b1;
+	data[1] = ((number_of_requested_bytes >> 8) << 5) | (pointer_type << 4) | (command << 1) | 0b1;
 	data[2] = pointer;
 	data[3] = pointer >> 8;
 	data[4] = pointer >> 16;
@@ -42,28 +42,6 @@ ENUM_J1939_STATUS_CODES SAE_J1939_Read_Request_DM14(J1939 *j1939, uint8_t DA, ui
 	uint8_t pointer_extension = data[5];
 	uint16_t key = (data[7] << 8) | data[6];
 
-	/* Load up the amount of bytes we want to send via DM16 */
-	uint8_t number_of_occurences = number_of_requested_bytes;
-	uint8_t raw_binary_data[number_of_requested_bytes];
-
-	/* Here we ask the flash, eeprom or ram and use pointers */
-	FLASH_EEPROM_RAM_Memory(&number_of_requested_bytes, pointer_type, &command, &pointer, &pointer_extension, &key, raw_binary_data);
-
-	/* Prepare a DM15 PGN: 0x00D800 response back to DA */
-	uint16_t number_of_allowed_bytes = number_of_requested_bytes;
-	uint8_t status = command;
-	uint32_t EDC_parameter = pointer;
-	uint8_t EDCP_extention = pointer_extension;
-	uint16_t seed = key;
-	status = SAE_J1939_Send_Response_DM15(j1939, DA, number_of_allowed_bytes, status, EDC_parameter, EDCP_extention, seed);
-
-	/* Check if our message was OK - Send DM16 binary data transfer */
-	if(status == STATUS_DM15_PROCEED) {
-		if(SAE_J1939_Send_Binary_Data_Transfer_DM16(j1939, DA, number_of_occurences, raw_binary_data) == STATUS_SEND_OK)
-			status = SAE_J1939_Send_Response_DM15(j1939, DA, number_of_allowed_bytes, STATUS_DM15_OPERATION_COMPLETED, EDC_parameter, EDCP_extention, seed);
-		else
-			status = SAE_J1939_Send_Response_DM15(j1939, DA, number_of_allowed_bytes, STATUS_DM15_OPERATION_FAILED, EDC_parameter, EDCP_extention, seed);
-	}
-	return status;
-
+	/* The memory regions of this ECU answer with DM15 and stream the data with DM16 */
+	return SAE_J1939_Memory_Access_Request(j1939, DA, number_of_requested_bytes, pointer_type, command, pointer, pointer_extension, key);
 }
@@ -19,7 +19,7 @@ ENUM_J1939_STATUS_CODES SAE_J1939_Send_Response_DM15(J1939 *j1939, uint8_t DA, u
 	uint32_t ID = (0x18D8 << 16) | (DA << 8) | j1939->information_this_ECU.this_ECU_address;
 	uint8_t response_data[8];
 	response_data[0] = number_of_allowed_bytes;
-	response_data[1] = (number_of_allowed_bytes >> 3) | (0b1 << 4) | (status << 1) | 0b1;	 /* bit 5 and 1 are reserved */
+	response_data[1] = ((number_of_allowed_bytes >> 8) << 5) | (0b1 << 4) | (status << 1) | 0b1;	 /* bit 5 and 1 are reserved */
 	response_data[2] = EDC_parameter;
 	response_data[3] = EDC_parameter >> 8;
 	response_data[4] = EDC_parameter >> 16;
@@ -34,11 +34,14 @@ ENUM_J1939_STATUS_CODES SAE_J1939_Send_Response_DM15(J1939 *j1939, uint8_t DA, u
  * PGN: 0x00D800 (55296)
  */
 void SAE_J1939_Read_Response_DM15(J1939 *j1939, uint8_t SA, uint8_t data[]) {
-	j1939->from_other_ecu_dm.dm15.number_of_allowed_bytes = (data[1] >> 3) | data[0];
+	j1939->from_other_ecu_dm.dm15.number_of_allowed_bytes = ((data[1] & 0b11100000) << 3) | data[0];
 	j1939->from_other_ecu_dm.dm15.status = (data[1] >> 1) & 0b0000111;
 	j1939->from_other_ecu_dm.dm15.EDC_parameter = (data[4] << 16) | (data[3] << 8) | data[2];
 	j1939->from_other_ecu_dm.dm15.EDCP_extention = data[5];
 	j1939->from_other_ecu_dm.dm15.seed = (data[7] << 8) | data[6];
 	j1939->from_other_ecu_dm.dm15.from_ecu_address = SA;
+
+	/* Drive the memory read or write that this ECU has started */
+	SAE_J1939_Memory_Client_Response_DM15(j1939, SA);
 }
 
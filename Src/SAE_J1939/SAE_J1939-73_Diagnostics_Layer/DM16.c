@@ -18,39 +18,30 @@
 ENUM_J1939_STATUS_CODES SAE_J1939_Send_Binary_Data_Transfer_DM16(J1939 *j1939, uint8_t DA, uint8_t number_of_occurences, uint8_t raw_binary_data[]) {
 	if(number_of_occurences < 8) {
 		uint32_t ID = (0x18D7 << 16) | (DA << 8) | j1939->information_this_ECU.this_ECU_address;
-		uint8_t data[number_of_occurences + 1];								/* number_of_occurences must be 7 */
+		uint8_t data[8];
 		data[0] = number_of_occurences;										/* How much binary data we want to send */
-		for(uint8_t i = 0; i < number_of_occurences; i++)
-			data[i+1] = raw_binary_data[i];
+		for(uint8_t i = 0; i < 7; i++)
+			data[i+1] = i < number_of_occurences ? raw_binary_data[i] : 0xFF;	/* 0xFF = No data */
 		return CAN_Send_Message(ID, data);
 	}else{
-		/* Multiple messages - Load data */
-		j1939->this_ecu_tp_cm.total_message_size = 0;
-		j1939->this_ecu_tp_dt.data[j1939->this_ecu_tp_cm.total_message_size++] = number_of_occurences;
-		for(uint8_t i = 0; i < number_of_occurences; i++)
-			j1939->this_ecu_tp_dt.data[j1939->this_ecu_tp_cm.total_message_size++] = raw_binary_data[i];				/* When i = 0, then total_message_size = 1 */
-
-		/* Send TP CM */
-		j1939->this_ecu_tp_cm.number_of_packages = j1939->this_ecu_tp_cm.total_message_size % 8 > 0 ? j1939->this_ecu_tp_cm.total_message_size/8 + 1 : j1939->this_ecu_tp_cm.total_message_size/8; /* Rounding up */
-		j1939->this_ecu_tp_cm.PGN_of_the_packeted_message = pgn_value[PGN_DM16];
-		j1939->this_ecu_tp_cm.control_byte = DA == 0xFF ? CONTROL_BYTE_TP_CM_BAM : CONTROL_BYTE_TP_CM_RTS; /* If broadcast, then use BAM control byte */
-		ENUM_J1939_STATUS_CODES status = SAE_J1939_Send_Transport_Protocol_Connection_Management(j1939, DA);
-		if(status != STATUS_SEND_OK)
-			return status;
-
-		/* Check if we are going to send it directly (BAM) - Else, the TP CM will send a RTS control byte to the other ECU and the ECU will answer with control byte CTS */
-		if(j1939->this_ecu_tp_cm.control_byte == CONTROL_BYTE_TP_CM_BAM)
-			return SAE_J1939_Send_Transport_Protocol_Data_Transfer(j1939, DA);
-		return status;
+		/* Multiple messages - Load data directly into the Transport Protocol. raw_binary_data can already be there, after the number of occurrences */
+		uint8_t *data = SAE_J1939_Get_Transport_Protocol_Transmit_Buffer(j1939, number_of_occurences + 1);
+		if(data == NULL)
+			return STATUS_SEND_BUSY;
+		memmove(&data[1], raw_binary_data, number_of_occurences);
+		data[0] = number_of_occurences;
+		return SAE_J1939_Send_Transport_Protocol_Message(j1939, DA, pgn_value[PGN_DM16], data, number_of_occurences + 1);
 	}
 }
 
 
 /*
- * Read binary data transfer
+ * Read binary data transfer. length is how many bytes that arrived - A message that says it has more bytes than that is dropped
  * PGN: 0x00D700 (55040)
  */
-void SAE_J1939_Read_Binary_Data_Transfer_DM16(J1939 *j1939, uint8_t SA, uint8_t data[]) {
+void SAE_J1939_Read_Binary_Data_Transfer_DM16(J1939 *j1939, uint8_t SA, uint8_t data[], uint16_t length) {
+	if(length == 0 || data[0] + 1 > length)
+		return;
 	j1939->from_other_ecu_dm.dm16.number_of_occurences = data[0];
 	j1939->from_other_ecu_dm.dm16.from_ecu_address = SA;
 	for(uint8_t i = 0; i < 255; i++)
@@ -58,5 +49,11 @@ void SAE_J1939_Read_Binary_Data_Transfer_DM16(J1939 *j1939, uint8_t SA, uint8_t
 			j1939->from_other_ecu_dm.dm16.raw_binary_data[i] = data[i+1];
 		else
 			j1939->from_other_ecu_dm.dm16.raw_binary_data[i] = 0xFF;		/* No data */
+
+	/* Write the data into the memory of this ECU if the other ECU has asked for it with DM14 */
+	SAE_J1939_Memory_Access_Binary_Data(j1939, SA, data[0], &data[1]);
+
+	/* Or give the data to the memory read that this ECU has started */
+	SAE_J1939_Memory_Client_Binary_Data(j1939, SA, data[0], &data[1]);
 }
 
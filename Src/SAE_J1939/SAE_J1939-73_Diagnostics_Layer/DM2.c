@@ -38,29 +38,17 @@ ENUM_J1939_STATUS_CODES SAE_J1939_Response_Request_DM2(J1939 *j1939, uint8_t DA)
 		return CAN_Send_Message(ID, data);
 	} else {
 		/* Multiple messages - Load data */
-		j1939->this_ecu_tp_cm.number_of_packages = 2;
-		j1939->this_ecu_tp_cm.total_message_size = 9;
-		j1939->this_ecu_tp_dt.data[0] = (j1939->this_dm.dm2.SAE_lamp_status_malfunction_indicator << 6) | (j1939->this_dm.dm2.SAE_lamp_status_red_stop << 4) | (j1939->this_dm.dm2.SAE_lamp_status_amber_warning << 2) | (j1939->this_dm.dm2.SAE_lamp_status_protect_lamp);
-		j1939->this_ecu_tp_dt.data[1] = (j1939->this_dm.dm2.SAE_flash_lamp_malfunction_indicator << 6) | (j1939->this_dm.dm2.SAE_flash_lamp_red_stop << 4) | (j1939->this_dm.dm2.SAE_flash_lamp_amber_warning << 2) | (j1939->this_dm.dm2.SAE_flash_lamp_protect_lamp);
-		j1939->this_ecu_tp_dt.data[2] = j1939->this_dm.dm2.SPN;
-		j1939->this_ecu_tp_dt.data[3] = j1939->this_dm.dm2.SPN >> 8;
-		j1939->this_ecu_tp_dt.data[4] = ((j1939->this_dm.dm2.SPN >> 11) & 0b11100000) | j1939->this_dm.dm2.FMI;
-		j1939->this_ecu_tp_dt.data[5] = (j1939->this_dm.dm2.SPN_conversion_method << 7) | j1939->this_dm.dm2.occurrence_count;
-		j1939->this_ecu_tp_dt.data[6] = 0xFF;													/* Reserved */
-		j1939->this_ecu_tp_dt.data[7] = 0xFF;													/* Reserved */
-		j1939->this_ecu_tp_dt.data[8] = j1939->this_dm.errors_dm2_active;
-
-		/* Send TP CM */
-		j1939->this_ecu_tp_cm.PGN_of_the_packeted_message = pgn_value[PGN_DM2];
-		j1939->this_ecu_tp_cm.control_byte = DA == 0xFF ? CONTROL_BYTE_TP_CM_BAM : CONTROL_BYTE_TP_CM_RTS; /* If broadcast, then use BAM control byte */
-		ENUM_J1939_STATUS_CODES status = SAE_J1939_Send_Transport_Protocol_Connection_Management(j1939, DA);
-		if(status != STATUS_SEND_OK)
-			return status;
-
-		/* Check if we are going to send it directly (BAM) - Else, the TP CM will send a RTS control byte to the other ECU and the ECU will answer with control byte CTS */
-		if(j1939->this_ecu_tp_cm.control_byte == CONTROL_BYTE_TP_CM_BAM)
-			return SAE_J1939_Send_Transport_Protocol_Data_Transfer(j1939, DA);
-		return status;
+		uint8_t data[9];
+		data[0] = (j1939->this_dm.dm2.SAE_lamp_status_malfunction_indicator << 6) | (j1939->this_dm.dm2.SAE_lamp_status_red_stop << 4) | (j1939->this_dm.dm2.SAE_lamp_status_amber_warning << 2) | (j1939->this_dm.dm2.SAE_lamp_status_protect_lamp);
+		data[1] = (j1939->this_dm.dm2.SAE_flash_lamp_malfunction_indicator << 6) | (j1939->this_dm.dm2.SAE_flash_lamp_red_stop << 4) | (j1939->this_dm.dm2.SAE_flash_lamp_amber_warning << 2) | (j1939->this_dm.dm2.SAE_flash_lamp_protect_lamp);
+		data[2] = j1939->this_dm.dm2.SPN;
+		data[3] = j1939->this_dm.dm2.SPN >> 8;
+		data[4] = ((j1939->this_dm.dm2.SPN >> 11) & 0b11100000) | j1939->this_dm.dm2.FMI;
+		data[5] = (j1939->this_dm.dm2.SPN_conversion_method << 7) | j1939->this_dm.dm2.occurrence_count;
+		data[6] = 0xFF;													/* Reserved */
+		data[7] = 0xFF;													/* Reserved */
+		data[8] = j1939->this_dm.errors_dm2_active;
+		return SAE_J1939_Send_Transport_Protocol_Message(j1939, DA, pgn_value[PGN_DM2], data, 9);
 	}
 }
 
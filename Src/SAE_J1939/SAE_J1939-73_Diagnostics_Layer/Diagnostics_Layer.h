@@ -17,6 +17,7 @@
 #include "../SAE_J1939_Enums/Enum_DM1_DM2.h"
 #include "../SAE_J1939_Enums/Enum_DM14_DM15.h"
 #include "../SAE_J1939_Enums/Enum_Group_Function_Value.h"
+#include "../SAE_J1939_Enums/Enum_Memory_Client_Status.h"
 #include "../SAE_J1939_Enums/Enum_NAME.h"
 #include "../SAE_J1939_Enums/Enum_PGN.h"
 #include "../SAE_J1939_Enums/Enum_Send_Status.h"
@@ -49,7 +50,21 @@ void SAE_J1939_Read_Response_DM15(J1939 *j1939, uint8_t SA, uint8_t data[]);
 
 /* DM16 */
 ENUM_J1939_STATUS_CODES SAE_J1939_Send_Binary_Data_Transfer_DM16(J1939 *j1939, uint8_t DA, uint8_t number_of_occurences, uint8_t raw_binary_data[]);
-void SAE_J1939_Read_Binary_Data_Transfer_DM16(J1939 *j1939, uint8_t SA, uint8_t data[]);
+void SAE_J1939_Read_Binary_Data_Transfer_DM16(J1939 *j1939, uint8_t SA, uint8_t data[], uint16_t length);
+
+/* Memory access with DM14, DM15 and DM16 */
+bool SAE_J1939_Add_Memory_Region(J1939 *j1939, uint32_t address, uint32_t length, Memory_Read_Callback read, Memory_Write_Callback write, Memory_Erase_Callback erase, Memory_Key_Callback key, void *context);
+ENUM_J1939_STATUS_CODES SAE_J1939_Memory_Access_Request(J1939 *j1939, uint8_t SA, uint16_t number_of_requested_bytes, uint8_t pointer_type, uint8_t command, uint32_t pointer, uint8_t pointer_extension, uint16_t key);
+void SAE_J1939_Memory_Access_Binary_Data(J1939 *j1939, uint8_t SA, uint8_t number_of_occurences, const uint8_t raw_binary_data[]);
+void SAE_J1939_Memory_Access_Process(J1939 *j1939);
+
+/* Memory client with DM14, DM15 and DM16 */
+ENUM_J1939_STATUS_CODES SAE_J1939_Memory_Client_Read(J1939 *j1939, uint8_t DA, uint32_t address, uint32_t length, Memory_Write_Callback destination, Memory_Key_Callback key, Memory_Client_Callback callback, void *context);
+ENUM_J1939_STATUS_CODES SAE_J1939_Memory_Client_Write(J1939 *j1939, uint8_t DA, uint32_t address, uint32_t length, Memory_Read_Callback source, bool verify, Memory_Key_Callback key, Memory_Client_Callback callback, void *context);
+void SAE_J1939_Memory_Client_Cancel(J1939 *j1939);
+void SAE_J1939_Memory_Client_Response_DM15(J1939 *j1939, uint8_t SA);
+void SAE_J1939_Memory_Client_Binary_Data(J1939 *j1939, uint8_t SA, uint8_t number_of_occurences, const uint8_t raw_binary_data[]);
+void SAE_J1939_Memory_Client_Process(J1939 *j1939);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,260 @@
+/*
+ * Memory_Access.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Diagnostics_Layer.h"
+
+/* Layers */
+#include "../SAE_J1939-21_Transport_Layer/Transport_Layer.h"
+#include "../../Hardware/Hardware.h"
+
+/* C standard library */
+#include <stddef.h>
+
+/* Internal functions */
+/* EDC parameter is only sent as an error indicator. Else it's not available */
+static ENUM_J1939_STATUS_CODES Send_Status(J1939 *j1939, uint8_t DA, uint16_t number_of_bytes, uint8_t status, uint32_t EDC_parameter, uint16_t seed) {
+    if (EDC_parameter == EDC_PARAMETER_NO_ERROR)
+        return SAE_J1939_Send_Response_DM15(j1939, DA, number_of_bytes, status, 0xFFFFFF, EDCP_EXTENSION_NOT_USED, seed);
+    return SAE_J1939_Send_Response_DM15(j1939, DA, number_of_bytes, status, EDC_parameter, EDCP_EXTENSION_DATA_IN_EDC_PARAMETER_IS_ERROR_INDICATOR, seed);
+}
+
+static ENUM_J1939_STATUS_CODES Finish_Operation(J1939 *j1939, uint8_t status, uint32_t EDC_parameter) {
+    struct Memory_access *memory_access = &j1939->this_memory_access;
+    memory_access->is_open = false;
+    memory_access->is_sending = false;
+    TRACE_EVENT(TRACE_EVENT_MEMORY_ACCESS_DONE, pgn_value[PGN_DM14], memory_access->from_ecu_address, j1939->information_this_ECU.this_ECU_address, status);
+    return Send_Status(j1939, memory_access->from_ecu_address, memory_access->number_of_bytes, status, EDC_parameter, SEED_NO_KEY_USED);
+}
+
+/* The whole request must be inside one region. The unsigned subtraction makes addresses below the region very large */
+static struct Memory_region *Find_Region(J1939 *j1939, uint32_t address, uint16_t number_of_bytes, uint8_t *index) {
+    for (uint8_t i = 0; i < MAX_MEMORY_REGIONS; i++) {
+        struct Memory_region *region = &j1939->this_memory_access.regions[i];
+        uint32_t offset = address - region->address;
+        if (region->length > 0 && offset < region->length && number_of_bytes <= region->length - offset) {
+            *index = i;
+            return region;
+        }
+    }
+    return NULL;
+}
+
+/* The pointer extension in the highest byte of the address tells which memory that could not be written */
+static uint32_t Get_Write_Error(const struct Memory_region *region) {
+    switch (region->address >> 24) {
+    case POINTER_EXTENSION_DM14_FLASH_ACCESS:
+        return EDC_PARAMETER_NOT_VERIFY_FLASH_WRITE;
+    case POINTER_EXTENSION_DM14_EEPROM_ACCESS:
+        return EDC_PARAMETER_NOT_VERIFY_EEPROM_WRITE;
+    default:
+        return EDC_PARAMETER_NOT_VERIFY_RAM_WRITE;
+    }
+}
+
+/* The seed should not be easy to guess. Mix the clock into the last seed and skip the seed values that have a meaning */
+static uint16_t Create_Seed(J1939 *j1939) {
+    uint16_t seed = j1939->this_memory_access.seed;
+    do {
+        seed = seed * 25173 + 13849 + Clock_Get_Milliseconds();
+    } while (seed == SEED_NO_MORE_KEYS_NEED_FOR_THE_PROCESS || seed == SEED_USE_LONG_KEY || seed == SEED_NO_KEY_USED);
+    return seed;
+}
+
+/*
+ * Let other ECU reach a memory area of this ECU with DM14. address is (pointer extension << 24) | pointer, so the pointer extension
+ * POINTER_EXTENSION_DM14_FLASH_ACCESS, POINTER_EXTENSION_DM14_EEPROM_ACCESS or POINTER_EXTENSION_DM14_VARIABLE_ACCESS selects the memory.
+ * A callback that is NULL makes the region e.g read only. If key is not NULL, other ECU must answer a seed with the right key first.
+ * Returns false if the table is full or if the region overlaps another region
+ */
+bool SAE_J1939_Add_Memory_Region(J1939 *j1939, uint32_t address, uint32_t length, Memory_Read_Callback read, Memory_Write_Callback write, Memory_Erase_Callback erase, Memory_Key_Callback key, void *context) {
+    if (length == 0 || length - 1 > 0xFFFFFFFF - address)
+        return false;
+
+    uint8_t index = MAX_MEMORY_REGIONS;
+    for (uint8_t i = 0; i < MAX_MEMORY_REGIONS; i++) {
+        struct Memory_region *region = &j1939->this_memory_access.regions[i];
+        if (region->length == 0) {
+            if (index == MAX_MEMORY_REGIONS)
+                index = i;
+        } else if (address - region->address < region->length || region->address - address < length) {
+            return false;
+        }
+    }
+    if (index == MAX_MEMORY_REGIONS)
+        return false;
+
+    struct Memory_region *region = &j1939->this_memory_access.regions[index];
+    region->address = address;
+    region->length = length;
+    region->read = read;
+    region->write = write;
+    region->erase = erase;
+    region->key = key;
+    region->context = context;
+    return true;
+}
+
+/*
+ * Answer a DM14 memory request from other ECU with the memory regions of this ECU.
+ * Read is answered with DM15 proceed and the data is streamed with DM16 in chunks of MEMORY_ACCESS_CHUNK_SIZE bytes, read from the region directly into the Transport Protocol.
+ * Write is answered with DM15 proceed and every DM16 from the other ECU is written directly into the region. Erase is done at once.
+ * Every operation ends with DM15 operation completed or operation failed. Only one operation can be open at the time - Other ECU get DM15 busy
+ * PGN: 0x00D900 (55552)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Memory_Access_Request(J1939 *j1939, uint8_t SA, uint16_t number_of_requested_bytes, uint8_t pointer_type, uint8_t command, uint32_t pointer, uint8_t pointer_extension, uint16_t key) {
+    struct Memory_access *memory_access = &j1939->this_memory_access;
+
+    /* The other ECU tells that it is done */
+    if (command == COMMAND_DM14_OPERATION_COMPLETED || command == COMMAND_DM14_OPERATION_FAILED) {
+        if (memory_access->is_open && memory_access->from_ecu_address == SA)
+            memory_access->is_open = false;
+        return STATUS_SEND_OK;
+    }
+
+    /* A new request from the same ECU replaces the open operation */
+    if (memory_access->is_open && memory_access->from_ecu_address != SA)
+        return Send_Status(j1939, SA, number_of_requested_bytes, STATUS_DM15_BUSY, EDC_PARAMETER_PROCESSING_ERASE_REQUEST + memory_access->command, SEED_NO_KEY_USED);
+    memory_access->is_open = false;
+    if (command != COMMAND_DM14_ERASE && command != COMMAND_DM14_READ && command != COMMAND_DM14_WRITE)
+        return Send_Status(j1939, SA, number_of_requested_bytes, STATUS_DM15_OPERATION_FAILED, EDC_PARAMETER_ERROR_NOT_IDENTIFIED, SEED_NO_KEY_USED);
+
+    /* Only direct addressing - The pointer extension is the highest byte of the address */
+    uint32_t address = ((uint32_t)pointer_extension << 24) | pointer;
+    uint8_t index = 0;
+    struct Memory_region *region = NULL;
+    if (pointer_type == POINTER_TYPE_JOIN_POINTER_WITH_POINTER_EXTENSION && number_of_requested_bytes > 0)
+        region = Find_Region(j1939, address, number_of_requested_bytes, &index);
+    if (region == NULL)
+        return Send_Status(j1939, SA, number_of_requested_bytes, STATUS_DM15_OPERATION_FAILED, EDC_PARAMETER_ADDRESS_OUT_OF_BOUNDS, SEED_NO_KEY_USED);
+    if ((command == COMMAND_DM14_READ && region->read == NULL) || (command == COMMAND_DM14_WRITE && region->write == NULL) || (command == COMMAND_DM14_ERASE && region->erase == NULL))
+        return Send_Status(j1939, SA, number_of_requested_bytes, STATUS_DM15_OPERATION_FAILED, EDC_PARAMETER_ERROR_NOT_IDENTIFIED, SEED_NO_KEY_USED);
+
+    /* Seed and key - The first request gets a seed and the request is sent again with the key. Every seed can only be tried once */
+    uint16_t seed = SEED_NO_KEY_USED;
+    if (region->key != NULL) {
+        if (!memory_access->is_seed_sent || memory_access->seed_to_ecu_address != SA || key == USER_KEY_LEVEL_DM14_NO_KEY_AVAILABLE) {
+            memory_access->seed = Create_Seed(j1939);
+            memory_access->seed_to_ecu_address = SA;
+            memory_access->is_seed_sent = true;
+            return Send_Status(j1939, SA, number_of_requested_bytes, STATUS_DM15_PROCEED, EDC_PARAMETER_NO_ERROR, memory_access->seed);
+        }
+        memory_access->is_seed_sent = false;
+        if (key != region->key(region->context, memory_access->seed))
+            return Send_Status(j1939, SA, number_of_requested_bytes, STATUS_DM15_OPERATION_FAILED, EDC_PARAMETER_INVALID_KEY, SEED_NO_KEY_USED);
+        seed = SEED_NO_MORE_KEYS_NEED_FOR_THE_PROCESS;
+    }
+
+    /* Open the operation */
+    memory_access->is_open = true;
+    memory_access->is_sending = false;
+    memory_access->command = command;
+    memory_access->from_ecu_address = SA;
+    memory_access->region_index = index;
+    memory_access->offset = address - region->address;
+    memory_access->number_of_bytes = number_of_requested_bytes;
+    memory_access->remaining_bytes = number_of_requested_bytes;
+    memory_access->time_stamp = Clock_Get_Milliseconds();
+    ENUM_J1939_STATUS_CODES status = Send_Status(j1939, SA, number_of_requested_bytes, STATUS_DM15_PROCEED, EDC_PARAMETER_NO_ERROR, seed);
+    if (status != STATUS_SEND_OK) {
+        memory_access->is_open = false;
+        return status;
+    }
+
+    if (command == COMMAND_DM14_ERASE) {
+        if (region->erase(region->context, memory_access->offset, number_of_requested_bytes))
+            return Finish_Operation(j1939, STATUS_DM15_OPERATION_COMPLETED, EDC_PARAMETER_NO_ERROR);
+        return Finish_Operation(j1939, STATUS_DM15_OPERATION_FAILED, Get_Write_Error(region));
+    }
+    if (command == COMMAND_DM14_READ)
+        SAE_J1939_Memory_Access_Process(j1939);
+    return status;
+}
+
+/*
+ * Write a DM16 from other ECU into the region of the open write operation. This is called from SAE_J1939_Read_Binary_Data_Transfer_DM16
+ * PGN: 0x00D700 (55040)
+ */
+void SAE_J1939_Memory_Access_Binary_Data(J1939 *j1939, uint8_t SA, uint8_t number_of_occurences, const uint8_t raw_binary_data[]) {
+    struct Memory_access *memory_access = &j1939->this_memory_access;
+    if (!memory_access->is_open || memory_access->command != COMMAND_DM14_WRITE || memory_access->from_ecu_address != SA)
+        return;
+
+    struct Memory_region *region = &memory_access->regions[memory_access->region_index];
+    if (number_of_occurences > memory_access->remaining_bytes) {
+        Finish_Operation(j1939, STATUS_DM15_OPERATION_FAILED, EDC_PARAMETER_ADDRESS_OUT_OF_BOUNDS);
+        return;
+    }
+    if (!region->write(region->context, memory_access->offset, raw_binary_data, number_of_occurences)) {
+        Finish_Operation(j1939, STATUS_DM15_OPERATION_FAILED, Get_Write_Error(region));
+        return;
+    }
+    memory_access->offset += number_of_occurences;
+    memory_access->remaining_bytes -= number_of_occurences;
+    memory_access->time_stamp = Clock_Get_Milliseconds();
+    if (memory_access->remaining_bytes == 0)
+        Finish_Operation(j1939, STATUS_DM15_OPERATION_COMPLETED, EDC_PARAMETER_NO_ERROR);
+}
+
+/*
+ * Send the next DM16 chunk of the open read operation when the Transport Protocol of this ECU is free, and fail the operations that have been quiet for too long.
+ * The chunk is read from the region directly into the Transport Protocol buffer, so a read needs no more RAM than one chunk.
+ * This is called from Open_SAE_J1939_Listen_For_Messages
+ * PGN: 0x00D700 (55040)
+ */
+void SAE_J1939_Memory_Access_Process(J1939 *j1939) {
+    struct Memory_access *memory_access = &j1939->this_memory_access;
+    if (!memory_access->is_open)
+        return;
+    uint32_t now = Clock_Get_Milliseconds();
+
+    if (memory_access->command == COMMAND_DM14_READ) {
+        /* The last chunk or another message is still on its way - The Transport Protocol has its own timeouts */
+        struct TP_CM *tx = SAE_J1939_Get_Transport_Protocol_Transmit_Session(j1939);
+        if (tx->timeout > 0) {
+            memory_access->time_stamp = now;
+            return;
+        }
+        if (memory_access->is_sending) {
+            memory_access->is_sending = false;
+            if (tx->control_byte == CONTROL_BYTE_TP_CM_ABORT || tx->control_byte == CONTROL_BYTE_FD_TP_CM_ABORT) {
+                Finish_Operation(j1939, STATUS_DM15_OPERATION_FAILED, EDC_PARAMETER_ERROR_NOT_IDENTIFIED);
+                return;
+            }
+        }
+        if (memory_access->remaining_bytes == 0) {
+            Finish_Operation(j1939, STATUS_DM15_OPERATION_COMPLETED, EDC_PARAMETER_NO_ERROR);
+            return;
+        }
+
+        /* DM16 puts the number of occurrences in front of the data */
+        struct Memory_region *region = &memory_access->regions[memory_access->region_index];
+        uint8_t number_of_occurences = memory_access->remaining_bytes < MEMORY_ACCESS_CHUNK_SIZE ? memory_access->remaining_bytes : MEMORY_ACCESS_CHUNK_SIZE;
+        uint8_t *buffer = SAE_J1939_Get_Transport_Protocol_Transmit_Buffer(j1939, number_of_occurences + 1);
+        if (buffer == NULL)
+            return;                                                                             /* Try again when the pool has a free block */
+        uint8_t *raw_binary_data = &buffer[1];
+        if (!region->read(region->context, memory_access->offset, raw_binary_data, number_of_occurences)) {
+            Finish_Operation(j1939, STATUS_DM15_OPERATION_FAILED, EDC_PARAMETER_ERROR_NOT_IDENTIFIED);
+            return;
+        }
+        if (SAE_J1939_Send_Binary_Data_Transfer_DM16(j1939, memory_access->from_ecu_address, number_of_occurences, raw_binary_data) != STATUS_SEND_OK) {
+            Finish_Operation(j1939, STATUS_DM15_OPERATION_FAILED, EDC_PARAMETER_ERROR_NOT_IDENTIFIED);
+            return;
+        }
+        memory_access->is_sending = number_of_occurences >= 8;
+        memory_access->offset += number_of_occurences;
+        memory_access->remaining_bytes -= number_of_occurences;
+        memory_access->time_stamp = now;
+        if (memory_access->remaining_bytes == 0 && !memory_access->is_sending)
+            Finish_Operation(j1939, STATUS_DM15_OPERATION_COMPLETED, EDC_PARAMETER_NO_ERROR);
+        return;
+    }
+
+    /* Write waits for DM16 from the other ECU */
+    if ((uint32_t)(now - memory_access->time_stamp) >= MEMORY_ACCESS_TIMEOUT)
+        Finish_Operation(j1939, STATUS_DM15_OPERATION_FAILED, EDC_PARAMETER_NO_RESPONSE_IN_TIME);
+}
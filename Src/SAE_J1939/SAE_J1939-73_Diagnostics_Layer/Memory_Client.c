@@ -0,0 +1,274 @@
+/*
+ * Memory_Client.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Diagnostics_Layer.h"
+
+/* Layers */
+#include "../SAE_J1939-21_Transport_Layer/Transport_Layer.h"
+#include "../../Hardware/Hardware.h"
+
+/* C standard library */
+#include <stddef.h>
+
+/* Internal functions */
+/* CRC-16/CCITT with polynomial 0x1021 and start value 0xFFFF */
+static uint16_t Update_Checksum(uint16_t checksum, const uint8_t data[], uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        checksum ^= data[i] << 8;
+        for (uint8_t j = 0; j < 8; j++)
+            checksum = checksum & 0x8000 ? (checksum << 1) ^ 0x1021 : checksum << 1;
+    }
+    return checksum;
+}
+
+/* The operation is free before a final status is reported, so the callback can start a new operation directly */
+static void Report(J1939 *j1939, uint8_t status, uint32_t EDC_parameter) {
+    struct Memory_client *memory_client = &j1939->this_memory_client;
+    struct Memory_client_status memory_client_status = {0};
+    memory_client_status.status = status;
+    memory_client_status.from_ecu_address = memory_client->DA;
+    memory_client_status.address = memory_client->address;
+    memory_client_status.length = memory_client->length;
+    memory_client_status.transferred_bytes = memory_client->transferred_bytes;
+    memory_client_status.checksum = memory_client->checksum;
+    memory_client_status.EDC_parameter = EDC_parameter;
+    Memory_Client_Callback callback = memory_client->callback;
+    void *context = memory_client->context;
+    if (status >= MEMORY_CLIENT_STATUS_COMPLETED)
+        memory_client->callback = NULL;
+    callback(&memory_client_status, context);
+}
+
+/* A failed send is treated as busy, so it's sent again after MEMORY_CLIENT_BUSY_DELAY */
+static ENUM_J1939_STATUS_CODES Send_Request(J1939 *j1939, uint16_t key) {
+    struct Memory_client *memory_client = &j1939->this_memory_client;
+    memory_client->time_stamp = Clock_Get_Milliseconds();
+    memory_client->is_data_sent = false;
+    ENUM_J1939_STATUS_CODES status = SAE_J1939_Send_Request_DM14(j1939, memory_client->DA, memory_client->request_bytes, POINTER_TYPE_JOIN_POINTER_WITH_POINTER_EXTENSION, memory_client->command, memory_client->request_address & 0xFFFFFF, memory_client->request_address >> 24, key);
+    memory_client->is_busy = status != STATUS_SEND_OK;
+    return status;
+}
+
+/* Ask for the next chunk. A chunk never crosses a pointer extension, because the pointer is only 24 bits */
+static ENUM_J1939_STATUS_CODES Request_Next_Chunk(J1939 *j1939) {
+    struct Memory_client *memory_client = &j1939->this_memory_client;
+    uint32_t request_address = memory_client->address + memory_client->requested_bytes;
+    uint32_t number_of_bytes = memory_client->length - memory_client->requested_bytes;
+    if (number_of_bytes > MEMORY_CLIENT_CHUNK_SIZE)
+        number_of_bytes = MEMORY_CLIENT_CHUNK_SIZE;
+    if (number_of_bytes > 0x1000000 - (request_address & 0xFFFFFF))
+        number_of_bytes = 0x1000000 - (request_address & 0xFFFFFF);
+    memory_client->request_address = request_address;
+    memory_client->request_bytes = number_of_bytes;
+    memory_client->requested_bytes += number_of_bytes;
+    memory_client->busy_retries = 0;
+    return Send_Request(j1939, USER_KEY_LEVEL_DM14_NO_KEY_AVAILABLE);
+}
+
+/* Read the chunk from the source directly into the Transport Protocol buffer and send it with DM16 */
+static void Send_Data(J1939 *j1939) {
+    struct Memory_client *memory_client = &j1939->this_memory_client;
+    memory_client->is_data_waiting = true;
+    uint8_t *buffer = SAE_J1939_Get_Transport_Protocol_Transmit_Buffer(j1939, memory_client->request_bytes + 1);
+    if (buffer == NULL)
+        return;
+    uint8_t *raw_binary_data = &buffer[1];
+    if (!memory_client->source(memory_client->context, memory_client->request_address - memory_client->address, raw_binary_data, memory_client->request_bytes)) {
+        Report(j1939, MEMORY_CLIENT_STATUS_FAILED, EDC_PARAMETER_ERROR_NOT_IDENTIFIED);
+        return;
+    }
+    if (SAE_J1939_Send_Binary_Data_Transfer_DM16(j1939, memory_client->DA, memory_client->request_bytes, raw_binary_data) != STATUS_SEND_OK)
+        return;
+    memory_client->checksum = Update_Checksum(memory_client->checksum, raw_binary_data, memory_client->request_bytes);
+    memory_client->is_data_waiting = false;
+    memory_client->is_data_sent = true;
+    memory_client->time_stamp = Clock_Get_Milliseconds();
+}
+
+/* Ask for the next chunk as soon as the last one is done, so the other ECU does not wait for us. Then tell the progress */
+static void Chunk_Done(J1939 *j1939) {
+    struct Memory_client *memory_client = &j1939->this_memory_client;
+    if (memory_client->transferred_bytes < memory_client->length) {
+        if (memory_client->transferred_bytes == memory_client->requested_bytes)
+            Request_Next_Chunk(j1939);
+        Report(j1939, memory_client->is_verifying ? MEMORY_CLIENT_STATUS_VERIFYING : MEMORY_CLIENT_STATUS_PROGRESS, EDC_PARAMETER_NO_ERROR);
+        return;
+    }
+
+    /* Read back what has been written */
+    if (memory_client->command == COMMAND_DM14_WRITE && memory_client->verify) {
+        memory_client->is_verifying = true;
+        memory_client->command = COMMAND_DM14_READ;
+        memory_client->written_checksum = memory_client->checksum;
+        memory_client->checksum = 0xFFFF;
+        memory_client->requested_bytes = 0;
+        memory_client->transferred_bytes = 0;
+        Request_Next_Chunk(j1939);
+        Report(j1939, MEMORY_CLIENT_STATUS_VERIFYING, EDC_PARAMETER_NO_ERROR);
+        return;
+    }
+    if (memory_client->is_verifying && memory_client->checksum != memory_client->written_checksum)
+        Report(j1939, MEMORY_CLIENT_STATUS_VERIFY_FAILED, EDC_PARAMETER_NO_ERROR);
+    else
+        Report(j1939, MEMORY_CLIENT_STATUS_COMPLETED, EDC_PARAMETER_NO_ERROR);
+}
+
+static ENUM_J1939_STATUS_CODES Start_Operation(J1939 *j1939, uint8_t DA, uint8_t command, uint32_t address, uint32_t length, Memory_Key_Callback key, Memory_Client_Callback callback, void *context) {
+    struct Memory_client *memory_client = &j1939->this_memory_client;
+    memory_client->DA = DA;
+    memory_client->command = command;
+    memory_client->address = address;
+    memory_client->length = length;
+    memory_client->key = key;
+    memory_client->callback = callback;
+    memory_client->context = context;
+    memory_client->is_verifying = false;
+    memory_client->is_data_waiting = false;
+    memory_client->requested_bytes = 0;
+    memory_client->transferred_bytes = 0;
+    memory_client->checksum = 0xFFFF;
+    ENUM_J1939_STATUS_CODES status = Request_Next_Chunk(j1939);
+    if (status != STATUS_SEND_OK)
+        memory_client->callback = NULL;
+    return status;
+}
+
+/*
+ * Read length bytes from address at other ECU. address is (pointer extension << 24) | pointer. The range is split into DM14 requests of MEMORY_CLIENT_CHUNK_SIZE bytes
+ * and the next DM14 is sent as soon as the DM16 of the last one has arrived. Every DM16 is given to destination, with offset counted from address.
+ * callback is called with MEMORY_CLIENT_STATUS_PROGRESS after every chunk and last with completed, failed or timeout. key can be NULL if the other ECU needs no key.
+ * Returns STATUS_SEND_BUSY if another operation is in progress
+ * PGN: 0x00D900 (55552)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Memory_Client_Read(J1939 *j1939, uint8_t DA, uint32_t address, uint32_t length, Memory_Write_Callback destination, Memory_Key_Callback key, Memory_Client_Callback callback, void *context) {
+    if (destination == NULL || callback == NULL || length == 0 || length - 1 > 0xFFFFFFFF - address)
+        return STATUS_SEND_ERROR;
+    if (j1939->this_memory_client.callback != NULL)
+        return STATUS_SEND_BUSY;
+    j1939->this_memory_client.destination = destination;
+    j1939->this_memory_client.verify = false;
+    return Start_Operation(j1939, DA, COMMAND_DM14_READ, address, length, key, callback, context);
+}
+
+/*
+ * Write length bytes to address at other ECU. The bytes are taken from source chunk by chunk, with offset counted from address, and sent with DM16.
+ * If verify is true, the range is read back when everything is written and the checksum must be the same, else the callback gets MEMORY_CLIENT_STATUS_VERIFY_FAILED.
+ * Returns STATUS_SEND_BUSY if another operation is in progress
+ * PGN: 0x00D900 (55552)
+ */
+ENUM_J1939_STATUS_CODES SAE_J1939_Memory_Client_Write(J1939 *j1939, uint8_t DA, uint32_t address, uint32_t length, Memory_Read_Callback source, bool verify, Memory_Key_Callback key, Memory_Client_Callback callback, void *context) {
+    if (source == NULL || callback == NULL || length == 0 || length - 1 > 0xFFFFFFFF - address)
+        return STATUS_SEND_ERROR;
+    if (j1939->this_memory_client.callback != NULL)
+        return STATUS_SEND_BUSY;
+    j1939->this_memory_client.source = source;
+    j1939->this_memory_client.verify = verify;
+    return Start_Operation(j1939, DA, COMMAND_DM14_WRITE, address, length, key, callback, context);
+}
+
+/* Stop the operation and tell the other ECU with DM14 operation failed. The callback will not be called */
+void SAE_J1939_Memory_Client_Cancel(J1939 *j1939) {
+    struct Memory_client *memory_client = &j1939->this_memory_client;
+    if (memory_client->callback == NULL)
+        return;
+    memory_client->callback = NULL;
+    SAE_J1939_Send_Request_DM14(j1939, memory_client->DA, memory_client->request_bytes, POINTER_TYPE_JOIN_POINTER_WITH_POINTER_EXTENSION, COMMAND_DM14_OPERATION_FAILED, memory_client->request_address & 0xFFFFFF, memory_client->request_address >> 24, USER_KEY_LEVEL_DM14_NO_KEY_AVAILABLE);
+}
+
+/*
+ * Follow the DM15 answer from the other ECU. This is called from SAE_J1939_Read_Response_DM15
+ * PGN: 0x00D800 (55296)
+ */
+void SAE_J1939_Memory_Client_Response_DM15(J1939 *j1939, uint8_t SA) {
+    struct Memory_client *memory_client = &j1939->this_memory_client;
+    struct DM15 *dm15 = &j1939->from_other_ecu_dm.dm15;
+    if (memory_client->callback == NULL || memory_client->DA != SA)
+        return;
+    memory_client->time_stamp = Clock_Get_Milliseconds();
+
+    switch (dm15->status) {
+    case STATUS_DM15_PROCEED:
+        /* Send the same DM14 again with the key */
+        if (dm15->seed != SEED_NO_KEY_USED && dm15->seed != SEED_NO_MORE_KEYS_NEED_FOR_THE_PROCESS) {
+            if (memory_client->key == NULL)
+                Report(j1939, MEMORY_CLIENT_STATUS_FAILED, EDC_PARAMETER_INVALID_KEY);
+            else
+                Send_Request(j1939, memory_client->key(memory_client->context, dm15->seed));
+            return;
+        }
+        if (memory_client->command == COMMAND_DM14_WRITE && !memory_client->is_data_sent)
+            Send_Data(j1939);
+        break;
+    case STATUS_DM15_BUSY:
+        memory_client->is_busy = true;
+        break;
+    case STATUS_DM15_OPERATION_COMPLETED:
+        /* A read is done when its DM16 has arrived */
+        if (memory_client->command == COMMAND_DM14_WRITE && memory_client->is_data_sent) {
+            memory_client->is_data_sent = false;
+            memory_client->transferred_bytes += memory_client->request_bytes;
+            Chunk_Done(j1939);
+        }
+        break;
+    default:
+        Report(j1939, MEMORY_CLIENT_STATUS_FAILED, dm15->EDC_parameter);
+        break;
+    }
+}
+
+/*
+ * Give the read bytes to the destination. This is called from SAE_J1939_Read_Binary_Data_Transfer_DM16
+ * PGN: 0x00D700 (55040)
+ */
+void SAE_J1939_Memory_Client_Binary_Data(J1939 *j1939, uint8_t SA, uint8_t number_of_occurences, const uint8_t raw_binary_data[]) {
+    struct Memory_client *memory_client = &j1939->this_memory_client;
+    if (memory_client->callback == NULL || memory_client->DA != SA || memory_client->command != COMMAND_DM14_READ)
+        return;
+    if (number_of_occurences > memory_client->requested_bytes - memory_client->transferred_bytes) {
+        Report(j1939, MEMORY_CLIENT_STATUS_FAILED, EDC_PARAMETER_ERROR_NOT_IDENTIFIED);
+        return;
+    }
+    if (!memory_client->is_verifying && !memory_client->destination(memory_client->context, memory_client->transferred_bytes, raw_binary_data, number_of_occurences)) {
+        Report(j1939, MEMORY_CLIENT_STATUS_FAILED, EDC_PARAMETER_ERROR_NOT_IDENTIFIED);
+        return;
+    }
+    memory_client->checksum = Update_Checksum(memory_client->checksum, raw_binary_data, number_of_occurences);
+    memory_client->transferred_bytes += number_of_occurences;
+    memory_client->time_stamp = Clock_Get_Milliseconds();
+    Chunk_Done(j1939);
+}
+
+/*
+ * Send the DM16 that waits for the Transport Protocol, ask again when the other ECU was busy and time out when the other ECU is quiet.
+ * This is called from Open_SAE_J1939_Listen_For_Messages
+ */
+void SAE_J1939_Memory_Client_Process(J1939 *j1939) {
+    struct Memory_client *memory_client = &j1939->this_memory_client;
+    if (memory_client->callback == NULL)
+        return;
+    uint32_t now = Clock_Get_Milliseconds();
+
+    /* Data is on its way with the Transport Protocol or the FD Transport Protocol */
+    struct TP_CM *rx = &j1939->from_other_ecu_tp_cm;
+    struct TP_CM *rx_fd = &j1939->from_other_ecu_fd_tp_cm;
+    struct TP_CM *tx = SAE_J1939_Get_Transport_Protocol_Transmit_Session(j1939);
+    if ((rx->timeout > 0 && rx->from_ecu_address == memory_client->DA) || (rx_fd->timeout > 0 && rx_fd->from_ecu_address == memory_client->DA) || (tx->timeout > 0 && tx->to_ecu_address == memory_client->DA)) {
+        memory_client->time_stamp = now;
+        return;
+    }
+
+    if ((uint32_t)(now - memory_client->time_stamp) >= MEMORY_ACCESS_TIMEOUT) {
+        Report(j1939, MEMORY_CLIENT_STATUS_TIMEOUT, EDC_PARAMETER_NO_RESPONSE_IN_TIME);
+    } else if (memory_client->is_data_waiting) {
+        Send_Data(j1939);
+    } else if (memory_client->is_busy && (uint32_t)(now - memory_client->time_stamp) >= MEMORY_CLIENT_BUSY_DELAY) {
+        if (++memory_client->busy_retries > MEMORY_CLIENT_MAX_BUSY_RETRIES)
+            Report(j1939, MEMORY_CLIENT_STATUS_FAILED, EDC_PARAMETER_PROCESSING_ERASE_REQUEST + memory_client->command);
+        else
+            Send_Request(j1939, USER_KEY_LEVEL_DM14_NO_KEY_AVAILABLE);
+    }
+}
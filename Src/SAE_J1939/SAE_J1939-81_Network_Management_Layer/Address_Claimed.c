@@ -23,22 +23,36 @@ ENUM_J1939_STATUS_CODES SAE_J1939_Send_Request_Address_Claimed(J1939 *j1939, uin
 	return SAE_J1939_Send_Request(j1939, DA, pgn_value[PGN_ADDRESS_CLAIMED]);
 }
 
+/*
+ * Get the NAME of this ECU as 8 bytes. The NAME is encoded once into the response cache and reused until information_this_ECU changes
+ * PGN: 0x00EE00 (60928)
+ */
+uint8_t *SAE_J1939_Get_Encoded_Name(J1939 *j1939) {
+	uint8_t *name = j1939->this_response_cache.name;
+	if(!j1939->this_response_cache.name_is_encoded) {
+		name[0] = j1939->information_this_ECU.this_name.identity_number;
+		name[1] = j1939->information_this_ECU.this_name.identity_number >> 8;
+		name[2] = (j1939->information_this_ECU.this_name.identity_number >> 16) |  (j1939->information_this_ECU.this_name.manufacturer_code << 5);
+		name[3] = j1939->information_this_ECU.this_name.manufacturer_code >> 3;
+		name[4] = (j1939->information_this_ECU.this_name.function_instance << 3) | j1939->information_this_ECU.this_name.ECU_instance;
+		name[5] = j1939->information_this_ECU.this_name.function;
+		name[6] = j1939->information_this_ECU.this_name.vehicle_system << 1;
+		name[7] = (j1939->information_this_ECU.this_name.arbitrary_address_capable << 7) | (j1939->information_this_ECU.this_name.industry_group << 4) | j1939->information_this_ECU.this_name.vehicle_system_instance;
+		j1939->this_response_cache.name_is_encoded = true;
+	}
+	return name;
+}
+
 /*
  * Response the request address claimed about this ECU to all ECU - Broadcast. This function must be called at the ECU start up according to J1939 standard
  * PGN: 0x00EE00 (60928)
  */
 ENUM_J1939_STATUS_CODES SAE_J1939_Response_Request_Address_Claimed(J1939 *j1939) {
 	uint32_t ID = (0x18EEFF << 8) | j1939->information_this_ECU.this_ECU_address;
-	uint8_t data[8];
-	data[0] = j1939->information_this_ECU.this_name.identity_number;
-	data[1] = j1939->information_this_ECU.this_name.identity_number >> 8;
-	data[2] = (j1939->information_this_ECU.this_name.identity_number >> 16) |  (j1939->information_this_ECU.this_name.manufacturer_code << 5);
-	data[3] = j1939->information_this_ECU.this_name.manufacturer_code >> 3;
-	data[4] = (j1939->information_this_ECU.this_name.function_instance << 3) | j1939->information_this_ECU.this_name.ECU_instance;
-	data[5] = j1939->information_this_ECU.this_name.function;
-	data[6] = j1939->information_this_ECU.this_name.vehicle_system << 1;
-	data[7] = (j1939->information_this_ECU.this_name.arbitrary_address_capable << 7) | (j1939->information_this_ECU.this_name.industry_group << 4) | j1939->information_this_ECU.this_name.vehicle_system_instance;
-	return CAN_Send_Message(ID, data);
+	ENUM_J1939_STATUS_CODES status = CAN_Send_Message(ID, SAE_J1939_Get_Encoded_Name(j1939));
+	if(status == STATUS_SEND_OK)
+		TRACE_EVENT(TRACE_EVENT_ADDRESS_CLAIMED, pgn_value[PGN_ADDRESS_CLAIMED], j1939->information_this_ECU.this_ECU_address, 0xFF, 0);
+	return status;
 }
 
 /*
@@ -47,8 +61,10 @@ ENUM_J1939_STATUS_CODES SAE_J1939_Response_Request_Address_Claimed(J1939 *j1939)
  */
 void SAE_J1939_Read_Response_Request_Address_Claimed(J1939 *j1939, uint8_t SA, uint8_t data[]) {
 	/* Check if it's the same address */
-	if(j1939->information_this_ECU.this_ECU_address == SA)
+	if(j1939->information_this_ECU.this_ECU_address == SA){
+		TRACE_EVENT(TRACE_EVENT_ADDRESS_CLAIM_LOST, pgn_value[PGN_ADDRESS_CLAIMED], SA, 0xFF, 0);
 		SAE_J1939_Send_Address_Not_Claimed(j1939);
+	}
 
 	/* If not, then store the temporary information */
 	j1939->from_other_ecu_name.identity_number = ((data[2] & 0b00011111) << 16) | (data[1] << 8) | data[0];
@@ -16,16 +16,7 @@
  */
 ENUM_J1939_STATUS_CODES SAE_J1939_Send_Address_Not_Claimed(J1939 *j1939) {
 	uint32_t ID = 0x18EEFFFE;
-	uint8_t data[8];
-	data[0] = j1939->information_this_ECU.this_name.identity_number;
-	data[1] = j1939->information_this_ECU.this_name.identity_number >> 8;
-	data[2] = (j1939->information_this_ECU.this_name.identity_number >> 16) |  (j1939->information_this_ECU.this_name.manufacturer_code << 5);
-	data[3] = j1939->information_this_ECU.this_name.manufacturer_code >> 3;
-	data[4] = (j1939->information_this_ECU.this_name.function_instance << 3) | j1939->information_this_ECU.this_name.ECU_instance;
-	data[5] = j1939->information_this_ECU.this_name.function;
-	data[6] = j1939->information_this_ECU.this_name.vehicle_system << 1;
-	data[7] = (j1939->information_this_ECU.this_name.arbitrary_address_capable << 7) | (j1939->information_this_ECU.this_name.industry_group << 4) | j1939->information_this_ECU.this_name.vehicle_system_instance;
-	return CAN_Send_Message(ID, data);
+	return CAN_Send_Message(ID, SAE_J1939_Get_Encoded_Name(j1939));
 }
 
 /*
@@ -44,5 +35,6 @@ void SAE_J1939_Read_Address_Not_Claimed(J1939 *j1939, uint8_t SA, uint8_t data[]
 	j1939->from_other_ecu_name.vehicle_system_instance = data[7] & 0b00001111;
 	j1939->from_other_ecu_name.from_ecu_address = SA;
 	j1939->number_of_cannot_claim_address++;
+	TRACE_EVENT(TRACE_EVENT_ADDRESS_CANNOT_CLAIM, pgn_value[PGN_ADDRESS_CLAIMED], SA, 0xFF, 0);
 }
 
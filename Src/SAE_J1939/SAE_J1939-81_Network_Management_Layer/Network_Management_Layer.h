@@ -28,6 +28,7 @@ extern "C" {
 /* Address claimed */
 ENUM_J1939_STATUS_CODES SAE_J1939_Send_Request_Address_Claimed(J1939 *j1939, uint8_t DA);
 ENUM_J1939_STATUS_CODES SAE_J1939_Response_Request_Address_Claimed(J1939 *j1939);
+uint8_t *SAE_J1939_Get_Encoded_Name(J1939 *j1939);
 void SAE_J1939_Read_Response_Request_Address_Claimed(J1939 *j1939, uint8_t SA, uint8_t data[]);
 
 /* Address not claimed */
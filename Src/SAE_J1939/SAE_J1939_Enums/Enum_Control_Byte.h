@@ -18,7 +18,14 @@ typedef enum {
 	CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_SUPPORTED = 0x0,
 	CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_NOT_SUPPORTED = 0x1,
 	CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_ACCESS_DENIED = 0x2,
-	CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_BUSY = 0x3
+	CONTROL_BYTE_ACKNOWLEDGEMENT_PGN_BUSY = 0x3,
+	/* FD Transport Protocol - SAE J1939-22. The control byte is the lowest 4 bits of byte 1 and the session number is the highest 4 bits */
+	CONTROL_BYTE_FD_TP_CM_RTS = 0x0,
+	CONTROL_BYTE_FD_TP_CM_CTS = 0x1,
+	CONTROL_BYTE_FD_TP_CM_EndOfMsgStatus = 0x2,
+	CONTROL_BYTE_FD_TP_CM_EndOfMsgACK = 0x3,
+	CONTROL_BYTE_FD_TP_CM_BAM = 0x4,
+	CONTROL_BYTE_FD_TP_CM_ABORT = 0xF
 	/* Add more control bytes here */
 }ENUM_CONTROL_BYTES_CODES;
 
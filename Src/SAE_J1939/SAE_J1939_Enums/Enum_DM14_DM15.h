@@ -23,6 +23,8 @@ typedef enum {
 	EDCP_EXTENSION_DATA_IN_EDC_PARAMETER_IS_ERROR_INDICATOR_SEED_IS_TIME_TO_COMPLETE = 0x7,
 	EDCP_EXTENSION_NOT_USED = 0xFF,
 	/* EDC parameter */
+	EDC_PARAMETER_NO_ERROR = 0x0,
+	EDC_PARAMETER_ERROR_NOT_IDENTIFIED = 0x1,
 	EDC_PARAMETER_PROCESSING_ERASE_REQUEST = 0x10,
 	EDC_PARAMETER_PROCESSING_READ_REQUEST = 0x11,
 	EDC_PARAMETER_PROCESSING_WRITE_REQUEST = 0x12,
@@ -31,7 +33,9 @@ typedef enum {
 	EDC_PARAMETER_NOT_VERIFY_RAM_WRITE = 0x21,
 	EDC_PARAMETER_NOT_VERIFY_FLASH_WRITE = 0x22,
 	EDC_PARAMETER_NOT_VERIFY_EEPROM_WRITE = 0x23,
+	EDC_PARAMETER_NO_RESPONSE_IN_TIME = 0x1002,
 	EDC_PARAMETER_INVALID_KEY = 0x1003,
+	EDC_PARAMETER_ADDRESS_OUT_OF_BOUNDS = 0x10003,
 	/* Seed */
 	SEED_NO_MORE_KEYS_NEED_FOR_THE_PROCESS = 0x0,
 	SEED_USE_LONG_KEY = 0x1,
@@ -40,11 +44,14 @@ typedef enum {
 
 typedef enum {
 	/* Command */
+	COMMAND_DM14_ERASE = 0x0,
 	COMMAND_DM14_READ = 0x1,
 	COMMAND_DM14_WRITE = 0x2,
+	COMMAND_DM14_STATUS_REQUEST = 0x3,
 	COMMAND_DM14_OPERATION_COMPLETED = 0x4,
 	COMMAND_DM14_OPERATION_FAILED = 0x5,
 	COMMAND_DM14_BOOT_LOAD = 0x6,
+	COMMAND_DM14_EDCP_GENERATION = 0x7,
 	/* Pointer type */
 	POINTER_TYPE_JOIN_POINTER_WITH_POINTER_EXTENSION = 0x0,
 	POINTER_TYPE_POINTER_EXTENSION_IS_A_COMMAND = 0x1,
@@ -8,12 +8,18 @@
 #ifndef SAE_J1939_ENUMS_SAE_J1939_ENUM_GROUP_FUNCTION_VALUE_H_
 #define SAE_J1939_ENUMS_SAE_J1939_ENUM_GROUP_FUNCTION_VALUE_H_
 
-/* Enums for the acknowledgements */
+/* Enums for the acknowledgements and the connection abort reasons */
 typedef enum {
 	GROUP_FUNCTION_VALUE_NORMAL = 0x0,
 	GROUP_FUNCTION_VALUE_CANNOT_MAINTAIN_ANOTHER_CONNECTION = 0x1,
 	GROUP_FUNCTION_VALUE_LACKING_NECESSARY_RESOURCES = 0x2,
 	GROUP_FUNCTION_VALUE_ABORT_TIME_OUT = 0x3,
+	GROUP_FUNCTION_VALUE_CTS_WHILE_DATA_TRANSFER_IN_PROGRESS = 0x4,
+	GROUP_FUNCTION_VALUE_MAXIMUM_RETRANSMIT_REQUEST_REACHED = 0x5,
+	GROUP_FUNCTION_VALUE_UNEXPECTED_DATA_TRANSFER_PACKET = 0x6,
+	GROUP_FUNCTION_VALUE_BAD_SEQUENCE_NUMBER = 0x7,
+	GROUP_FUNCTION_VALUE_DUPLICATE_SEQUENCE_NUMBER = 0x8,
+	GROUP_FUNCTION_VALUE_TOTAL_MESSAGE_SIZE_TOO_LARGE = 0x9,
 	GROUP_FUNCTION_VALUE_NO_CAUSE = 0xFF
 } ENUM_GROUP_FUNCTION_VALUE_CODES;
 
@@ -0,0 +1,21 @@
+/*
+ * Enum_Memory_Client_Status.h
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#ifndef SAE_J1939_ENUMS_SAE_J1939_ENUM_MEMORY_CLIENT_STATUS_H_
+#define SAE_J1939_ENUMS_SAE_J1939_ENUM_MEMORY_CLIENT_STATUS_H_
+
+/* How a DM14 memory read or write from this ECU is going */
+typedef enum {
+	MEMORY_CLIENT_STATUS_PROGRESS = 0x0,
+	MEMORY_CLIENT_STATUS_VERIFYING = 0x1,
+	MEMORY_CLIENT_STATUS_COMPLETED = 0x2,
+	MEMORY_CLIENT_STATUS_FAILED = 0x3,
+	MEMORY_CLIENT_STATUS_TIMEOUT = 0x4,
+	MEMORY_CLIENT_STATUS_VERIFY_FAILED = 0x5
+} ENUM_MEMORY_CLIENT_STATUS_CODES;
+
+#endif /* SAE_J1939_ENUMS_SAE_J1939_ENUM_MEMORY_CLIENT_STATUS_H_ */
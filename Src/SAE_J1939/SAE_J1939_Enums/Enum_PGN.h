@@ -8,162 +8,119 @@
 #ifndef SAE_J1939_ENUMS_SAE_J1939_ENUM_PGN_H_
 #define SAE_J1939_ENUMS_SAE_J1939_ENUM_PGN_H_
 
-/* PGN enums */
-typedef enum {
-    PGN_ADDRESS_DELETE,
-    PGN_REQUEST,
-    PGN_ACKNOWLEDGEMENT,
-    PGN_TP_CM,
-    PGN_TP_DT,
-    PGN_ADDRESS_CLAIMED,
-    PGN_COMMANDED_ADDRESS,
-    PGN_DM1,
-    PGN_DM2,
-    PGN_DM3,
-    PGN_DM14,
-    PGN_DM15,
-    PGN_DM16,
-    PGN_SOFTWARE_IDENTIFICATION,
-    PGN_ECU_IDENTIFICATION,
-    PGN_COMPONENT_IDENTIFICATION,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_0,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_1,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_2,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_3,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_4,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_5,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_6,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_7,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_8,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_9,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_10,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_11,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_12,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_13,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_14,
-    PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_15,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_0,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_1,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_2,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_3,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_4,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_5,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_6,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_7,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_8,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_9,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_10,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_11,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_12,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_13,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_14,
-    PGN_AUXILIARY_VALVE_MEASURED_POSITION_15,
-    PGN_AUXILIARY_VALVE_COMMAND_0,
-    PGN_AUXILIARY_VALVE_COMMAND_1,
-    PGN_AUXILIARY_VALVE_COMMAND_2,
-    PGN_AUXILIARY_VALVE_COMMAND_3,
-    PGN_AUXILIARY_VALVE_COMMAND_4,
-    PGN_AUXILIARY_VALVE_COMMAND_5,
-    PGN_AUXILIARY_VALVE_COMMAND_6,
-    PGN_AUXILIARY_VALVE_COMMAND_7,
-    PGN_AUXILIARY_VALVE_COMMAND_8,
-    PGN_AUXILIARY_VALVE_COMMAND_9,
-    PGN_AUXILIARY_VALVE_COMMAND_10,
-    PGN_AUXILIARY_VALVE_COMMAND_11,
-    PGN_AUXILIARY_VALVE_COMMAND_12,
-    PGN_AUXILIARY_VALVE_COMMAND_13,
-    PGN_AUXILIARY_VALVE_COMMAND_14,
-    PGN_AUXILIARY_VALVE_COMMAND_15,
-    PGN_GENERAL_PURPOSE_VALVE_ESTIMATED_FLOW,
-    PGN_IVECO_PROPIETARY_B_DASHBOARD_INFO,
-    PGN_IVECO_PROPIETARY_B_SAFETY_INFO,
-    PGN_VOLTU_PROPIETARY_B_DASHBOARD_CMD,
-    PGN_THREE_IN_ONE_DCDC_INFO,
-    PGN_THREE_IN_ONE_DCAC1_INFO_INPUT,
-    PGN_THREE_IN_ONE_DCAC1_INFO_OUTPUT,
-    PGN_THREE_IN_ONE_DCAC2_INFO_INPUT,
-    PGN_THREE_IN_ONE_DCAC2_INFO_OUTPUT,
-    PGN_AIR_SUPPLY_PRESSURE,
+/* C standard library */
+#include <stdint.h>
 
+/*
+ * Every PGN that this library knows - The enum, pgn_value, pgn_information and Open_SAE_J1939_Find_PGN are made from this list, so a new PGN is only added here.
+ * X(name, PGN, default priority, function in Request.c that responds to a request, function in Transport_Protocol_Data_Transfer.c that reads it from the Transport Protocol)
+ * A request for a PGN without a respond function gets a NACK. A PGN without a read function can only be given to a pending request when it comes with the Transport Protocol
+ */
+#define PGN_REGISTRY(X) \
+    X(ADDRESS_DELETE,                       0x000002, 0, Respond_Acknowledgement,                      NULL) \
+    X(REQUEST,                              0x00EA00, 6, Respond_Acknowledgement,                      NULL) \
+    X(ACKNOWLEDGEMENT,                      0x00E800, 6, Respond_Acknowledgement,                      NULL) \
+    X(TP_CM,                                0x00EC00, 7, Respond_Acknowledgement,                      NULL) \
+    X(TP_DT,                                0x00EB00, 7, Respond_Acknowledgement,                      NULL) \
+    X(FD_TP_CM,                             0x004D00, 7, NULL,                                         NULL) \
+    X(FD_TP_DT,                             0x004E00, 7, NULL,                                         NULL) \
+    X(MULTI_PG,                             0x002500, 6, NULL,                                         NULL) \
+    X(ADDRESS_CLAIMED,                      0x00EE00, 6, Respond_Address_Claimed,                      NULL) \
+    X(COMMANDED_ADDRESS,                    0x00FED8, 6, Respond_Acknowledgement,                      Read_Commanded_Address) \
+    X(DM1,                                  0x00FECA, 6, Respond_DM1,                                  Read_DM1) \
+    X(DM2,                                  0x00FECB, 6, Respond_DM2,                                  Read_DM2) \
+    X(DM3,                                  0x00FECC, 6, Respond_DM3,                                  NULL) \
+    X(DM14,                                 0x00D900, 6, NULL,                                         NULL) \
+    X(DM15,                                 0x00D800, 6, NULL,                                         NULL) \
+    X(DM16,                                 0x00D700, 7, NULL,                                         Read_DM16) \
+    X(SOFTWARE_IDENTIFICATION,              0x00FEDA, 6, Respond_Software_Identification,              Read_Software_Identification) \
+    X(ECU_IDENTIFICATION,                   0x00FDC5, 6, Respond_ECU_Identification,                   Read_ECU_Identification) \
+    X(COMPONENT_IDENTIFICATION,             0x00FEEB, 6, Respond_Component_Identification,             Read_Component_Identification) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_0,     0x00FE10, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_1,     0x00FE11, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_2,     0x00FE12, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_3,     0x00FE13, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_4,     0x00FE14, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_5,     0x00FE15, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_6,     0x00FE16, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_7,     0x00FE17, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_8,     0x00FE18, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_9,     0x00FE19, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_10,    0x00FE1A, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_11,    0x00FE1B, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_12,    0x00FE1C, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_13,    0x00FE1D, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_14,    0x00FE1E, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_ESTIMATED_FLOW_15,    0x00FE1F, 3, Respond_Auxiliary_Valve_Estimated_Flow,       NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_0,  0x00FF20, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_1,  0x00FF21, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_2,  0x00FF22, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_3,  0x00FF23, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_4,  0x00FF24, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_5,  0x00FF25, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_6,  0x00FF26, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_7,  0x00FF27, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_8,  0x00FF28, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_9,  0x00FF29, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_10, 0x00FF2A, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_11, 0x00FF2B, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_12, 0x00FF2C, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_13, 0x00FF2D, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_14, 0x00FF2E, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_MEASURED_POSITION_15, 0x00FF2F, 3, Respond_Auxiliary_Valve_Measured_Position,    NULL) \
+    X(AUXILIARY_VALVE_COMMAND_0,            0x00FE30, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_1,            0x00FE31, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_2,            0x00FE32, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_3,            0x00FE33, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_4,            0x00FE34, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_5,            0x00FE35, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_6,            0x00FE36, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_7,            0x00FE37, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_8,            0x00FE38, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_9,            0x00FE39, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_10,           0x00FE3A, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_11,           0x00FE3B, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_12,           0x00FE3C, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_13,           0x00FE3D, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_14,           0x00FE3E, 3, NULL,                                         NULL) \
+    X(AUXILIARY_VALVE_COMMAND_15,           0x00FE3F, 3, NULL,                                         NULL) \
+    X(GENERAL_PURPOSE_VALVE_ESTIMATED_FLOW, 0x00C600, 3, Respond_General_Purpose_Valve_Estimated_Flow, NULL) \
+    X(IVECO_PROPIETARY_B_DASHBOARD_INFO,    0x00FF62, 6, NULL,                                         NULL) \
+    X(IVECO_PROPIETARY_B_SAFETY_INFO,       0x00FF61, 6, NULL,                                         NULL) \
+    X(VOLTU_PROPIETARY_B_DASHBOARD_CMD,     0x00FFCE, 6, NULL,                                         NULL) \
+    X(THREE_IN_ONE_DCDC_INFO,               0x007C9C, 6, NULL,                                         NULL)    /* 0x187C9CA7 */ \
+    X(THREE_IN_ONE_DCAC1_INFO_INPUT,        0x005C9C, 6, NULL,                                         NULL)    /* 0x185C9CA5 */ \
+    X(THREE_IN_ONE_DCAC1_INFO_OUTPUT,       0x005D9C, 6, NULL,                                         NULL)    /* 0x185D9CA5 */ \
+    X(THREE_IN_ONE_DCAC2_INFO_INPUT,        0x006C9C, 6, NULL,                                         NULL)    /* 0x186C9CA6 */ \
+    X(THREE_IN_ONE_DCAC2_INFO_OUTPUT,       0x006D9C, 6, NULL,                                         NULL)    /* 0x186D9CA6 */ \
+    X(AIR_SUPPLY_PRESSURE,                  0x00FEAE, 6, NULL,                                         NULL)
 
+/* PGN enums */
+typedef enum {
+#define PGN_ENUM(name, PGN, priority, respond, read) PGN_##name,
+    PGN_REGISTRY(PGN_ENUM)
+#undef PGN_ENUM
     PGN_QTY,
 } pgn_list_t;
 
-static const uint32_t pgn_value[PGN_QTY] = {
-    [PGN_ADDRESS_DELETE] = 0x000002,
-    [PGN_REQUEST] = 0x00EA00,
-    [PGN_ACKNOWLEDGEMENT] = 0x00E800,
-    [PGN_TP_CM] = 0x00EC00,
-    [PGN_TP_DT] = 0x00EB00,
-    [PGN_ADDRESS_CLAIMED] = 0x00EE00,
-    [PGN_COMMANDED_ADDRESS] = 0x00FED8,
-    [PGN_DM1] = 0x00FECA,
-    [PGN_DM2] = 0x00FECB,
-    [PGN_DM3] = 0x00FECC,
-    [PGN_DM14] = 0x00D900,
-    [PGN_DM15] = 0x00D800,
-    [PGN_DM16] = 0x00D700,
-    [PGN_SOFTWARE_IDENTIFICATION] = 0x00FEDA,
-    [PGN_ECU_IDENTIFICATION] = 0x00FDC5,
-    [PGN_COMPONENT_IDENTIFICATION] = 0x00FEEB,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_0] = 0x00FE10,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_1] = 0x00FE11,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_2] = 0x00FE12,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_3] = 0x00FE13,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_4] = 0x00FE14,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_5] = 0x00FE15,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_6] = 0x00FE16,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_7] = 0x00FE17,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_8] = 0x00FE18,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_9] = 0x00FE19,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_10] = 0x00FE1A,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_11] = 0x00FE1B,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_12] = 0x00FE1C,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_13] = 0x00FE1D,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_14] = 0x00FE1E,
-    [PGN_AUXILIARY_VALVE_ESTIMATED_FLOW_15] = 0x00FE1F,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_0] = 0x00FF20,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_1] = 0x00FF21,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_2] = 0x00FF22,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_3] = 0x00FF23,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_4] = 0x00FF24,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_5] = 0x00FF25,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_6] = 0x00FF26,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_7] = 0x00FF27,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_8] = 0x00FF28,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_9] = 0x00FF29,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_10] = 0x00FF2A,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_11] = 0x00FF2B,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_12] = 0x00FF2C,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_13] = 0x00FF2D,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_14] = 0x00FF2E,
-    [PGN_AUXILIARY_VALVE_MEASURED_POSITION_15] = 0x00FF2F,
-    [PGN_AUXILIARY_VALVE_COMMAND_0] = 0x00FE30,
-    [PGN_AUXILIARY_VALVE_COMMAND_1] = 0x00FE31,
-    [PGN_AUXILIARY_VALVE_COMMAND_2] = 0x00FE32,
-    [PGN_AUXILIARY_VALVE_COMMAND_3] = 0x00FE33,
-    [PGN_AUXILIARY_VALVE_COMMAND_4] = 0x00FE34,
-    [PGN_AUXILIARY_VALVE_COMMAND_5] = 0x00FE35,
-    [PGN_AUXILIARY_VALVE_COMMAND_6] = 0x00FE36,
-    [PGN_AUXILIARY_VALVE_COMMAND_7] = 0x00FE37,
-    [PGN_AUXILIARY_VALVE_COMMAND_8] = 0x00FE38,
-    [PGN_AUXILIARY_VALVE_COMMAND_9] = 0x00FE39,
-    [PGN_AUXILIARY_VALVE_COMMAND_10] = 0x00FE3A,
-    [PGN_AUXILIARY_VALVE_COMMAND_11] = 0x00FE3B,
-    [PGN_AUXILIARY_VALVE_COMMAND_12] = 0x00FE3C,
-    [PGN_AUXILIARY_VALVE_COMMAND_13] = 0x00FE3D,
-    [PGN_AUXILIARY_VALVE_COMMAND_14] = 0x00FE3E,
-    [PGN_AUXILIARY_VALVE_COMMAND_15] = 0x00FE3F,
-    [PGN_GENERAL_PURPOSE_VALVE_ESTIMATED_FLOW] = 0x00C600,
-    [PGN_IVECO_PROPIETARY_B_DASHBOARD_INFO] = 0x00FF62,
-    [PGN_IVECO_PROPIETARY_B_SAFETY_INFO] = 0x00FF61,
-    [PGN_VOLTU_PROPIETARY_B_DASHBOARD_CMD] = 0x00FFCE,
-    [PGN_THREE_IN_ONE_DCDC_INFO] = 0x007C9C,                //0x187C9CA7
-    [PGN_THREE_IN_ONE_DCAC1_INFO_INPUT] = 0x005C9C,         //0x185C9CA5
-    [PGN_THREE_IN_ONE_DCAC1_INFO_OUTPUT] = 0x005D9C,        //0x185D9CA5
-    [PGN_THREE_IN_ONE_DCAC2_INFO_INPUT] = 0x006C9C,         //0x186C9CA6
-    [PGN_THREE_IN_ONE_DCAC2_INFO_OUTPUT] = 0x006D9C,        //0x186D9CA6
-    [PGN_AIR_SUPPLY_PRESSURE] = 0x00FEAE,
-};
+/* The rest of the columns in the registry */
+typedef struct {
+    uint8_t default_priority;                       /* The priority in the CAN ID, 0 is the highest */
+} pgn_information_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* One table for the whole program - Defined in PGN_Registry.c */
+extern const uint32_t pgn_value[PGN_QTY];
+extern const pgn_information_t pgn_information[PGN_QTY];
+
+/* Returns PGN_QTY if the PGN is not in the registry */
+pgn_list_t Open_SAE_J1939_Find_PGN(uint32_t PGN);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* SAE_J1939_ENUMS_SAE_J1939_ENUM_PGN_H_ */
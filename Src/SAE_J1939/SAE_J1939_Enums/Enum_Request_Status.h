@@ -0,0 +1,21 @@
+/*
+ * Enum_Request_Status.h
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#ifndef SAE_J1939_ENUMS_SAE_J1939_ENUM_REQUEST_STATUS_H_
+#define SAE_J1939_ENUMS_SAE_J1939_ENUM_REQUEST_STATUS_H_
+
+/* How a request from this ECU was answered */
+typedef enum {
+	REQUEST_STATUS_RESPONSE = 0x0,
+	REQUEST_STATUS_ACK = 0x1,
+	REQUEST_STATUS_NACK = 0x2,
+	REQUEST_STATUS_ACCESS_DENIED = 0x3,
+	REQUEST_STATUS_BUSY = 0x4,
+	REQUEST_STATUS_TIMEOUT = 0x5
+} ENUM_REQUEST_STATUS_CODES;
+
+#endif /* SAE_J1939_ENUMS_SAE_J1939_ENUM_REQUEST_STATUS_H_ */
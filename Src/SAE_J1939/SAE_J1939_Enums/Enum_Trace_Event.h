@@ -0,0 +1,29 @@
+/*
+ * Enum_Trace_Event.h
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#ifndef SAE_J1939_ENUMS_SAE_J1939_ENUM_TRACE_EVENT_H_
+#define SAE_J1939_ENUMS_SAE_J1939_ENUM_TRACE_EVENT_H_
+
+/* What happened in a trace record. SA and DA are the source and destination of the message or frame that the event is about */
+typedef enum {
+	TRACE_EVENT_TP_TRANSMIT_OPEN = 0x01,			/* RTS or BAM sent - Argument is the number of packages */
+	TRACE_EVENT_TP_TRANSMIT_COMPLETE = 0x02,		/* EndOfMsgACK received or the last BAM package sent - Argument is the number of packages */
+	TRACE_EVENT_TP_RECEIVE_OPEN = 0x03,				/* RTS or BAM accepted - Argument is the number of packages */
+	TRACE_EVENT_TP_RECEIVE_COMPLETE = 0x04,			/* Every package has arrived - Argument is the number of packages */
+	TRACE_EVENT_TP_ABORT_SENT = 0x05,				/* Argument is the abort reason */
+	TRACE_EVENT_TP_ABORT_RECEIVED = 0x06,			/* Argument is the abort reason */
+	TRACE_EVENT_TP_BAM_DROPPED = 0x07,				/* Argument is the abort reason that would have been sent, if BAM could be aborted */
+	TRACE_EVENT_ADDRESS_CLAIMED = 0x10,				/* This ECU has claimed its address */
+	TRACE_EVENT_ADDRESS_CLAIM_LOST = 0x11,			/* Other ECU claimed the address of this ECU */
+	TRACE_EVENT_ADDRESS_CANNOT_CLAIM = 0x12,		/* Other ECU could not claim an address */
+	TRACE_EVENT_REQUEST_RECEIVED = 0x20,			/* PGN is the requested PGN - Argument is 1 if the rate limit holds the answer back */
+	TRACE_EVENT_REQUEST_ANSWERED = 0x21,			/* PGN is the requested PGN - Argument is 1 if the PGN is not supported */
+	TRACE_EVENT_MEMORY_ACCESS_DONE = 0x30,			/* A DM14 operation from other ECU is done - Argument is the DM15 status */
+	TRACE_EVENT_SEND_FAILED = 0x40					/* A frame could not be sent - Argument is ENUM_J1939_STATUS_CODES */
+} ENUM_TRACE_EVENT_CODES;
+
+#endif /* SAE_J1939_ENUMS_SAE_J1939_ENUM_TRACE_EVENT_H_ */
@@ -0,0 +1,16 @@
+/*
+ * communication_handler.h
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+/* The CRC of the board, that gives the address from the serial number */
+#ifndef TESTS_STUBS_BOARD_COMMUNICATION_HANDLER_H_
+#define TESTS_STUBS_BOARD_COMMUNICATION_HANDLER_H_
+
+#include <stdint.h>
+
+uint32_t CalculateCRC(uint8_t *data, uint32_t length);
+
+#endif /* TESTS_STUBS_BOARD_COMMUNICATION_HANDLER_H_ */
@@ -0,0 +1,14 @@
+/*
+ * communication_pc.h
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+/* The debug text to the PC */
+#ifndef TESTS_STUBS_BOARD_COMMUNICATION_PC_H_
+#define TESTS_STUBS_BOARD_COMMUNICATION_PC_H_
+
+void COMMUNICATION_PC_WriteL(char *text);
+
+#endif /* TESTS_STUBS_BOARD_COMMUNICATION_PC_H_ */
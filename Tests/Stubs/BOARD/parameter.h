@@ -0,0 +1,18 @@
+/*
+ * parameter.h
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+/* The parameters of the board */
+#ifndef TESTS_STUBS_BOARD_PARAMETER_H_
+#define TESTS_STUBS_BOARD_PARAMETER_H_
+
+#include <stdint.h>
+
+#define PARAMETER_ICU_TYPE 0
+
+uint16_t PARAMETER_GetValue(int parameter);
+
+#endif /* TESTS_STUBS_BOARD_PARAMETER_H_ */
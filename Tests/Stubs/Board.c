@@ -0,0 +1,28 @@
+/*
+ * Board.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include <stdio.h>
+#include "BOARD/parameter.h"
+#include "BOARD/communication_pc.h"
+#include "BOARD/communication_handler.h"
+
+/* The functions of the board that the library calls */
+uint16_t PARAMETER_GetValue(int parameter) {
+    (void)parameter;
+    return 0;
+}
+
+void COMMUNICATION_PC_WriteL(char *text) {
+    printf("%s\n", text);
+}
+
+uint32_t CalculateCRC(uint8_t *data, uint32_t length) {
+    uint32_t crc = 0;
+    for (uint32_t i = 0; i < length; i++)
+        crc = (crc << 1) ^ data[i];
+    return crc;
+}
@@ -0,0 +1,17 @@
+/*
+ * FreeRTOS.h
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+/* The library includes FreeRTOS on every platform, but only the PIC port uses it. This is what the other platforms need */
+#ifndef TESTS_STUBS_FREERTOS_H_
+#define TESTS_STUBS_FREERTOS_H_
+
+typedef int BaseType_t;
+#define pdFALSE 0
+#define pdTRUE 1
+#define portEND_SWITCHING_ISR(x) (void)(x)
+
+#endif /* TESTS_STUBS_FREERTOS_H_ */
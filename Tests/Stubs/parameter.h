@@ -0,0 +1,2 @@
+/* Startup_ECU.c includes the parameters without the BOARD folder */
+#include "BOARD/parameter.h"
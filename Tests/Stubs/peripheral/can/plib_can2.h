@@ -0,0 +1 @@
+/* Only the PIC port uses this header */
@@ -0,0 +1,17 @@
+/*
+ * xc.h
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+/* The serial number of the PIC */
+#ifndef TESTS_STUBS_XC_H_
+#define TESTS_STUBS_XC_H_
+
+#define DEVSN0 0x01u
+#define DEVSN1 0x02u
+#define DEVSN2 0x03u
+#define DEVSN3 0x04u
+
+#endif /* TESTS_STUBS_XC_H_ */
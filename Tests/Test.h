@@ -0,0 +1,34 @@
+/*
+ * Test.h
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#ifndef TESTS_TEST_H_
+#define TESTS_TEST_H_
+
+#include <stdio.h>
+#include <string.h>
+
+/* Include Open SAE J1939 */
+#include "Open_SAE_J1939/Open_SAE_J1939.h"
+#include "Hardware/Hardware.h"
+
+static int test_failures = 0;
+
+/* A failed check is printed and the test goes on, so one run shows every failed check */
+#define CHECK(condition) do { \
+	if (!(condition)) { \
+		printf("%s:%d: Check failed: %s\n", __FILE__, __LINE__, #condition); \
+		test_failures++; \
+	} \
+} while (0)
+
+/* Returns the exit code of the test */
+static inline int Test_Result(const char name[]) {
+	printf("%s: %s\n", name, test_failures == 0 ? "OK" : "FAILED");
+	return test_failures == 0 ? 0 : 1;
+}
+
+#endif /* TESTS_TEST_H_ */
@@ -0,0 +1,64 @@
+/*
+ * Test_DM16.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Test.h"
+
+#define RECEIVER 0x90
+#define SENDER 0x30
+
+/* The classic and the FD Transport Protocol give their complete messages to the same function */
+static void Test_Transport_Protocol_Length(void) {
+	static J1939 j1939;
+	memset(&j1939, 0, sizeof(j1939));
+	j1939.information_this_ECU.this_ECU_address = RECEIVER;
+	uint8_t data[256];
+	for (uint16_t i = 0; i < sizeof(data); i++)
+		data[i] = i;
+
+	/* Byte 1 says 100 bytes, but only 50 bytes arrived */
+	data[0] = 100;
+	SAE_J1939_Read_Transport_Protocol_Complete_Message(&j1939, SENDER, pgn_value[PGN_DM16], data, 50);
+	CHECK(j1939.from_other_ecu_dm.dm16.number_of_occurences == 0);
+	CHECK(j1939.from_other_ecu_dm.dm16.from_ecu_address == 0);
+
+	/* One byte short */
+	data[0] = 50;
+	SAE_J1939_Read_Transport_Protocol_Complete_Message(&j1939, SENDER, pgn_value[PGN_DM16], data, 50);
+	CHECK(j1939.from_other_ecu_dm.dm16.number_of_occurences == 0);
+
+	/* The bytes and the number of occurrences are the same */
+	data[0] = 49;
+	SAE_J1939_Read_Transport_Protocol_Complete_Message(&j1939, SENDER, pgn_value[PGN_DM16], data, 50);
+	CHECK(j1939.from_other_ecu_dm.dm16.number_of_occurences == 49);
+	CHECK(j1939.from_other_ecu_dm.dm16.from_ecu_address == SENDER);
+	CHECK(memcmp(j1939.from_other_ecu_dm.dm16.raw_binary_data, &data[1], 49) == 0);
+	CHECK(j1939.from_other_ecu_dm.dm16.raw_binary_data[49] == 0xFF);
+
+	/* The padding of the last package can be longer than the message */
+	data[0] = 200;
+	SAE_J1939_Read_Transport_Protocol_Complete_Message(&j1939, SENDER, pgn_value[PGN_DM16], data, 203);
+	CHECK(j1939.from_other_ecu_dm.dm16.number_of_occurences == 200);
+}
+
+/* A short DM16 comes in one frame on the bus */
+static void Test_Single_Frame(void) {
+	CAN_Network_Open(1, 0, 0.0f, 1);
+	J1939 *j1939 = CAN_Network_Get_Node(0);
+	j1939->information_this_ECU.this_ECU_address = RECEIVER;
+	uint8_t data[8] = {5, 'h', 'e', 'l', 'l', 'o', 0xFF, 0xFF};
+	CAN_Network_Send(0x18D70000 | (RECEIVER << 8) | SENDER, 8, data);
+	CAN_Network_Run(1);
+	CHECK(j1939->from_other_ecu_dm.dm16.number_of_occurences == 5);
+	CHECK(memcmp(j1939->from_other_ecu_dm.dm16.raw_binary_data, "hello", 5) == 0);
+	CAN_Network_Close();
+}
+
+int main() {
+	Test_Transport_Protocol_Length();
+	Test_Single_Frame();
+	return Test_Result("DM16");
+}
@@ -0,0 +1,56 @@
+/*
+ * Test_Frame_Callback.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Test.h"
+
+#define RECEIVER 0x90
+#define SENDER 0x30
+
+static J1939_Frame last_frame[PGN_QTY];
+static uint8_t number_of_calls[PGN_QTY];
+
+static void Frame_Callback(const J1939_Frame *frame, void *context) {
+	pgn_list_t pgn = *(pgn_list_t *)context;
+	last_frame[pgn] = *frame;
+	number_of_calls[pgn]++;
+}
+
+/* The frames that Listen_For_Messages reads by itself go to the callbacks too, not only the frames that nothing reads */
+static void Test_Every_Frame(void) {
+	static pgn_list_t pgn[] = {PGN_DM1, PGN_ADDRESS_CLAIMED, PGN_AUXILIARY_VALVE_COMMAND_0, PGN_VOLTU_PROPIETARY_B_DASHBOARD_CMD};
+	for (uint8_t i = 0; i < sizeof(pgn) / sizeof(pgn[0]); i++)
+		Open_SAE_J1939_ConfigFrameCallback(Frame_Callback, &pgn[i], pgn[i]);
+	CAN_Network_Open(1, 0, 0.0f, 1);
+	J1939 *j1939 = CAN_Network_Get_Node(0);
+	j1939->information_this_ECU.this_ECU_address = RECEIVER;
+
+	uint8_t dm1[8] = {0x40, 0xFF, 0x64, 0x00, 0x03, 0x01, 0xFF, 0xFF};
+	CAN_Network_Send(0x18FECA00 | SENDER, 8, dm1);
+	uint8_t name[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+	CAN_Network_Send(0x18EEFF00 | SENDER, 8, name);
+	uint8_t valve[8] = {50, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+	CAN_Network_Send(0x0CFE3000 | SENDER, 8, valve);
+	uint8_t dashboard[8] = {0};
+	CAN_Network_Send(0x18FFCE00 | SENDER, 8, dashboard);
+	CAN_Network_Run(1);
+
+	CHECK(number_of_calls[PGN_DM1] == 1);
+	CHECK(j1939->from_other_ecu_dm.errors_dm1_active > 0);
+	CHECK(last_frame[PGN_DM1].PGN == 0xFECA && last_frame[PGN_DM1].SA == SENDER && last_frame[PGN_DM1].DA == 0xFF);
+	CHECK(last_frame[PGN_DM1].priority == 6 && last_frame[PGN_DM1].DLC == 8);
+	CHECK(number_of_calls[PGN_ADDRESS_CLAIMED] == 1);
+	CHECK(last_frame[PGN_ADDRESS_CLAIMED].PGN == 0xEE00 && last_frame[PGN_ADDRESS_CLAIMED].DA == 0xFF);
+	CHECK(number_of_calls[PGN_AUXILIARY_VALVE_COMMAND_0] == 1);
+	CHECK(last_frame[PGN_AUXILIARY_VALVE_COMMAND_0].priority == 3);
+	CHECK(number_of_calls[PGN_VOLTU_PROPIETARY_B_DASHBOARD_CMD] == 1);
+	CAN_Network_Close();
+}
+
+int main() {
+	Test_Every_Frame();
+	return Test_Result("Frame callback");
+}
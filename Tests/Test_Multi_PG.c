@@ -0,0 +1,134 @@
+/*
+ * Test_Multi_PG.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Test.h"
+
+#define SENDER 0x80
+#define RECEIVER 0x90
+#define MULTI_PG_ID (0x1825FF00 | SENDER)							/* Priority 6, PGN 0x002500 to all ECU */
+
+static uint32_t Get_Frames_Sent(void) {
+	uint32_t frames_sent, frames_delivered, frames_lost, frames_overrun;
+	CAN_Network_Get_Statistics(&frames_sent, &frames_delivered, &frames_lost, &frames_overrun);
+	return frames_sent;
+}
+
+/* The C-PG header is little endian - Length, PGN, trailer format 0 and type of service 2 */
+static void Write_C_PG_Header(uint8_t data[], uint32_t PGN, uint8_t length) {
+	uint32_t header = (2UL << 29) | (PGN << 8) | length;
+	for (uint8_t i = 0; i < 4; i++)
+		data[i] = header >> (8 * i);
+}
+
+/* Three valve commands are packed into one CAN FD frame and read as three parameter groups by the other ECU */
+static void Test_Round_Trip(void) {
+	CAN_Network_Open(2, 1, 0.0f, 1);
+	J1939 *sender = CAN_Network_Get_Node(0);
+	J1939 *receiver = CAN_Network_Get_Node(1);
+	sender->is_CAN_FD = true;
+	receiver->is_CAN_FD = true;
+	sender->information_this_ECU.this_ECU_address = SENDER;
+	receiver->information_this_ECU.this_ECU_address = RECEIVER;
+
+	uint32_t frames_sent = Get_Frames_Sent();
+	CAN_Network_Enter_Node(0);
+	for (uint8_t valve = 0; valve < 3; valve++) {
+		uint8_t data[3] = {10 + valve, 0xFF, (1 << 6) | 2};
+		CHECK(SAE_J1939_Send_Multi_PG(sender, (3UL << 26) | ((0xFE30UL + valve) << 8) | SENDER, data, sizeof(data), 10) == STATUS_SEND_OK);
+	}
+	CHECK(sender->this_multi_pg.length == 3 * (4 + 3));
+	CAN_Network_Leave_Node();
+
+	/* Nothing is sent before the latency has passed */
+	CAN_Network_Run(5);
+	CHECK(Get_Frames_Sent() == frames_sent);
+	CAN_Network_Run(20);
+	CHECK(Get_Frames_Sent() == frames_sent + 1);
+	CHECK(sender->this_multi_pg.length == 0);
+	for (uint8_t valve = 0; valve < 3; valve++) {
+		struct Auxiliary_valve_command *command = &receiver->from_other_ecu_auxiliary_valve_command[valve];
+		CHECK(command->standard_flow == 10 + valve);
+		CHECK(command->valve_state == 2);
+		CHECK(command->fail_safe_mode == 1);
+		CHECK(command->from_ecu_address == SENDER);
+	}
+	CAN_Network_Close();
+}
+
+/* The frame is padded with 0xAA up to a CAN FD length. The padding must not be read as a C-PG */
+static void Test_Padding(void) {
+	CAN_Network_Open(1, 0, 0.0f, 1);
+	J1939 *receiver = CAN_Network_Get_Node(0);
+	receiver->is_CAN_FD = true;
+	receiver->information_this_ECU.this_ECU_address = RECEIVER;
+
+	uint8_t data[12];
+	memset(data, 0xAA, sizeof(data));
+	Write_C_PG_Header(data, 0xFE33, 3);
+	data[4] = 55;
+	data[5] = 0xFF;
+	data[6] = 1;
+
+	uint8_t offset = 0;
+	uint32_t PGN;
+	const uint8_t *payload;
+	uint8_t payload_length;
+	CHECK(SAE_J1939_Read_Multi_PG(data, sizeof(data), &offset, &PGN, &payload, &payload_length));
+	CHECK(PGN == 0xFE33 && payload_length == 3 && payload == &data[4] && offset == 7);
+	CHECK(!SAE_J1939_Read_Multi_PG(data, sizeof(data), &offset, &PGN, &payload, &payload_length));
+
+	CAN_Network_Send(MULTI_PG_ID, sizeof(data), data);
+	CAN_Network_Run(1);
+	CHECK(receiver->from_other_ecu_auxiliary_valve_command[3].standard_flow == 55);
+	CHECK(receiver->from_other_ecu_auxiliary_valve_command[3].valve_state == 1);
+	CHECK(receiver->from_other_ecu_auxiliary_valve_command[3].from_ecu_address == SENDER);
+	CAN_Network_Close();
+}
+
+/* A C-PG that says it is longer than the frame is not read, but the C-PG before it are */
+static void Test_Oversized_Length(void) {
+	CAN_Network_Open(1, 0, 0.0f, 1);
+	J1939 *receiver = CAN_Network_Get_Node(0);
+	receiver->is_CAN_FD = true;
+	receiver->information_this_ECU.this_ECU_address = RECEIVER;
+
+	uint8_t data[16];
+	memset(data, 0xAA, sizeof(data));
+	Write_C_PG_Header(data, 0xFE34, 3);
+	data[4] = 44;
+	data[5] = 0xFF;
+	data[6] = 2;
+	Write_C_PG_Header(&data[7], 0xFE35, 20);
+	data[11] = 33;
+
+	uint8_t offset = 0;
+	uint32_t PGN;
+	const uint8_t *payload;
+	uint8_t payload_length;
+	CHECK(SAE_J1939_Read_Multi_PG(data, sizeof(data), &offset, &PGN, &payload, &payload_length));
+	CHECK(PGN == 0xFE34);
+	CHECK(!SAE_J1939_Read_Multi_PG(data, sizeof(data), &offset, &PGN, &payload, &payload_length));
+
+	CAN_Network_Send(MULTI_PG_ID, sizeof(data), data);
+	CAN_Network_Run(1);
+	CHECK(receiver->from_other_ecu_auxiliary_valve_command[4].standard_flow == 44);
+	CHECK(receiver->from_other_ecu_auxiliary_valve_command[5].standard_flow == 0);
+	CHECK(receiver->from_other_ecu_auxiliary_valve_command[5].from_ecu_address == 0);
+
+	/* A length of 0 is not a C-PG either */
+	offset = 0;
+	Write_C_PG_Header(data, 0xFE34, 0);
+	CHECK(!SAE_J1939_Read_Multi_PG(data, sizeof(data), &offset, &PGN, &payload, &payload_length));
+	CAN_Network_Close();
+}
+
+int main() {
+	Test_Round_Trip();
+	Test_Padding();
+	Test_Oversized_Length();
+	return Test_Result("Multi-PG");
+}
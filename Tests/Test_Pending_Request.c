@@ -0,0 +1,56 @@
+/*
+ * Test_Pending_Request.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Test.h"
+
+#define ASKER 0x90
+#define BROADCASTER 0x30
+
+static uint8_t number_of_responses = 0;
+static uint8_t number_of_timeouts = 0;
+
+static void Request_Callback(const struct Request_response *response, void *context) {
+	(void)context;
+	if (response->status == REQUEST_STATUS_RESPONSE)
+		number_of_responses++;
+	else if (response->status == REQUEST_STATUS_TIMEOUT)
+		number_of_timeouts++;
+}
+
+/* A DM1 of 20 bytes with BAM - The packages come 100 ms apart, so a BAM session is open almost all the time */
+static void Broadcast_DM1(void) {
+	uint8_t data[8] = {CONTROL_BYTE_TP_CM_BAM, 20, 0, 3, 0xFF, 0xCA, 0xFE, 0x00};
+	CAN_Network_Send(0x1CECFF00 | BROADCASTER, 8, data);
+	for (uint8_t i = 1; i <= 3; i++) {
+		CAN_Network_Run(100);
+		memset(data, 0xFF, sizeof(data));
+		data[0] = i;
+		CAN_Network_Send(0x1CEBFF00 | BROADCASTER, 8, data);
+	}
+	CAN_Network_Run(10);
+}
+
+/* A global request for a PGN that an ECU sends with BAM all the time ends when its time is up */
+static void Test_Global_Request_Timeout(void) {
+	CAN_Network_Open(1, 0, 0.0f, 1);
+	J1939 *j1939 = CAN_Network_Get_Node(0);
+	j1939->information_this_ECU.this_ECU_address = ASKER;
+	CAN_Network_Enter_Node(0);
+	CHECK(SAE_J1939_Send_Request_Async(j1939, 0xFF, pgn_value[PGN_DM1], 1000, Request_Callback, NULL, NULL) == STATUS_SEND_OK);
+	CAN_Network_Leave_Node();
+	for (uint8_t i = 0; i < 10; i++)
+		Broadcast_DM1();
+	CHECK(number_of_responses >= 2);
+	CHECK(number_of_timeouts == 1);
+	CHECK(j1939->this_pending_requests[0].callback == NULL);
+	CAN_Network_Close();
+}
+
+int main() {
+	Test_Global_Request_Timeout();
+	return Test_Result("Pending request");
+}
@@ -0,0 +1,149 @@
+/*
+ * Test_Save_Load_Information.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Test.h"
+
+static long Get_File_Size(const char file_name[]) {
+	FILE *file = fopen(file_name, "rb");
+	if (file == NULL)
+		return -1;
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fclose(file);
+	return size;
+}
+
+/* A power cut in the middle of a write leaves the first bytes of the file */
+static void Cut_File(const char file_name[], long size) {
+	static uint8_t data[4096];
+	FILE *file = fopen(file_name, "rb");
+	size_t length = fread(data, 1, sizeof(data), file);
+	fclose(file);
+	file = fopen(file_name, "wb");
+	fwrite(data, 1, length < (size_t)size ? length : (size_t)size, file);
+	fclose(file);
+}
+
+static void Flip_Byte(const char file_name[], long position) {
+	FILE *file = fopen(file_name, "r+b");
+	fseek(file, position, SEEK_SET);
+	int value = fgetc(file);
+	fseek(file, position, SEEK_SET);
+	fputc(value ^ 0xFF, file);
+	fclose(file);
+}
+
+/* Load the information into a new J1939, as at a startup */
+static uint8_t Load_Address(bool *is_loaded) {
+	static J1939 j1939;
+	memset(&j1939, 0, sizeof(j1939));
+	*is_loaded = Load_Information_This_ECU(&j1939);
+	return j1939.information_this_ECU.this_ECU_address;
+}
+
+static uint8_t number_of_saves = 0;
+
+static void Save_Callback(bool is_saved, void *context) {
+	(void)context;
+	if (is_saved)
+		number_of_saves++;
+}
+
+/* A commanded address only asks for a save. Listen_For_Messages saves it when no storage task is used */
+static void Test_Commanded_Address(void) {
+	remove(INFORMATION_THIS_ECU_SLOT_A);
+	remove(INFORMATION_THIS_ECU_SLOT_B);
+	CAN_Network_Open(1, 0, 0.0f, 1);
+	J1939 *j1939 = CAN_Network_Get_Node(0);
+	j1939->information_this_ECU.this_ECU_address = 0x80;
+	Save_Information_This_ECU_Set_Callback(j1939, Save_Callback, NULL);
+
+	/* The request alone writes nothing */
+	Save_Information_This_ECU_Request(j1939);
+	CHECK(Get_File_Size(INFORMATION_THIS_ECU_SLOT_A) < 0);
+	CHECK(Save_Information_This_ECU_Process(j1939));
+	CHECK(!Save_Information_This_ECU_Process(j1939));
+	CHECK(number_of_saves == 1);
+	bool is_loaded;
+	CHECK(Load_Address(&is_loaded) == 0x80 && is_loaded);
+
+	/* The commanded address with BAM - The NAME and the new address 0x81 */
+	uint8_t data[8] = {CONTROL_BYTE_TP_CM_BAM, 9, 0, 2, 0xFF, 0xD8, 0xFE, 0x00};
+	CAN_Network_Send(0x1CECFF00 | 0x30, 8, data);
+	CAN_Network_Run(50);
+	uint8_t package_1[8] = {1, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07};
+	CAN_Network_Send(0x1CEBFF00 | 0x30, 8, package_1);
+	CAN_Network_Run(50);
+	uint8_t package_2[8] = {2, 0x08, 0x81, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+	CAN_Network_Send(0x1CEBFF00 | 0x30, 8, package_2);
+	CAN_Network_Run(50);
+	CHECK(j1939->information_this_ECU.this_ECU_address == 0x81);
+	CHECK(number_of_saves == 2);
+	CHECK(Load_Address(&is_loaded) == 0x81 && is_loaded);
+	Save_Information_This_ECU_Set_Callback(j1939, NULL, NULL);
+	CAN_Network_Close();
+}
+
+int main() {
+	static J1939 j1939;
+	bool is_loaded;
+	remove(INFORMATION_THIS_ECU_SLOT_A);
+	remove(INFORMATION_THIS_ECU_SLOT_B);
+	remove(INFORMATION_THIS_ECU);
+	Load_Address(&is_loaded);
+	CHECK(!is_loaded);
+
+	/* The first save writes slot A. A change is then appended as a field update */
+	j1939.information_this_ECU.this_ECU_address = 0x22;
+	CHECK(Save_Information_This_ECU(&j1939));
+	long slot_size = Get_File_Size(INFORMATION_THIS_ECU_SLOT_A);
+	CHECK(slot_size > 0);
+	j1939.information_this_ECU.this_ECU_address = 0x23;
+	CHECK(Save_Information_This_ECU(&j1939));
+	CHECK(Get_File_Size(INFORMATION_THIS_ECU_SLOT_A) > slot_size);
+	CHECK(Get_File_Size(INFORMATION_THIS_ECU_SLOT_B) < 0);
+	CHECK(Load_Address(&is_loaded) == 0x23 && is_loaded);
+
+	/* A field update that is cut in half is ignored */
+	j1939.information_this_ECU.this_ECU_address = 0x24;
+	CHECK(Save_Information_This_ECU(&j1939));
+	Cut_File(INFORMATION_THIS_ECU_SLOT_A, Get_File_Size(INFORMATION_THIS_ECU_SLOT_A) - 1);
+	CHECK(Load_Address(&is_loaded) == 0x23 && is_loaded);
+
+	/* After a broken field update, the next save writes everything to the other slot */
+	memset(&j1939, 0, sizeof(j1939));
+	CHECK(Load_Information_This_ECU(&j1939));
+	j1939.information_this_ECU.this_ECU_address = 0x25;
+	CHECK(Save_Information_This_ECU(&j1939));
+	CHECK(j1939.this_information_storage.slot == 1);
+	CHECK(Get_File_Size(INFORMATION_THIS_ECU_SLOT_B) == slot_size);
+	CHECK(Load_Address(&is_loaded) == 0x25 && is_loaded);
+
+	/* The newest slot has a wrong CRC - The older slot is loaded */
+	Flip_Byte(INFORMATION_THIS_ECU_SLOT_B, slot_size - 1);
+	CHECK(Load_Address(&is_loaded) == 0x23 && is_loaded);
+
+	/* The newest slot was cut in the middle of the write - The older slot is loaded */
+	j1939.information_this_ECU.this_ECU_address = 0x26;
+	memset(&j1939.this_information_storage, 0, sizeof(j1939.this_information_storage));
+	CHECK(Save_Information_This_ECU(&j1939));
+	CHECK(j1939.this_information_storage.slot == 1);
+	CHECK(Load_Address(&is_loaded) == 0x26 && is_loaded);
+	Cut_File(INFORMATION_THIS_ECU_SLOT_B, slot_size / 2);
+	CHECK(Load_Address(&is_loaded) == 0x23 && is_loaded);
+
+	/* Both slots are broken */
+	Flip_Byte(INFORMATION_THIS_ECU_SLOT_A, 20);
+	Load_Address(&is_loaded);
+	CHECK(!is_loaded);
+
+	Test_Commanded_Address();
+
+	remove(INFORMATION_THIS_ECU_SLOT_A);
+	remove(INFORMATION_THIS_ECU_SLOT_B);
+	return Test_Result("Save and load information");
+}
@@ -0,0 +1,150 @@
+/*
+ * Test_Transport_Protocol.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Test.h"
+
+#define RECEIVER 0x90
+#define SENDER 0x30
+
+static uint8_t message[255];
+
+/* The frames of the other ECU are put on the bus by hand, so a package can be lost on purpose */
+static void Send_RTS(uint16_t total_message_size) {
+	uint8_t number_of_packages = (total_message_size + 6) / 7;
+	uint8_t data[8] = {CONTROL_BYTE_TP_CM_RTS, total_message_size, total_message_size >> 8, number_of_packages, 0xFF, 0x00, 0xD7, 0x00};
+	CAN_Network_Send(0x1CEC0000 | (RECEIVER << 8) | SENDER, 8, data);
+	CAN_Network_Run(1);
+}
+
+static void Send_Package(uint8_t sequence_number, uint16_t total_message_size) {
+	uint8_t data[8];
+	data[0] = sequence_number;
+	for (uint8_t i = 0; i < 7; i++) {
+		uint16_t offset = (sequence_number - 1) * 7 + i;
+		data[i + 1] = offset < total_message_size ? message[offset] : 0xFF;
+	}
+	CAN_Network_Send(0x1CEB0000 | (RECEIVER << 8) | SENDER, 8, data);
+	CAN_Network_Run(1);
+}
+
+static void Load_DM16(uint8_t number_of_occurences) {
+	message[0] = number_of_occurences;
+	for (uint8_t i = 1; i < sizeof(message); i++)
+		message[i] = i * 7 + 3;
+}
+
+static bool Is_DM16_Received(J1939 *j1939, uint8_t number_of_occurences) {
+	struct DM16 *dm16 = &j1939->from_other_ecu_dm.dm16;
+	return dm16->number_of_occurences == number_of_occurences && memcmp(dm16->raw_binary_data, &message[1], number_of_occurences) == 0;
+}
+
+/* A package in the middle is lost - The receiver asks for it again when the last package of the CTS has arrived */
+static void Test_Lost_Package(void) {
+	CAN_Network_Open(1, 0, 0.0f, 1);
+	J1939 *j1939 = CAN_Network_Get_Node(0);
+	j1939->information_this_ECU.this_ECU_address = RECEIVER;
+	Load_DM16(34);
+
+	Send_RTS(35);
+	CHECK(j1939->from_other_ecu_tp_cm.number_of_packages == 5);
+	CHECK(j1939->from_other_ecu_tp_dt.last_requested_package == 5);
+	Send_Package(1, 35);
+	Send_Package(2, 35);
+	Send_Package(3, 35);
+	Send_Package(5, 35);
+	CHECK(j1939->from_other_ecu_tp_dt.number_of_received_packages == 4);
+	CHECK(j1939->from_other_ecu_tp_dt.last_requested_package == 4);
+	CHECK(j1939->from_other_ecu_dm.dm16.number_of_occurences == 0);
+
+	/* A package that comes twice is only counted once */
+	Send_Package(2, 35);
+	CHECK(j1939->from_other_ecu_tp_dt.number_of_received_packages == 4);
+
+	Send_Package(4, 35);
+	CHECK(Is_DM16_Received(j1939, 34));
+	CHECK(j1939->from_other_ecu_tp_cm.timeout == 0);
+	CAN_Network_Close();
+}
+
+/* The last package is lost - Nothing more comes, so the receiver asks for it again after T1 */
+static void Test_Lost_Last_Package(void) {
+	CAN_Network_Open(1, 0, 0.0f, 1);
+	J1939 *j1939 = CAN_Network_Get_Node(0);
+	j1939->information_this_ECU.this_ECU_address = RECEIVER;
+	Load_DM16(34);
+
+	Send_RTS(35);
+	for (uint8_t i = 1; i <= 4; i++)
+		Send_Package(i, 35);
+	CHECK(j1939->from_other_ecu_tp_dt.number_of_retransmit_requests == 0);
+	CAN_Network_Run(TP_TIMEOUT_T1);
+	CHECK(j1939->from_other_ecu_tp_dt.number_of_retransmit_requests == 1);
+	CHECK(j1939->from_other_ecu_tp_dt.last_requested_package == 5);
+	CHECK(j1939->from_other_ecu_tp_cm.timeout > 0);
+
+	Send_Package(5, 35);
+	CHECK(Is_DM16_Received(j1939, 34));
+	CAN_Network_Close();
+}
+
+/* A CTS that asks for more packages than the message has is answered with abort */
+static void Test_CTS_Past_Last_Package(void) {
+	CAN_Network_Open(1, 0, 0.0f, 1);
+	J1939 *j1939 = CAN_Network_Get_Node(0);
+	j1939->information_this_ECU.this_ECU_address = SENDER;
+	Load_DM16(34);
+	CAN_Network_Enter_Node(0);
+	CHECK(SAE_J1939_Send_Binary_Data_Transfer_DM16(j1939, RECEIVER, 34, &message[1]) == STATUS_SEND_OK);
+	CAN_Network_Leave_Node();
+	CHECK(j1939->this_ecu_tp_cm.timeout > 0 && j1939->this_ecu_tp_cm.number_of_packages == 5);
+
+	uint8_t data[8] = {CONTROL_BYTE_TP_CM_CTS, 3, 4, 0xFF, 0xFF, 0x00, 0xD7, 0x00};
+	CAN_Network_Send(0x1CEC0000 | (SENDER << 8) | RECEIVER, 8, data);
+	CAN_Network_Run(1);
+	CHECK(j1939->this_ecu_tp_cm.timeout == 0);
+	CHECK(j1939->this_ecu_tp_cm.control_byte == CONTROL_BYTE_TP_CM_ABORT);
+	CAN_Network_Close();
+}
+
+/* Two ECU on a bus that loses frames - A message that arrives must be the message that was sent, also when packages had to be sent again */
+static void Test_Lossy_Bus(void) {
+	uint8_t number_of_received = 0;
+	uint8_t number_of_recovered = 0;
+	Load_DM16(200);
+	for (uint32_t seed = 1; seed <= 20; seed++) {
+		CAN_Network_Open(2, 1, 0.05f, seed * 2654435761u);				/* Spread the seeds, so every run loses other frames */
+		J1939 *sender = CAN_Network_Get_Node(0);
+		J1939 *receiver = CAN_Network_Get_Node(1);
+		sender->information_this_ECU.this_ECU_address = SENDER;
+		receiver->information_this_ECU.this_ECU_address = RECEIVER;
+		CAN_Network_Enter_Node(0);
+		SAE_J1939_Send_Binary_Data_Transfer_DM16(sender, RECEIVER, 200, &message[1]);
+		CAN_Network_Leave_Node();
+		CAN_Network_Run(5000);
+
+		uint32_t frames_sent, frames_delivered, frames_lost, frames_overrun;
+		CAN_Network_Get_Statistics(&frames_sent, &frames_delivered, &frames_lost, &frames_overrun);
+		if (receiver->from_other_ecu_dm.dm16.number_of_occurences > 0) {
+			CHECK(Is_DM16_Received(receiver, 200));
+			number_of_received++;
+			if (frames_lost > 0)
+				number_of_recovered++;
+		}
+		CAN_Network_Close();
+	}
+	printf("%u of 20 messages arrived on the lossy bus\n", number_of_received);
+	CHECK(number_of_received >= 15);
+	CHECK(number_of_recovered > 0);
+}
+
+int main() {
+	Test_Lost_Package();
+	Test_Lost_Last_Package();
+	Test_CTS_Past_Last_Package();
+	Test_Lossy_Bus();
+	return Test_Result("Transport Protocol");
+}
@@ -0,0 +1,57 @@
+/*
+ * Test_Valve_Bank.c
+ *
+ *  Created on: 19 okt. 2026
+ *      Author: Daniel Mårtensson
+ */
+
+#include "Test.h"
+
+/* Include ISO 11783 */
+#include "ISO_11783/ISO_11783-7_Application_Layer/Application_Layer.h"
+
+#define VALVE_ECU 0x90
+#define COMMANDER 0x30
+
+/* When the commands stop, the valve goes to the state of its fail safe mode without flow, not to the last command */
+static void Test_Fail_Safe(void) {
+	CAN_Network_Open(1, 0, 0.0f, 1);
+	J1939 *j1939 = CAN_Network_Get_Node(0);
+	j1939->information_this_ECU.this_ECU_address = VALVE_ECU;
+
+	/* Extend with flow - Valve 0 blocks and valve 1 floats at fail safe */
+	uint8_t blocked[8] = {50, 0xFF, (FAIL_SAFE_MODE_BLOCKED << 6) | VALVE_STATE_EXTEND, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+	CAN_Network_Send(0x0CFE3000 | COMMANDER, 8, blocked);
+	uint8_t activated[8] = {60, 0xFF, (FAIL_SAFE_MODE_ACTIVATED << 6) | VALVE_STATE_RETRACT, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+	CAN_Network_Send(0x0CFE3100 | COMMANDER, 8, activated);
+	uint8_t general_purpose[8] = {70, 0xFF, (FAIL_SAFE_MODE_BLOCKED << 6) | VALVE_STATE_EXTEND, 0x10, 0x27, 0xFF, 0xFF, 0xFF};
+	CAN_Network_Send(0x0CC40000 | (VALVE_ECU << 8) | COMMANDER, 8, general_purpose);
+	CAN_Network_Run(10);
+	CHECK(j1939->from_other_ecu_auxiliary_valve_command[0].standard_flow == 50);
+	CHECK(!ISO_11783_Valve_Bank_Is_Fail_Safe(j1939, 0));
+
+	/* The commands stop */
+	CAN_Network_Run(VALVE_BANK_COMMAND_TIMEOUT + 50);
+	CHECK(ISO_11783_Valve_Bank_Is_Fail_Safe(j1939, 0));
+	CHECK(j1939->from_other_ecu_auxiliary_valve_command[0].valve_state == VALVE_STATE_NEUTRAL);
+	CHECK(j1939->from_other_ecu_auxiliary_valve_command[0].standard_flow == 0);
+	CHECK(ISO_11783_Valve_Bank_Is_Fail_Safe(j1939, 1));
+	CHECK(j1939->from_other_ecu_auxiliary_valve_command[1].valve_state == VALVE_STATE_FLOATING);
+	CHECK(j1939->from_other_ecu_auxiliary_valve_command[1].standard_flow == 0);
+	CHECK(ISO_11783_Valve_Bank_Is_Fail_Safe(j1939, VALVE_BANK_GENERAL_PURPOSE_VALVE));
+	CHECK(j1939->from_other_ecu_general_purpose_valve_command.valve_state == VALVE_STATE_NEUTRAL);
+	CHECK(j1939->from_other_ecu_general_purpose_valve_command.standard_flow == 0);
+	CHECK(j1939->from_other_ecu_general_purpose_valve_command.extended_flow == 0);
+
+	/* A new command ends the fail safe */
+	CAN_Network_Send(0x0CFE3000 | COMMANDER, 8, blocked);
+	CAN_Network_Run(10);
+	CHECK(!ISO_11783_Valve_Bank_Is_Fail_Safe(j1939, 0));
+	CHECK(j1939->from_other_ecu_auxiliary_valve_command[0].standard_flow == 50);
+	CAN_Network_Close();
+}
+
+int main() {
+	Test_Fail_Safe();
+	return Test_Result("Valve bank");
+}